@@ -0,0 +1,69 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Helpers shared by the benchmarks
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace bench {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Keeps value alive so the computation producing it is not optimized out
+     */
+    template <typename T>
+    inline void DoNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+     * @brief Seconds elapsed since start
+     */
+    inline double Seconds(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    /**
+     * @brief Median of the samples, they get sorted
+     */
+    inline double Median(std::vector<double>& samples) {
+        std::sort(samples.begin(), samples.end());
+        return samples.empty() ? 0.0 : samples[samples.size() / 2];
+    }
+
+    /**
+     * @brief Value at percentile p of sorted samples
+     */
+    template <typename T>
+    inline T Percentile(const std::vector<T>& sorted, double p) {
+        if (sorted.empty())
+            return T();
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5))];
+    }
+
+    /**
+     * @brief Integer argument index of argv, or fallback
+     */
+    inline long Arg(int argc, char** argv, int index, long fallback) {
+        return argc > index ? std::strtol(argv[index], nullptr, 10) : fallback;
+    }
+
+    /**
+     * @brief Aborts the benchmark when a result is wrong, a fast wrong answer is not a result
+     */
+    inline void Check(bool ok, const char* what) {
+        if (!ok) {
+            std::fprintf(stderr, "check failed: %s\n", what);
+            std::exit(1);
+        }
+    }
+}  // namespace bench
@@ -0,0 +1,11 @@
+# Every bench/bench_*.cpp is a standalone executable, run them from a Release build:
+#   cmake -S . -B build -DRTYPE_BUILD_BENCH=TRUE -DCMAKE_BUILD_TYPE=Release
+find_package(Threads REQUIRED)
+
+file(GLOB BENCH_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/bench/bench_*.cpp")
+
+foreach(BENCH_SOURCE ${BENCH_SOURCES})
+    get_filename_component(BENCH_NAME ${BENCH_SOURCE} NAME_WE)
+    add_executable(${BENCH_NAME} ${BENCH_SOURCE})
+    target_link_libraries(${BENCH_NAME} PRIVATE ${PROJECT_NAME} Threads::Threads)
+endforeach()
@@ -0,0 +1,107 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Body pool, bodies allocated on one thread and freed on another, BodyPool against operator new
+*/
+
+#include <random>
+#include <thread>
+
+#include "BenchCommon.hpp"
+#include "NetBodyPool.hpp"
+#include "NetMpscQueue.hpp"
+
+using RType::net::BodyPool;
+using RType::net::MpscQueue;
+
+struct Body {
+    void* data;
+    size_t size;
+};
+
+/// Bodies through BodyPool
+struct Pooled {
+    static void* Allocate(size_t size) { return BodyPool::Allocate(size); }
+    static void Deallocate(void* block, size_t size) { BodyPool::Deallocate(block, size); }
+};
+
+/// Bodies through the global operator new
+struct System {
+    static void* Allocate(size_t size) { return ::operator new(size); }
+    static void Deallocate(void* block, size_t /* size */) { ::operator delete(block); }
+};
+
+/**
+ * @brief An io thread allocates and fills a body per size, the calling thread frees them
+ *
+ * This is the path of an incoming message body: built by the read handler, freed
+ * after OnMessage on the game thread.
+ *
+ * @return double Nanoseconds per body
+ */
+template <typename Allocator>
+static double Run(const std::vector<uint32_t>& sizes, uint64_t& checksum) {
+    MpscQueue<Body> queue;
+    std::vector<Body> batch;
+    batch.reserve(4096);
+
+    auto start = bench::Clock::now();
+    std::thread io([&]() {
+        for (uint32_t size : sizes) {
+            Body body{Allocator::Allocate(size), size};
+            static_cast<uint8_t*>(body.data)[size - 1] = static_cast<uint8_t>(size);
+            queue.push_back(body);
+        }
+    });
+
+    size_t received = 0;
+    while (received < sizes.size()) {
+        queue.wait();
+        batch.clear();
+        queue.drain_into(batch);
+        for (const Body& body : batch) {
+            checksum += static_cast<uint8_t*>(body.data)[body.size - 1];
+            Allocator::Deallocate(body.data, body.size);
+        }
+        received += batch.size();
+    }
+    double seconds = bench::Seconds(start);
+    io.join();
+    return seconds * 1e9 / static_cast<double>(sizes.size());
+}
+
+int main(int argc, char** argv) {
+    size_t count = static_cast<size_t>(bench::Arg(argc, argv, 1, 2000000));
+    int runs = static_cast<int>(bench::Arg(argc, argv, 2, 5));
+    uint32_t maxSize = static_cast<uint32_t>(bench::Arg(argc, argv, 3, 2048));
+
+    std::mt19937 random(static_cast<uint32_t>(count));
+    std::uniform_int_distribution<uint32_t> any(1, std::max<uint32_t>(maxSize, 1));
+    std::vector<uint32_t> sizes(count);
+    for (auto& size : sizes)
+        size = any(random);
+
+    std::vector<double> pooled;
+    std::vector<double> system;
+    uint64_t pooledSum = 0;
+    uint64_t systemSum = 0;
+    // The first run warms the pool up, the allocations of the others tell the steady state
+    pooled.push_back(Run<Pooled>(sizes, pooledSum));
+    system.push_back(Run<System>(sizes, systemSum));
+    auto warm = BodyPool::GetStats();
+    for (int r = 1; r < runs; r++) {
+        pooled.push_back(Run<Pooled>(sizes, pooledSum));
+        system.push_back(Run<System>(sizes, systemSum));
+    }
+    auto steady = BodyPool::GetStats();
+    bench::Check(pooledSum == systemSum, "both read the same bytes");
+    bench::DoNotOptimize(pooledSum);
+
+    std::printf("%lu bodies of 1 to %u bytes, median of %d runs\n", count, maxSize, runs);
+    std::printf("%-28s %10s %12s\n", "ns per body", "new", "BodyPool");
+    std::printf("%-28s %10.1f %12.1f\n", "io thread to game thread", bench::Median(system), bench::Median(pooled));
+    std::printf("BodyPool blocks from operator new after the first run: %lu\n",
+                static_cast<unsigned long>(steady.systemAllocations - warm.systemAllocations));
+    return 0;
+}
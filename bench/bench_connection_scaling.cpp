@@ -0,0 +1,134 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Echo throughput of the TCP server from 1 to N io threads
+*/
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "BenchCommon.hpp"
+#include "NetClient.hpp"
+#include "NetServer.hpp"
+
+using namespace RType::net;
+
+enum class Msg : uint32_t { Echo };
+
+/**
+ * @brief Sends every message back to its sender
+ */
+class EchoServer : public ServerInterface<Msg> {
+   public:
+    using ServerInterface::ServerInterface;
+
+   protected:
+    bool OnClientConnect(std::shared_ptr<TcpConnection<Msg>> /* client */) override { return true; }
+    void OnClientDisconnect(std::shared_ptr<TcpConnection<Msg>> /* client */) override {}
+    void OnClientValidated(std::shared_ptr<TcpConnection<Msg>> /* client */) override {}
+    void OnMessage(std::shared_ptr<TcpConnection<Msg>> client, message<Msg>& msg) override { client->Send(msg); }
+};
+
+/**
+ * @brief Counts the echoes and sums their payload
+ */
+class EchoClient : public ClientInterface<Msg> {
+   public:
+    uint64_t received = 0;
+    uint64_t sum = 0;
+
+   protected:
+    void OnMessage(message<Msg>& msg) override {
+        uint64_t value = 0;
+        msg >> value;
+        sum += value;
+        received++;
+    }
+};
+
+/**
+ * @brief clients clients each send messages messages, the server echoes them on threads io threads
+ *
+ * @return double Round trips per second, 0 if the run timed out
+ */
+static double Run(uint16_t port, size_t threads, int clients, uint64_t messages) {
+    EchoServer server(port, threads);
+    if (!server.Start())
+        return 0.0;
+
+    std::vector<std::unique_ptr<EchoClient>> connections;
+    for (int c = 0; c < clients; c++) {
+        connections.push_back(std::make_unique<EchoClient>());
+        connections.back()->ConnectToServer("127.0.0.1", port);
+    }
+    auto deadline = bench::Clock::now() + std::chrono::seconds(10);
+    for (auto& client : connections) {
+        while (!client->IsConnected() && bench::Clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // Let the server validate every client before timing
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto start = bench::Clock::now();
+    for (uint64_t i = 0; i < messages; i++) {
+        for (auto& client : connections) {
+            message<Msg> msg;
+            msg.header.id = Msg::Echo;
+            msg << i;
+            client->Send(msg);
+        }
+    }
+
+    uint64_t total = messages * static_cast<uint64_t>(clients);
+    uint64_t received = 0;
+    deadline = bench::Clock::now() + std::chrono::seconds(30);
+    while (received < total && bench::Clock::now() < deadline) {
+        server.Update(-1, false);
+        received = 0;
+        for (auto& client : connections) {
+            client->PollBatch();
+            received += client->received;
+        }
+    }
+    double seconds = bench::Seconds(start);
+
+    uint64_t sum = 0;
+    for (auto& client : connections) {
+        sum += client->sum;
+        client->Disconnect();
+    }
+    server.Stop();
+
+    if (received < total) {
+        std::printf("timed out with %lu of %lu echoes\n", received, total);
+        return 0.0;
+    }
+    bench::Check(sum == static_cast<uint64_t>(clients) * (messages * (messages - 1) / 2), "every message is echoed once");
+    return static_cast<double>(total) / seconds;
+}
+
+int main(int argc, char** argv) {
+    size_t maxThreads = static_cast<size_t>(bench::Arg(argc, argv, 1, std::max(1u, std::thread::hardware_concurrency())));
+    int clients = static_cast<int>(bench::Arg(argc, argv, 2, 16));
+    uint64_t messages = static_cast<uint64_t>(bench::Arg(argc, argv, 3, 200000 / clients));
+    uint16_t port = static_cast<uint16_t>(bench::Arg(argc, argv, 4, 46100));
+
+    std::printf("%u hardware threads, %d clients, %lu messages each\n", std::thread::hardware_concurrency(), clients, messages);
+    std::printf("%-12s %14s %10s\n", "io threads", "round trips/s", "speedup");
+    // 1, 2, 4, ... and the maximum
+    std::vector<size_t> steps;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2)
+        steps.push_back(threads);
+    steps.push_back(std::max<size_t>(maxThreads, 1));
+
+    double baseline = 0.0;
+    for (size_t threads : steps) {
+        double rate = Run(port++, threads, clients, messages);
+        if (threads == 1)
+            baseline = rate;
+        std::printf("%-12lu %14.0f %9.2fx\n", threads, rate, baseline > 0.0 ? rate / baseline : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Latency of control messages behind a bulk flood, one FIFO against the send lanes
+*/
+
+#include <atomic>
+#include <thread>
+
+#include "BenchCommon.hpp"
+#include "NetClient.hpp"
+#include "NetServer.hpp"
+#include "RTypeServerMessages.hpp"
+
+using namespace RType::net;
+using RType::ServerMessages;
+
+/// Same ids as ServerMessages without a SendLanes table, every message shares one FIFO
+enum class FifoMessages : uint32_t {};
+
+static int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(bench::Clock::now().time_since_epoch()).count();
+}
+
+template <typename MessageType>
+constexpr MessageType Id(ServerMessages id) {
+    return static_cast<MessageType>(static_cast<uint32_t>(id));
+}
+
+template <typename MessageType>
+class SilentServer : public ServerInterface<MessageType> {
+   public:
+    using ServerInterface<MessageType>::ServerInterface;
+
+   protected:
+    bool OnClientConnect(std::shared_ptr<TcpConnection<MessageType>> /* client */) override { return true; }
+    void OnClientDisconnect(std::shared_ptr<TcpConnection<MessageType>> /* client */) override {}
+    void OnClientValidated(std::shared_ptr<TcpConnection<MessageType>> /* client */) override {}
+    void OnMessage(std::shared_ptr<TcpConnection<MessageType>> /* client */, message<MessageType>& /* msg */) override {}
+};
+
+/**
+ * @brief Records the latency of the control messages, counts the bulk bytes
+ */
+template <typename MessageType>
+class LatencyClient : public ClientInterface<MessageType> {
+   public:
+    std::vector<int64_t> latencies;
+    uint64_t bulkBytes = 0;
+
+   protected:
+    void OnMessage(message<MessageType>& msg) override {
+        if (msg.header.id == Id<MessageType>(ServerMessages::ServerDeny)) {
+            int64_t sent = 0;
+            msg >> sent;
+            latencies.push_back(NowNs() - sent);
+        } else {
+            bulkBytes += msg.body.size();
+        }
+    }
+};
+
+/**
+ * @brief Keep 256 bulk messages of 8KiB queued for one client, send a control message every 5ms
+ */
+template <typename MessageType>
+static void Run(const char* name, uint16_t port, int seconds) {
+    SilentServer<MessageType> server(port);
+    BackpressureConfig<MessageType> config;
+    config.maxQueuedBytes = 0;
+    config.maxQueuedMessages = 0;
+    server.SetBackpressure(config);
+    if (!server.Start())
+        return;
+
+    LatencyClient<MessageType> client;
+    client.ConnectToServer("127.0.0.1", port);
+    auto deadline = bench::Clock::now() + std::chrono::seconds(10);
+    while ((!client.IsConnected() || server.GetClientCount() == 0) && bench::Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    bench::Check(server.GetClientCount() == 1, "the client is connected");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto connection = server.GetClients().front();
+
+    std::atomic<bool> done = false;
+    std::thread poller([&]() {
+        while (!done)
+            client.PollBatch();
+    });
+
+    message<MessageType> bulk;
+    bulk.header.id = Id<MessageType>(ServerMessages::ServerLobbyUpdated);
+    bulk.body.resize(8192);
+    bulk.header.size = bulk.size();
+    auto sharedBulk = make_shared_message(bulk);
+
+    int sent = 0;
+    auto end = bench::Clock::now() + std::chrono::seconds(seconds);
+    auto nextControl = bench::Clock::now();
+    while (bench::Clock::now() < end) {
+        while (connection->GetOutgoingQueueSize() < 256)
+            server.MessageClient(connection, sharedBulk);
+        if (bench::Clock::now() >= nextControl) {
+            message<MessageType> control;
+            control.header.id = Id<MessageType>(ServerMessages::ServerDeny);
+            control << NowNs();
+            server.MessageClient(connection, control);
+            sent++;
+            nextControl += std::chrono::milliseconds(5);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    // The queued bulk drains before the last control messages of the FIFO run
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    done = true;
+    poller.join();
+    client.Disconnect();
+    server.Stop();
+
+    std::vector<int64_t> latencies = client.latencies;
+    std::sort(latencies.begin(), latencies.end());
+    bench::Check(!latencies.empty(), "control messages are received");
+    std::printf("%-6s %5zu/%-5d %10.1f %10.1f %10.1f %10.0f\n", name, latencies.size(), sent, bench::Percentile(latencies, 50) / 1e3,
+                bench::Percentile(latencies, 99) / 1e3, latencies.back() / 1e3, static_cast<double>(client.bulkBytes) / 1e6 / seconds);
+}
+
+int main(int argc, char** argv) {
+    int seconds = static_cast<int>(bench::Arg(argc, argv, 1, 3));
+    uint16_t port = static_cast<uint16_t>(bench::Arg(argc, argv, 2, 46200));
+
+    std::printf("control message every 5ms behind 256 queued 8KiB bulk messages, %ds per run\n", seconds);
+    std::printf("%-6s %11s %10s %10s %10s %10s\n", "", "received", "p50 us", "p99 us", "max us", "bulk MB/s");
+    Run<FifoMessages>("fifo", port, seconds);
+    Run<ServerMessages>("lanes", port + 1, seconds);
+    return 0;
+}
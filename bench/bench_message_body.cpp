@@ -0,0 +1,182 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Message body, the inline SmallVector body against a std::vector body
+*/
+
+#include <random>
+
+#include "BenchCommon.hpp"
+#include "NetMessage.hpp"
+
+using RType::net::message;
+using RType::net::message_header;
+
+enum class Msg : uint32_t { Move };
+
+/**
+ * @brief A typical gameplay message, 40 bytes with the tick
+ */
+struct Move {
+    uint32_t tick;
+    uint8_t uuid[16];
+    float position[2];
+    float velocity[2];
+};
+
+/**
+ * @brief The message as it was before the inline body, same operators over a std::vector
+ */
+struct VectorMessage {
+    message_header<Msg> header{};
+    std::vector<uint8_t> body;
+
+    template <typename DataType>
+    VectorMessage& operator<<(const DataType& data) {
+        size_t i = body.size();
+        body.resize(i + sizeof(DataType));
+        std::memcpy(body.data() + i, &data, sizeof(DataType));
+        header.size = static_cast<uint32_t>(body.size());
+        return *this;
+    }
+
+    template <typename DataType>
+    VectorMessage& operator>>(DataType& data) {
+        size_t i = body.size() - sizeof(DataType);
+        std::memcpy(&data, body.data() + i, sizeof(DataType));
+        body.resize(i);
+        header.size = static_cast<uint32_t>(body.size());
+        return *this;
+    }
+};
+
+/**
+ * @brief Build a Move message, read it back, once per seed
+ *
+ * The seeds come from the command line side of the benchmark, the body pointer
+ * escapes every iteration, so neither the allocation nor the copies can be elided.
+ *
+ * @return double Nanoseconds per message
+ */
+template <typename Message>
+static double BuildAndRead(const std::vector<uint32_t>& seeds, uint64_t& checksum) {
+    auto start = bench::Clock::now();
+    for (uint32_t seed : seeds) {
+        Message msg;
+        Move move{};
+        move.tick = seed;
+        move.uuid[seed % 16] = static_cast<uint8_t>(seed);
+        msg << move << seed;
+        bench::DoNotOptimize(msg.body.data());
+
+        uint32_t tail = 0;
+        Move out{};
+        msg >> tail >> out;
+        checksum += out.tick + tail + out.uuid[seed % 16];
+    }
+    return bench::Seconds(start) * 1e9 / static_cast<double>(seeds.size());
+}
+
+/**
+ * @brief Build messages of the given sizes, move them through a queue, then read them
+ *
+ * This is the path of an incoming message: built by the read handler, moved into the
+ * queue, moved out by Update. Sizes over MessageInlineSize spill to the allocator.
+ *
+ * @return double Nanoseconds per message
+ */
+template <typename Message>
+static double ThroughQueue(const std::vector<uint32_t>& sizes, uint64_t& checksum) {
+    std::vector<Message> queue;
+    queue.reserve(1024);
+
+    auto start = bench::Clock::now();
+    for (size_t first = 0; first < sizes.size(); first += 1024) {
+        size_t last = std::min(sizes.size(), first + 1024);
+        for (size_t i = first; i < last; i++) {
+            Message msg;
+            for (uint32_t word = 0; word < sizes[i] / sizeof(uint32_t); word++)
+                msg << static_cast<uint32_t>(i + word);
+            queue.push_back(std::move(msg));
+        }
+        for (auto& msg : queue) {
+            Message owned = std::move(msg);
+            bench::DoNotOptimize(owned.body.data());
+            uint32_t word = 0;
+            if (!owned.body.empty())
+                owned >> word;
+            checksum += word + owned.body.size();
+        }
+        queue.clear();
+    }
+    return bench::Seconds(start) * 1e9 / static_cast<double>(sizes.size());
+}
+
+/**
+ * @brief Copy each message of the given sizes once, as a broadcast to one more client does
+ *
+ * @return double Nanoseconds per copy
+ */
+template <typename Message>
+static double Copy(const std::vector<uint32_t>& sizes, uint64_t& checksum) {
+    std::vector<Message> sources(64);
+    for (size_t i = 0; i < sources.size(); i++) {
+        for (uint32_t word = 0; word < sizes[i] / sizeof(uint32_t); word++)
+            sources[i] << static_cast<uint32_t>(word);
+    }
+
+    auto start = bench::Clock::now();
+    for (size_t i = 0; i < sizes.size(); i++) {
+        Message copy = sources[i % sources.size()];
+        bench::DoNotOptimize(copy.body.data());
+        checksum += copy.body.size();
+    }
+    return bench::Seconds(start) * 1e9 / static_cast<double>(sizes.size());
+}
+
+/**
+ * @brief Median of runs calls to case, the checksums of both bodies must match
+ */
+template <typename Case>
+static void Report(const char* name, int runs, Case&& run) {
+    std::vector<double> vector;
+    std::vector<double> inline_;
+    uint64_t vectorSum = 0;
+    uint64_t inlineSum = 0;
+    for (int r = 0; r < runs; r++) {
+        vector.push_back(run(VectorMessage{}, vectorSum));
+        inline_.push_back(run(message<Msg>{}, inlineSum));
+    }
+    bench::Check(vectorSum == inlineSum, "both bodies read the same bytes");
+    bench::DoNotOptimize(vectorSum);
+    std::printf("%-28s %10.1f %12.1f\n", name, bench::Median(vector), bench::Median(inline_));
+}
+
+int main(int argc, char** argv) {
+    size_t count = static_cast<size_t>(bench::Arg(argc, argv, 1, 2000000));
+    int runs = static_cast<int>(bench::Arg(argc, argv, 2, 5));
+    uint32_t maxSize = static_cast<uint32_t>(bench::Arg(argc, argv, 3, 512));
+
+    std::mt19937 random(static_cast<uint32_t>(count));
+    std::vector<uint32_t> seeds(count);
+    for (auto& seed : seeds)
+        seed = random();
+    std::uniform_int_distribution<uint32_t> small(1, RType::net::MessageInlineSize / sizeof(uint32_t));
+    std::uniform_int_distribution<uint32_t> any(1, std::max<uint32_t>(maxSize / sizeof(uint32_t), 1));
+    std::vector<uint32_t> inlineSizes(count);
+    std::vector<uint32_t> mixedSizes(count);
+    for (size_t i = 0; i < count; i++) {
+        inlineSizes[i] = small(random) * sizeof(uint32_t);
+        mixedSizes[i] = any(random) * sizeof(uint32_t);
+    }
+
+    std::printf("%lu messages, median of %d runs, inline size %lu bytes\n", count, runs, RType::net::MessageInlineSize);
+    std::printf("%-28s %10s %12s\n", "ns per message", "std::vector", "SmallVector");
+    Report("build and read a Move", runs, [&](auto message, uint64_t& sum) { return BuildAndRead<decltype(message)>(seeds, sum); });
+    Report("queue, inline sizes", runs, [&](auto message, uint64_t& sum) { return ThroughQueue<decltype(message)>(inlineSizes, sum); });
+    Report("queue, sizes up to max", runs, [&](auto message, uint64_t& sum) { return ThroughQueue<decltype(message)>(mixedSizes, sum); });
+    Report("copy, inline sizes", runs, [&](auto message, uint64_t& sum) { return Copy<decltype(message)>(inlineSizes, sum); });
+    Report("copy, sizes up to max", runs, [&](auto message, uint64_t& sum) { return Copy<decltype(message)>(mixedSizes, sum); });
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Incoming queue contention, MpscQueue against the mutex based TsQueue
+*/
+
+#include <thread>
+
+#include "BenchCommon.hpp"
+#include "NetMpscQueue.hpp"
+
+using RType::net::MpscQueue;
+using RType::net::TsQueue;
+
+/**
+ * @brief producers threads push items each into Queue while one thread drains it in batches
+ *
+ * @return double Millions of items per second through the queue
+ */
+template <typename Queue>
+static double Run(int producers, uint64_t items) {
+    Queue queue;
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> batch;
+    batch.reserve(4096);
+
+    auto start = bench::Clock::now();
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, items]() {
+            for (uint64_t i = 0; i < items; i++)
+                queue.push_back(i);
+        });
+    }
+
+    uint64_t received = 0;
+    uint64_t sum = 0;
+    uint64_t total = items * static_cast<uint64_t>(producers);
+    while (received < total) {
+        queue.wait();
+        batch.clear();
+        queue.drain_into(batch);
+        for (uint64_t value : batch)
+            sum += value;
+        received += batch.size();
+    }
+    double seconds = bench::Seconds(start);
+    for (auto& thread : threads)
+        thread.join();
+
+    bench::Check(sum == static_cast<uint64_t>(producers) * (items * (items - 1) / 2), "every item is received once");
+    bench::DoNotOptimize(sum);
+    return static_cast<double>(total) / seconds / 1e6;
+}
+
+int main(int argc, char** argv) {
+    uint64_t items = static_cast<uint64_t>(bench::Arg(argc, argv, 1, 1000000));
+    int runs = static_cast<int>(bench::Arg(argc, argv, 2, 5));
+
+    std::printf("%u hardware threads, %lu items per producer, median of %d runs\n",
+                std::thread::hardware_concurrency(), static_cast<unsigned long>(items), runs);
+    std::printf("producers   TsQueue Mops/s   MpscQueue Mops/s\n");
+    for (int producers : {1, 2, 4, 8}) {
+        std::vector<double> locked, lockFree;
+        for (int r = 0; r < runs; r++) {
+            locked.push_back(Run<TsQueue<uint64_t>>(producers, items));
+            lockFree.push_back(Run<MpscQueue<uint64_t>>(producers, items));
+        }
+        std::printf("%9d   %14.2f   %16.2f\n", producers, bench::Median(locked), bench::Median(lockFree));
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Arming, cancelling and firing 100k timers, TimerWheel against one asio timer each
+*/
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "BenchCommon.hpp"
+#include "NetTimerWheel.hpp"
+
+using RType::net::TimerWheel;
+
+struct Result {
+    double arm;     ///< Nanoseconds per armed timer
+    double cancel;  ///< Nanoseconds per cancelled timer
+};
+
+/**
+ * @brief Arm count handshake-like timers, seconds away, then cancel every one of them
+ */
+static Result WheelArmCancel(int count) {
+    asio::io_context context;
+    auto work = asio::make_work_guard(context);
+    TimerWheel wheel(context);
+    std::thread thread([&context]() { context.run(); });
+
+    std::vector<TimerWheel::Handle> handles(count);
+    auto start = bench::Clock::now();
+    for (int i = 0; i < count; i++)
+        handles[i] = wheel.AddTimer(std::chrono::milliseconds(5000 + i % 1000), []() {});
+    double arm = bench::Seconds(start);
+    bench::Check(wheel.GetTimerCount() == static_cast<size_t>(count), "every timer is armed");
+
+    int cancelled = 0;
+    start = bench::Clock::now();
+    for (auto handle : handles)
+        cancelled += wheel.CancelTimer(handle);
+    double cancel = bench::Seconds(start);
+    bench::Check(cancelled == count && wheel.GetTimerCount() == 0, "every timer is cancelled");
+
+    work.reset();
+    context.stop();
+    thread.join();
+    return {arm * 1e9 / count, cancel * 1e9 / count};
+}
+
+/**
+ * @brief Same as WheelArmCancel with one asio::steady_timer per timer
+ */
+static Result AsioArmCancel(int count) {
+    asio::io_context context;
+    std::vector<std::unique_ptr<asio::steady_timer>> timers;
+    timers.reserve(count);
+    int aborted = 0;
+
+    auto start = bench::Clock::now();
+    for (int i = 0; i < count; i++) {
+        timers.push_back(std::make_unique<asio::steady_timer>(context, std::chrono::milliseconds(5000 + i % 1000)));
+        timers.back()->async_wait([&aborted](std::error_code ec) { aborted += ec == asio::error::operation_aborted; });
+    }
+    double arm = bench::Seconds(start);
+
+    start = bench::Clock::now();
+    for (auto& timer : timers)
+        timer->cancel();
+    double cancel = bench::Seconds(start);
+
+    context.run();
+    bench::Check(aborted == count, "every timer is cancelled");
+    return {arm * 1e9 / count, cancel * 1e9 / count};
+}
+
+/**
+ * @brief Fire count timers spread over spread, report how late they ran
+ */
+static void WheelFire(int count, std::chrono::milliseconds spread) {
+    asio::io_context context;
+    auto work = asio::make_work_guard(context);
+    TimerWheel wheel(context);
+    std::thread thread([&context]() { context.run(); });
+
+    std::vector<bench::Clock::time_point> due(count);
+    std::vector<double> lateness(count);
+    std::atomic<int> fired = 0;
+    for (int i = 0; i < count; i++) {
+        auto delay = std::chrono::milliseconds(i % spread.count());
+        due[i] = bench::Clock::now() + delay;
+        wheel.AddTimer(delay, [&, i]() {
+            lateness[i] = std::chrono::duration<double, std::micro>(bench::Clock::now() - due[i]).count();
+            fired++;
+        });
+    }
+    while (fired < count)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    work.reset();
+    context.stop();
+    thread.join();
+
+    std::sort(lateness.begin(), lateness.end());
+    bench::Check(lateness.front() >= 0.0, "no timer fires early");
+    std::printf("fire %d timers over %ldms: lateness p50 %.0fus p99 %.0fus max %.0fus\n", count, static_cast<long>(spread.count()),
+                bench::Percentile(lateness, 50), bench::Percentile(lateness, 99), lateness.back());
+}
+
+int main(int argc, char** argv) {
+    int count = static_cast<int>(bench::Arg(argc, argv, 1, 100000));
+    int runs = static_cast<int>(bench::Arg(argc, argv, 2, 5));
+
+    std::vector<double> wheelArm, wheelCancel, asioArm, asioCancel;
+    for (int r = 0; r < runs; r++) {
+        Result wheel = WheelArmCancel(count);
+        Result asio = AsioArmCancel(count);
+        wheelArm.push_back(wheel.arm);
+        wheelCancel.push_back(wheel.cancel);
+        asioArm.push_back(asio.arm);
+        asioCancel.push_back(asio.cancel);
+    }
+
+    std::printf("%d timers, median of %d runs\n", count, runs);
+    std::printf("%-22s %10s %10s\n", "ns per timer", "arm", "cancel");
+    std::printf("%-22s %10.0f %10.0f\n", "TimerWheel", bench::Median(wheelArm), bench::Median(wheelCancel));
+    std::printf("%-22s %10.0f %10.0f\n", "asio::steady_timer", bench::Median(asioArm), bench::Median(asioCancel));
+    WheelFire(count, std::chrono::milliseconds(1000));
+    return 0;
+}
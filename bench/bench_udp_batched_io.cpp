@@ -0,0 +1,118 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Datagrams per second received and sent, one per system call against recvmmsg and sendmmsg
+*/
+
+#include <atomic>
+#include <thread>
+
+#include "BenchCommon.hpp"
+#include "NetUdpServer.hpp"
+
+using RType::net::UdpServerInterface;
+
+/**
+ * @brief Counts the datagrams it receives and sends
+ */
+class CountingPeer : public UdpServerInterface {
+   public:
+    using UdpServerInterface::UdpServerInterface;
+
+    std::atomic<uint64_t> received = 0;
+    std::atomic<uint64_t> sent = 0;
+
+   protected:
+    void onStarted() override { ReceiveAsync(); }
+    void onStopped() override {}
+    void onConnected() override {}
+    void onDisconnected() override {}
+    void onReceived(const asio::ip::udp::endpoint& /* endpoint */, const void* /* buffer */, size_t /* size */) override {
+        received.fetch_add(1, std::memory_order_relaxed);
+        ReceiveAsync();
+    }
+    void onSent(const asio::ip::udp::endpoint& /* endpoint */, size_t /* sent */) override { sent.fetch_add(1, std::memory_order_relaxed); }
+    void onError(int /* error */, const std::string& /* category */, const std::string& message) override {
+        std::printf("error: %s\n", message.c_str());
+    }
+};
+
+struct Result {
+    double receive;  ///< Datagrams received per second
+    double send;     ///< Datagrams sent per second
+};
+
+/**
+ * @brief Measure one peer for seconds each way, batchSize 0 for one datagram per system call
+ */
+static Result Run(uint16_t port, size_t batchSize, size_t datagramSize, double seconds) {
+    asio::io_context context;
+    auto work = asio::make_work_guard(context);
+    auto peer = std::make_shared<CountingPeer>(context, port);
+    if (batchSize > 0)
+        bench::Check(peer->EnableBatchedIo(batchSize), "batched I/O is available");
+    peer->Start();
+    std::thread io([&context]() { context.run(); });
+    while (!peer->IsStarted())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    peer->GetSocket().set_option(asio::socket_base::receive_buffer_size(4 << 20));
+
+    std::vector<uint8_t> datagram(datagramSize, 0x2a);
+    asio::io_context blasterContext;
+    asio::ip::udp::endpoint local(asio::ip::make_address("127.0.0.1"), 0);
+    asio::ip::udp::socket blaster(blasterContext, local);
+    asio::ip::udp::endpoint peerEndpoint(asio::ip::make_address("127.0.0.1"), port);
+
+    // Receive: a plain socket floods the peer from another thread, drops on a full buffer are expected
+    std::atomic<bool> stop = false;
+    std::thread flood([&]() {
+        asio::error_code ec;
+        while (!stop)
+            blaster.send_to(asio::buffer(datagram), peerEndpoint, 0, ec);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uint64_t before = peer->received;
+    auto start = bench::Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    double receive = static_cast<double>(peer->received - before) / bench::Seconds(start);
+    stop = true;
+    flood.join();
+
+    // Send: to the blaster socket, which nobody reads, in ticks of 256 datagrams
+    asio::ip::udp::endpoint sink = blaster.local_endpoint();
+    before = peer->sent;
+    start = bench::Clock::now();
+    while (bench::Seconds(start) < seconds) {
+        for (int i = 0; i < 256; i++)
+            peer->SendAsync(sink, datagram.data(), datagram.size());
+        peer->Flush();
+        while (peer->GetSendQueueSize() > 512)
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    double send = static_cast<double>(peer->sent - before) / bench::Seconds(start);
+
+    peer->Stop();
+    work.reset();
+    context.stop();
+    io.join();
+    bench::Check(receive > 0.0 && send > 0.0, "datagrams go through both ways");
+    return {receive, send};
+}
+
+int main(int argc, char** argv) {
+    size_t batchSize = static_cast<size_t>(bench::Arg(argc, argv, 1, 64));
+    size_t datagramSize = static_cast<size_t>(bench::Arg(argc, argv, 2, 64));
+    double seconds = static_cast<double>(bench::Arg(argc, argv, 3, 1));
+    uint16_t port = static_cast<uint16_t>(bench::Arg(argc, argv, 4, 46300));
+
+    std::printf("%zu byte datagrams over loopback, %.0fs each way\n", datagramSize, seconds);
+    std::printf("%-22s %14s %14s\n", "datagrams per second", "received", "sent");
+    Result single = Run(port, 0, datagramSize, seconds);
+    std::printf("%-22s %14.0f %14.0f\n", "one per call", single.receive, single.send);
+    Result batched = Run(port + 1, batchSize, datagramSize, seconds);
+    char name[32];
+    std::snprintf(name, sizeof(name), "batches of %zu", batchSize);
+    std::printf("%-22s %14.0f %14.0f\n", name, batched.receive, batched.send);
+    return 0;
+}
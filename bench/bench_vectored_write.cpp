@@ -0,0 +1,141 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Writes per message of small TCP messages, one message per write against coalesced writev
+*/
+
+#include <future>
+#include <thread>
+
+#include "BenchCommon.hpp"
+#include "NetClient.hpp"
+#include "NetServer.hpp"
+
+using namespace RType::net;
+
+enum class Msg : uint32_t { Update };
+
+/// Body of a lobby or control sized message
+constexpr size_t BodySize = 24;
+
+class SilentServer : public ServerInterface<Msg> {
+   public:
+    using ServerInterface::ServerInterface;
+
+   protected:
+    bool OnClientConnect(std::shared_ptr<TcpConnection<Msg>> /* client */) override { return true; }
+    void OnClientDisconnect(std::shared_ptr<TcpConnection<Msg>> /* client */) override {}
+    void OnClientValidated(std::shared_ptr<TcpConnection<Msg>> /* client */) override {}
+    void OnMessage(std::shared_ptr<TcpConnection<Msg>> /* client */, message<Msg>& /* msg */) override {}
+};
+
+/**
+ * @brief Counts the messages and sums the values they carry
+ */
+class CountingClient : public ClientInterface<Msg> {
+   public:
+    uint64_t received = 0;
+    uint64_t sum = 0;
+
+   protected:
+    void OnMessage(message<Msg>& msg) override {
+        uint64_t value = 0;
+        std::memcpy(&value, msg.body.data(), sizeof(value));
+        sum += value;
+        received++;
+    }
+};
+
+struct Mode {
+    const char* name;
+    size_t maxBytes;
+    size_t maxBuffers;
+};
+
+/**
+ * @brief Send bursts of small messages, as a server tick would, and poll the client until each burst arrived
+ */
+static void Run(SilentServer& server, CountingClient& client, std::shared_ptr<TcpConnection<Msg>> connection, const Mode& mode, int bursts, int burstSize) {
+    std::promise<void> configured;
+    asio::post(connection->GetExecutor(), [&]() {
+        connection->SetWriteCoalescing(mode.maxBytes, mode.maxBuffers);
+        configured.set_value();
+    });
+    configured.get_future().wait();
+
+    uint64_t received = client.received;
+    uint64_t sum = client.sum;
+    uint64_t expectedSum = 0;
+    auto before = server.GetStats();
+    std::vector<double> burstUs;
+    burstUs.reserve(bursts);
+    message<Msg> msg;
+    msg.header.id = Msg::Update;
+    msg.body.resize(BodySize);
+    msg.header.size = msg.size();
+
+    auto start = bench::Clock::now();
+    for (int i = 0; i < bursts; i++) {
+        auto burstStart = bench::Clock::now();
+        // Queued from the connection strand, the whole burst is waiting when the first write completes
+        asio::post(connection->GetExecutor(), [&, i]() {
+            for (int j = 0; j < burstSize; j++) {
+                uint64_t value = static_cast<uint64_t>(i) * burstSize + j + 1;
+                std::memcpy(msg.body.data(), &value, sizeof(value));
+                server.MessageClient(connection, msg);
+            }
+        });
+        for (int j = 0; j < burstSize; j++)
+            expectedSum += static_cast<uint64_t>(i) * burstSize + j + 1;
+        received += burstSize;
+        while (client.received < received) {
+            if (client.PollBatch() == 0)
+                std::this_thread::yield();
+        }
+        burstUs.push_back(std::chrono::duration<double, std::micro>(bench::Clock::now() - burstStart).count());
+    }
+    double seconds = bench::Seconds(start);
+    auto after = server.GetStats();
+
+    bench::Check(client.sum - sum == expectedSum, "every message arrives intact");
+    uint64_t messages = after.messagesOut - before.messagesOut;
+    uint64_t writes = after.writeLatency.count - before.writeLatency.count;
+    bench::Check(messages == static_cast<uint64_t>(bursts) * burstSize, "the stats count every message");
+    std::printf("%-12s %10.3f %10.1f %10.2f %12.1f\n", mode.name, static_cast<double>(writes) / static_cast<double>(messages),
+                static_cast<double>(messages) / static_cast<double>(writes), static_cast<double>(messages) / seconds / 1e6, bench::Median(burstUs));
+}
+
+int main(int argc, char** argv) {
+    int bursts = static_cast<int>(bench::Arg(argc, argv, 1, 2000));
+    int burstSize = static_cast<int>(bench::Arg(argc, argv, 2, 64));
+    uint16_t port = static_cast<uint16_t>(bench::Arg(argc, argv, 3, 46400));
+
+    SilentServer server(port);
+    if (!server.Start())
+        return 1;
+    CountingClient client;
+    client.ConnectToServer("127.0.0.1", port);
+    auto deadline = bench::Clock::now() + std::chrono::seconds(10);
+    while ((!client.IsConnected() || server.GetClientCount() == 0) && bench::Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    bench::Check(server.GetClientCount() == 1, "the client is connected");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto connection = server.GetClients().front();
+
+    // One write is one sendmsg on loopback, the former header then body path took two per message
+    std::printf("%d bursts of %d messages of %zu bytes, one write is one sendmsg\n", bursts, burstSize, BodySize + sizeof(message_header<Msg>));
+    std::printf("%-12s %10s %10s %10s %12s\n", "", "writes/msg", "msgs/write", "Mmsg/s", "burst us p50");
+    const Mode modes[] = {
+        {"1 per write", 64 * 1024, 2},
+        {"8 per write", 64 * 1024, 16},
+        {"default", 64 * 1024, 64},
+        {"1024 iovecs", 64 * 1024, 1024},
+    };
+    for (const auto& mode : modes)
+        Run(server, client, connection, mode, bursts, burstSize);
+
+    client.Disconnect();
+    server.Stop();
+    return 0;
+}
@@ -12,7 +12,8 @@ set(IS_BUILDING_DOC OFF)
 include(external/FindAsio.cmake)
 include(external/FindStduuid.cmake)
 include(external/FindGlm.cmake)
-include(external/FindGTest.cmake)
 
 set(IS_TESTING ${IS_TESTING_TMP})
 set(IS_BUILDING_DOC ${IS_BUILDING_DOC_TMP})
+
+include(external/FindGTest.cmake)
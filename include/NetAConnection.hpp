@@ -12,7 +12,13 @@
 #pragma once
 
 #include "NetCommon.hpp"
+#include "NetFlatMap.hpp"
+#include "NetHeartbeat.hpp"
 #include "NetMessage.hpp"
+#include "NetMpscQueue.hpp"
+#include "NetSendLanes.hpp"
+#include "NetStats.hpp"
+#include "NetTimerWheel.hpp"
 #include "NetTsqueue.hpp"
 
 namespace RType {
@@ -25,6 +31,38 @@ namespace RType {
         template <typename T>
         class TcpConnection;
 
+        /**
+         * @brief What a connection does when its outgoing queue reaches a high-water mark
+         */
+        enum class BackpressurePolicy : uint8_t {
+            Disconnect,  ///< Close the connection
+            DropOldest   ///< Drop the oldest queued messages, lowest priority lane first, until the new one fits
+        };
+
+        /**
+         * @brief Limits of the outgoing queue of a connection
+         *
+         * @tparam MessageType The enum class containing all the message types
+         */
+        template <typename MessageType>
+        struct BackpressureConfig {
+            size_t maxQueuedBytes = 16 * 1024 * 1024;                    ///< Byte high-water mark, 0 for no limit
+            size_t maxQueuedMessages = 64 * 1024;                        ///< Message high-water mark, 0 for no limit
+            BackpressurePolicy policy = BackpressurePolicy::Disconnect;  ///< Applied when a mark is reached
+            std::vector<MessageType> conflated;                          ///< Ids where only the latest message matters, replaced in place on every send
+        };
+
+        /**
+         * @brief Reported each time a connection applies its backpressure policy
+         */
+        struct BackpressureEvent {
+            BackpressurePolicy policy;  ///< The applied policy
+            size_t queuedMessages;      ///< Queued messages when the mark was reached
+            size_t queuedBytes;         ///< Queued bytes when the mark was reached
+            size_t droppedMessages;     ///< Messages dropped, the whole queue on a disconnect
+            bool disconnected;          ///< Whether the connection was closed
+        };
+
         /**
          * @brief Abstract class for a connection
          * @tparam MessageType The enum class containing all the message types
@@ -43,11 +81,10 @@ namespace RType {
             AConnection(owner parent,
                         asio::io_context& context,
                         asio::ip::tcp::socket socket,
-                        TsQueue<owned_message<MessageType, TcpConnection<MessageType>>>& incomingMessages) : asioContext_(context),
+                        IncomingQueue<owned_message<MessageType, TcpConnection<MessageType>>>& incomingMessages) : asioContext_(context),
                                                                                                              tcpSocket(std::move(socket)),
                                                                                                              incomingTcpMessages_(incomingMessages) {
                 connectionOwner_ = parent;
-                AsyncTimer::Construct();
                 if (connectionOwner_ == owner::server) {
                     handshakeOut_ = uint64_t(std::chrono::system_clock::now().time_since_epoch().count());
 
@@ -57,6 +94,7 @@ namespace RType {
                     handshakeIn_ = 0;
                     handshakeOut_ = 0;
                 }
+                SetLaneQuanta(DefaultLaneQuanta);
             }
 
             /**
@@ -100,13 +138,28 @@ namespace RType {
             /**
              * @brief Disconnect the connection
              *
+             * Callable from any thread, the heartbeats are stopped and the socket closed
+             * on the connection executor.
              */
             void Disconnect() {
-                if (IsConnected()) {
-                    asio::post(asioContext_, [this]() {
-                        tcpSocket.close();
-                    });
-                }
+                asio::post(GetExecutor(), [this, self = KeepAlive()]() {
+                    heartbeatStopped_ = true;
+                    if (heartbeatTimers_ != nullptr)
+                        heartbeatTimers_->CancelTimer(heartbeatTimer_);
+                    tcpSocket.close();
+                });
+            }
+
+            /**
+             * @brief Get the executor of the connection, its strand on a server
+             *
+             * Everything touching the socket runs through it, so the read and write chains
+             * of a connection never run concurrently even with several io threads.
+             *
+             * @return asio::any_io_executor The executor
+             */
+            [[nodiscard]] asio::any_io_executor GetExecutor() {
+                return tcpSocket.get_executor();
             }
 
             /**
@@ -128,24 +181,131 @@ namespace RType {
              */
             virtual void Send(const message<MessageType>& msg) = 0;
 
-           private:
-            virtual void WriteHeader() = 0;
+            /**
+             * @brief Send a shared message without copying its body
+             *
+             * @param msg The message to send
+             */
+            virtual void Send(shared_message<MessageType> msg) = 0;
+
+            /**
+             * @brief Set how many queued messages can be coalesced into a single write
+             *
+             * A write always carries at least one message, even if it is bigger than maxBytes.
+             *
+             * @param maxBytes The maximum number of bytes gathered in one write
+             * @param maxBuffers The maximum number of buffers (iovecs) gathered in one write
+             */
+            void SetWriteCoalescing(size_t maxBytes, size_t maxBuffers) {
+                maxWriteBytes_ = maxBytes;
+                maxWriteBuffers_ = maxBuffers;
+            }
+
+            /**
+             * @brief Set how many bytes each priority lane may write per scheduling round
+             *
+             * The lanes are served in priority order, each one up to its quantum, so the
+             * Control lane goes first while every non-empty lane still gets its share of
+             * the bandwidth. A message bigger than a quantum waits for a few rounds.
+             *
+             * @param quanta Bytes per round of each lane, indexed by SendLane, at least 1
+             */
+            void SetLaneQuanta(const std::array<size_t, SendLaneCount>& quanta) {
+                for (size_t i = 0; i < SendLaneCount; i++)
+                    lanes_[i].quantum = std::max<size_t>(quanta[i], 1);
+            }
 
-            virtual void WriteBody() = 0;
+            /**
+             * @brief Answer the heartbeats of the peer and send our own, must be called before the connection starts
+             *
+             * Heartbeats are messages with the id pingId, they never reach the incoming queue.
+             * The connection is closed once maxMissed pings in a row went unanswered.
+             *
+             * @param timers The timer wheel running on the connection context
+             * @param pingId The message id of the heartbeats, the same on both sides
+             * @param interval Time between two pings, 0 to only answer the pings of the peer
+             * @param maxMissed Unanswered pings before the connection is closed
+             */
+            void SetHeartbeat(TimerWheel& timers, MessageType pingId, std::chrono::milliseconds interval, uint32_t maxMissed) {
+                heartbeatTimers_ = &timers;
+                heartbeatId_ = pingId;
+                heartbeatInterval_ = interval;
+                heartbeatMaxMissed_ = std::max<uint32_t>(maxMissed, 1);
+            }
 
-            virtual void ReadHeader() = 0;
+            /**
+             * @brief Smoothed round trip time measured by the heartbeats, 0 before the first pong
+             */
+            [[nodiscard]] std::chrono::microseconds GetRtt() const { return std::chrono::microseconds(rttUs_.load(std::memory_order_relaxed)); }
 
-            virtual void ReadBody() = 0;
+            /**
+             * @brief Mean deviation of the round trip time, 0 before the first pong
+             */
+            [[nodiscard]] std::chrono::microseconds GetRttJitter() const { return std::chrono::microseconds(jitterUs_.load(std::memory_order_relaxed)); }
+
+            /**
+             * @brief Bound the outgoing queue, must be called before the connection starts
+             *
+             * The in flight write is never touched, only whole queued messages are dropped
+             * or replaced.
+             *
+             * @param config The high-water marks and the policy applied when one is reached
+             * @param onBackpressure Called on the connection executor each time the policy is applied, may be empty
+             */
+            void SetBackpressure(BackpressureConfig<MessageType> config, std::function<void(const BackpressureEvent&)> onBackpressure = nullptr) {
+                backpressure_ = std::move(config);
+                onBackpressure_ = std::move(onBackpressure);
+            }
+
+            /**
+             * @brief Count the traffic of the connection into counters too, must be called before the connection starts
+             *
+             * @param counters The server-wide counters, they must outlive the connection
+             */
+            void SetCounters(TcpCounters* counters) noexcept { counters_ = counters; }
+
+            [[nodiscard]] uint64_t GetBytesSent() const noexcept { return bytesSent_.load(std::memory_order_relaxed); }
+            [[nodiscard]] uint64_t GetBytesReceived() const noexcept { return bytesReceived_.load(std::memory_order_relaxed); }
+            [[nodiscard]] uint64_t GetMessagesSent() const noexcept { return messagesSent_.load(std::memory_order_relaxed); }
+            [[nodiscard]] uint64_t GetMessagesReceived() const noexcept { return messagesReceived_.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Number of messages waiting to be written in every lane, the write in flight excluded
+             */
+            [[nodiscard]] size_t GetOutgoingQueueSize() const noexcept { return outgoingDepth_.load(std::memory_order_relaxed); }
+
+           private:
+            virtual void WriteMessages() = 0;
+
+            virtual void ReadFrames() = 0;
 
             virtual void WriteValidation() = 0;
 
             virtual void ReadValidation(RType::net::ServerInterface<MessageType>* server = nullptr) = 0;
 
            protected:
+            /**
+             * @brief FIFO of the outgoing messages of one priority lane
+             */
+            struct OutgoingLane {
+                std::deque<shared_message<MessageType>> messages;  ///< Queued messages, oldest first
+                uint64_t pushed = 0;                               ///< Messages ever pushed
+                uint64_t popped = 0;                               ///< Messages ever popped
+                size_t quantum = 0;                                ///< Bytes added to deficit each round
+                size_t deficit = 0;                                ///< Bytes the lane may still write this round
+            };
+
             /**
              * @brief add a message to the incoming message queue
+             *
+             * @return false if the queue is full
              */
-            virtual void AddToIncomingMessageQueue() = 0;
+            virtual bool AddToIncomingMessageQueue() = 0;
+
+            /**
+             * @brief Reference held by the pending handlers, nullptr when the connection is not owned by a shared_ptr
+             */
+            virtual std::shared_ptr<TcpConnection<MessageType>> KeepAlive() = 0;
 
             /**
              * @brief scramble the input
@@ -164,14 +324,51 @@ namespace RType {
             asio::io_context& asioContext_;   ///< The asio context
             asio::ip::tcp::socket tcpSocket;  ///< The asio socket
 
-            TsQueue<message<MessageType>> outgoingMessages_;                                        ///< The outgoing message queue
-            TsQueue<owned_message<MessageType, TcpConnection<MessageType>>>& incomingTcpMessages_;  ///< The incoming message queue
+            std::array<OutgoingLane, SendLaneCount> lanes_;                                         ///< The outgoing message queues by priority, used on the executor only
+            size_t queuedMessages_ = 0;                                                             ///< Messages in lanes_
+            std::vector<shared_message<MessageType>> writingMessages_;                              ///< The messages of the write in flight
+            std::vector<asio::const_buffer> writeBuffers_;                                          ///< The gathered buffers of the write in flight
+            bool writing_ = false;                                                                  ///< Whether a write is in flight
+            size_t maxWriteBytes_ = 64 * 1024;                                                      ///< Byte cap of a coalesced write
+            size_t maxWriteBuffers_ = 64;                                                           ///< Buffer cap of a coalesced write
+            IncomingQueue<owned_message<MessageType, TcpConnection<MessageType>>>& incomingTcpMessages_;  ///< The incoming message queue
             message<MessageType> tempIncomingMessage_;                                              ///< The temporary incoming message
+            std::vector<uint8_t> readBuffer_;                                                       ///< The receive buffer, holds partial frames between reads
+            size_t readStart_ = 0;                                                                  ///< Offset of the first unparsed byte in the receive buffer
+            size_t readEnd_ = 0;                                                                    ///< Offset past the last received byte in the receive buffer
+            bool readPaused_ = false;                                                               ///< Reading stopped until the incoming queue drains
 
             uint64_t handshakeOut_ = 0;    ///< The outgoing handshake
             uint64_t handshakeIn_ = 0;     ///< The incoming handshake
             uint64_t handshakeCheck_ = 0;  ///< The handshake check
+            uint64_t handshakeTimer_ = 0;  ///< The handshake timeout, in the server timer wheel
             uint32_t id_ = 0;              ///< The connection id
+
+            TimerWheel* heartbeatTimers_ = nullptr;           ///< Runs the pings, nullptr when heartbeats are off
+            MessageType heartbeatId_{};                       ///< Message id of the heartbeats
+            std::chrono::milliseconds heartbeatInterval_{0};  ///< Time between two pings
+            uint32_t heartbeatMaxMissed_ = 0;                 ///< Unanswered pings before closing
+            uint32_t missedBeats_ = 0;                        ///< Pings sent since the last pong
+            uint64_t heartbeatTimer_ = 0;                     ///< The next ping, in heartbeatTimers_
+            bool heartbeatStopped_ = false;                   ///< Set by Disconnect, no ping is scheduled anymore
+            RttEstimator rtt_;                                ///< Fed by the pongs, on the connection executor
+            std::atomic<int64_t> rttUs_ = 0;                  ///< rtt_ RTT, readable from any thread
+            std::atomic<int64_t> jitterUs_ = 0;               ///< rtt_ jitter, readable from any thread
+
+            // Written on the connection executor only, relaxed so they can be read from anywhere
+            TcpCounters* counters_ = nullptr;                       ///< Server-wide counters, nullptr on a client
+            std::atomic<uint64_t> bytesSent_ = 0;                   ///< Bytes written
+            std::atomic<uint64_t> bytesReceived_ = 0;               ///< Bytes read
+            std::atomic<uint64_t> messagesSent_ = 0;                ///< Messages written
+            std::atomic<uint64_t> messagesReceived_ = 0;            ///< Messages read, heartbeats included
+            std::atomic<size_t> outgoingDepth_ = 0;                 ///< queuedMessages_, readable from any thread
+            std::chrono::steady_clock::time_point readAt_;          ///< Completion time of the last read
+            std::chrono::steady_clock::time_point writeStartedAt_;  ///< Start time of the write in flight
+
+            BackpressureConfig<MessageType> backpressure_{0, 0, BackpressurePolicy::Disconnect, {}};  ///< Limits of lanes_, none on a client
+            std::function<void(const BackpressureEvent&)> onBackpressure_;                            ///< Told when the policy is applied
+            size_t queuedBytes_ = 0;                                                                  ///< Bytes of lanes_
+            FlatMap<MessageType, uint64_t> lastQueued_;                                               ///< Lane push number of the latest message of each conflated id
         };
     }  // namespace net
 }  // namespace RType
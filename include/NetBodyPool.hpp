@@ -0,0 +1,278 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "NetCommon.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Size-class pool recycling message body buffers
+         *
+         * Blocks are rounded up to a power of two between MinBlockSize and MaxBlockSize.
+         * Each thread keeps a small cache per size class, overflowing to and refilling
+         * from a global depot in batches. A body allocated on the io thread and freed
+         * after OnMessage on the game thread therefore ends up back on the io thread
+         * without going through malloc. Bigger blocks are not pooled.
+         *
+         * The depot keeps at most DepotSize bytes of spare blocks per size class, the
+         * blocks given back past that go to operator delete, so a traffic peak does not
+         * pin its memory for good. A thread cache holds at most CacheSize blocks per class.
+         */
+        class BodyPool {
+           public:
+            static constexpr size_t MinBlockSize = 64;            ///< Smallest pooled block
+            static constexpr size_t MaxBlockSize = 64 * 1024;     ///< Largest pooled block
+            static constexpr size_t ClassCount = 11;              ///< Number of size classes, 64 B to 64 KiB
+            static constexpr size_t CacheSize = 64;               ///< Blocks kept per size class in a thread cache
+            static constexpr size_t TransferSize = 32;            ///< Blocks moved at once between a thread cache and the depot
+            static constexpr size_t DepotSize = 4 * 1024 * 1024;  ///< Bytes of spare blocks the depot keeps per size class
+
+            /**
+             * @brief Allocation counters, all values are totals since start
+             */
+            struct Stats {
+                uint64_t allocations = 0;        ///< Blocks handed out
+                uint64_t deallocations = 0;      ///< Blocks given back
+                uint64_t systemAllocations = 0;  ///< Blocks that had to come from operator new
+                uint64_t systemFrees = 0;        ///< Blocks released with operator delete
+            };
+
+            /**
+             * @brief Allocate a block of at least size bytes
+             *
+             * @param size The requested size
+             * @return void* The block
+             */
+            static void* Allocate(size_t size) {
+                ThreadCache& thread = GetThreadCache();
+                Bump(thread.allocations);
+
+                size_t cls = SizeClass(size);
+                if (cls == ClassCount) {
+                    Bump(thread.systemAllocations);
+                    return ::operator new(size);
+                }
+
+                auto& cache = thread.classes[cls];
+                if (cache.count == 0) {
+                    cache.count = GetDepot().Take(cls, cache.blocks.data(), TransferSize);
+                }
+                if (cache.count == 0) {
+                    Bump(thread.systemAllocations);
+                    return ::operator new(BlockSize(cls));
+                }
+                return cache.blocks[--cache.count];
+            }
+
+            /**
+             * @brief Give back a block obtained with Allocate
+             *
+             * @param block The block
+             * @param size The size that was requested for it
+             */
+            static void Deallocate(void* block, size_t size) {
+                ThreadCache& thread = GetThreadCache();
+                Bump(thread.deallocations);
+
+                size_t cls = SizeClass(size);
+                if (cls == ClassCount) {
+                    Bump(thread.systemFrees);
+                    ::operator delete(block);
+                    return;
+                }
+
+                auto& cache = thread.classes[cls];
+                if (cache.count == CacheSize) {
+                    cache.count -= TransferSize;
+                    size_t freed = GetDepot().Give(cls, cache.blocks.data() + cache.count, TransferSize);
+                    thread.systemFrees.store(thread.systemFrees.load(std::memory_order_relaxed) + freed, std::memory_order_relaxed);
+                }
+                cache.blocks[cache.count++] = block;
+            }
+
+            /**
+             * @brief Get a snapshot of the allocation counters
+             *
+             * Dividing systemAllocations by the number of messages handled gives the
+             * number of mallocs per message, which should reach zero in steady state.
+             * Sums the counters of every thread, so don't call it on a hot path.
+             *
+             * @return Stats
+             */
+            static Stats GetStats() { return GetRegistry().Sum(); }
+
+            /**
+             * @brief Get the size class of a request, ClassCount if it is not pooled
+             *
+             * @param size The requested size
+             * @return size_t The index of the smallest class whose blocks hold size bytes
+             */
+            static constexpr size_t SizeClass(size_t size) {
+                size_t cls = 0;
+                for (size_t block = MinBlockSize; block < size; block <<= 1) {
+                    if (++cls == ClassCount)
+                        break;
+                }
+                return cls;
+            }
+
+            /**
+             * @brief Get the size of the blocks of a size class
+             */
+            static constexpr size_t BlockSize(size_t cls) { return MinBlockSize << cls; }
+
+           private:
+            /// Global store of spare blocks shared by every thread
+            class Depot {
+               public:
+                size_t Take(size_t cls, void** out, size_t max) {
+                    std::scoped_lock lock(mutex_);
+                    auto& blocks = classes_[cls];
+                    size_t n = std::min(max, blocks.size());
+                    std::copy(blocks.end() - n, blocks.end(), out);
+                    blocks.resize(blocks.size() - n);
+                    return n;
+                }
+
+                /// Keeps the blocks up to DepotSize bytes and deletes the rest, returns the number deleted
+                size_t Give(size_t cls, void* const* in, size_t n) {
+                    size_t kept;
+                    {
+                        std::scoped_lock lock(mutex_);
+                        auto& blocks = classes_[cls];
+                        size_t limit = std::max<size_t>(DepotSize / BlockSize(cls), TransferSize);
+                        kept = std::min(n, limit - std::min(limit, blocks.size()));
+                        blocks.insert(blocks.end(), in, in + kept);
+                    }
+                    for (size_t i = kept; i < n; i++)
+                        ::operator delete(in[i]);
+                    return n - kept;
+                }
+
+               private:
+                std::mutex mutex_;
+                std::array<std::vector<void*>, ClassCount> classes_;
+            };
+
+            /// Per thread cache and counters, hands its blocks back to the depot when the thread exits
+            struct ThreadCache {
+                struct SizeClassCache {
+                    std::array<void*, CacheSize> blocks{};
+                    size_t count = 0;
+                };
+                std::array<SizeClassCache, ClassCount> classes;
+
+                // Only written by their thread, atomic so that GetStats can read them
+                std::atomic<uint64_t> allocations{0};
+                std::atomic<uint64_t> deallocations{0};
+                std::atomic<uint64_t> systemAllocations{0};
+                std::atomic<uint64_t> systemFrees{0};
+
+                ThreadCache() { GetRegistry().Add(this); }
+
+                ~ThreadCache() {
+                    size_t freed = 0;
+                    for (size_t cls = 0; cls < ClassCount; cls++) {
+                        if (classes[cls].count > 0)
+                            freed += GetDepot().Give(cls, classes[cls].blocks.data(), classes[cls].count);
+                    }
+                    systemFrees.store(systemFrees.load(std::memory_order_relaxed) + freed, std::memory_order_relaxed);
+                    GetRegistry().Remove(this);
+                }
+            };
+
+            /// Every live thread cache, and the counters of the threads that exited
+            class Registry {
+               public:
+                void Add(ThreadCache* cache) {
+                    std::scoped_lock lock(mutex_);
+                    caches_.push_back(cache);
+                }
+
+                void Remove(ThreadCache* cache) {
+                    std::scoped_lock lock(mutex_);
+                    caches_.erase(std::find(caches_.begin(), caches_.end(), cache));
+                    Accumulate(retired_, *cache);
+                }
+
+                Stats Sum() {
+                    std::scoped_lock lock(mutex_);
+                    Stats stats = retired_;
+                    for (const ThreadCache* cache : caches_)
+                        Accumulate(stats, *cache);
+                    return stats;
+                }
+
+               private:
+                static void Accumulate(Stats& stats, const ThreadCache& cache) {
+                    stats.allocations += cache.allocations.load(std::memory_order_relaxed);
+                    stats.deallocations += cache.deallocations.load(std::memory_order_relaxed);
+                    stats.systemAllocations += cache.systemAllocations.load(std::memory_order_relaxed);
+                    stats.systemFrees += cache.systemFrees.load(std::memory_order_relaxed);
+                }
+
+                std::mutex mutex_;
+                std::vector<ThreadCache*> caches_;
+                Stats retired_;
+            };
+
+            /// Counted by the owning thread only, a plain load and store instead of a locked add
+            static void Bump(std::atomic<uint64_t>& counter) {
+                counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            // The depot and registry are never destroyed so that threads exiting after
+            // static destruction can still return their blocks.
+            static Depot& GetDepot() {
+                static Depot* depot = new Depot();
+                return *depot;
+            }
+
+            static Registry& GetRegistry() {
+                static Registry* registry = new Registry();
+                return *registry;
+            }
+
+            static ThreadCache& GetThreadCache() {
+                thread_local ThreadCache cache;
+                return cache;
+            }
+        };
+
+        /**
+         * @brief Standard allocator backed by the BodyPool, used by default for message bodies
+         *
+         * @tparam T Value type
+         */
+        template <typename T>
+        struct PoolAllocator {
+            using value_type = T;
+
+            PoolAllocator() noexcept = default;
+            template <typename U>
+            PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+            T* allocate(size_t n) { return static_cast<T*>(BodyPool::Allocate(n * sizeof(T))); }
+            void deallocate(T* p, size_t n) noexcept { BodyPool::Deallocate(p, n * sizeof(T)); }
+
+            template <typename U>
+            bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+            template <typename U>
+            bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+        };
+    }  // namespace net
+}  // namespace RType
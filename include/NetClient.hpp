@@ -12,6 +12,7 @@
 #pragma once
 #include "NetCommon.hpp"
 #include "NetMessage.hpp"
+#include "NetMpscQueue.hpp"
 #include "NetTcpConnection.hpp"
 #include "NetTsqueue.hpp"
 
@@ -49,6 +50,8 @@ namespace RType {
                     asio::ip::tcp::resolver::results_type endpoints = resolver.resolve(host, std::to_string(port));
 
                     currentTcpConnection_ = std::make_unique<TcpConnection<MessageType>>(owner::client, context_, asio::ip::tcp::socket(context_), incomingTcpMessages_);
+                    if (heartbeatId_)
+                        currentTcpConnection_->SetHeartbeat(timers_, *heartbeatId_, heartbeatInterval_, heartbeatMaxMissed_);
 
                     currentTcpConnection_->ConnectToServer(endpoints);
 
@@ -64,14 +67,17 @@ namespace RType {
                 @brief Disconnect from the server
             */
             void Disconnect() {
-                if (this->IsConnected()) {
+                // The io thread may be closing the socket, leave the check to the posted close
+                if (currentTcpConnection_) {
                     currentTcpConnection_->Disconnect();
                 }
 
-                context_.stop();
+                // Queued after the close posted by Disconnect, so the socket is closed before the context stops
+                asio::post(context_, [this]() { context_.stop(); });
                 if (contextThread_.joinable()) {
                     contextThread_.join();
                 }
+                context_.stop();
 
                 currentTcpConnection_.release();
             }
@@ -96,25 +102,87 @@ namespace RType {
                     currentTcpConnection_->Send(msg);
             }
 
+            /**
+                @brief Send a shared message to the server
+                @param msg The message to send
+            */
+            void Send(shared_message<MessageType> msg) {
+                if (this->IsConnected())
+                    currentTcpConnection_->Send(std::move(msg));
+            }
+
+            /**
+                @brief Answer the heartbeats of the server, must be called before ConnectToServer
+                @param pingId The message id of the heartbeats, the same as the server one
+                @param interval Time between two pings of our own, 0 to only answer the server
+                @param maxMissed Unanswered pings before the connection is closed
+            */
+            void EnableHeartbeat(MessageType pingId, std::chrono::milliseconds interval = std::chrono::milliseconds(0), uint32_t maxMissed = 5) {
+                heartbeatId_ = pingId;
+                heartbeatInterval_ = interval;
+                heartbeatMaxMissed_ = maxMissed;
+            }
+
+            /**
+                @brief Round trip time to the server, measured when the client sends its own pings
+                @return The smoothed RTT, 0 before the first pong
+            */
+            std::chrono::microseconds GetRtt() {
+                return currentTcpConnection_ ? currentTcpConnection_->GetRtt() : std::chrono::microseconds(0);
+            }
+
+            /**
+                @brief Process the messages received from the server as a single batch
+                @param maxMessages The maximum number of messages to process
+                @param wait Whether to wait for a message
+                @return The number of messages processed
+            */
+            size_t PollBatch(size_t maxMessages = -1, bool wait = false) {
+                if (wait) incomingTcpMessages_.wait();
+
+                incomingTcpMessages_.drain_into(batch_, maxMessages);
+
+                for (auto& msg : batch_) {
+                    OnMessage(msg.msg);
+                }
+                size_t count = batch_.size();
+                // Keeps the capacity for the next call
+                batch_.clear();
+                return count;
+            }
+
             /**
                 @brief Retrieve the queue of messages from the server
                 @return The queue of messages from the server
             */
-            TsQueue<owned_message<MessageType, TcpConnection<MessageType>>>& IncomingTcpMessages() {
+            IncomingQueue<owned_message<MessageType, TcpConnection<MessageType>>>& IncomingTcpMessages() {
                 return incomingTcpMessages_;
             }
 
            protected:
+            /**
+                @brief Called by PollBatch for each message received from the server
+                @param msg The message that was received
+            */
+            virtual void OnMessage(message<MessageType>& /* msg */) {}
+
             std::string host_;  ///< The hostname/ip-address of the server
             uint16_t port_;     ///< The port to connect with
 
             asio::io_context context_;                                          ///< The asio context
+            TimerWheel timers_{context_};                                       ///< Timers run by context_
             std::thread contextThread_;                                         ///< The asio context thread
             std::unique_ptr<TcpConnection<MessageType>> currentTcpConnection_;  ///< The current tcp connection
 
+            std::optional<MessageType> heartbeatId_;          ///< Message id of the heartbeats, unset when they are off
+            std::chrono::milliseconds heartbeatInterval_{0};  ///< Time between two pings of our own
+            uint32_t heartbeatMaxMissed_ = 5;                 ///< Unanswered pings before closing
+
            private:
             // This is the thread safe queue of incoming messages from server
-            TsQueue<owned_message<MessageType, TcpConnection<MessageType>>> incomingTcpMessages_;
+            IncomingQueue<owned_message<MessageType, TcpConnection<MessageType>>> incomingTcpMessages_;
+            // The messages handled by the running PollBatch
+            std::vector<owned_message<MessageType, TcpConnection<MessageType>>> batch_;
         };
     }  // namespace net
 }  // namespace RType
@@ -32,6 +32,7 @@
 #elif __linux__
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -66,45 +67,6 @@ inline std::string getIp(void) {
 inline std::string getIp(void) { return ""; }
 #endif
 
-/**
- * @brief A class to add timers asynchronously
- *
- */
-class AsyncTimer : public Singleton<AsyncTimer> {
-   public:
-    /**
-     * @brief Construct a new AsyncTimer object
-     * @param id The id of the timer
-     * @param ms The timeout in milliseconds
-     * @param callback The callback to call when the timer is done
-     */
-    void addTimer(uint32_t id, uint32_t ms, std::function<void()> callback) {
-        callbacks_[id] = std::move(callback);
-        std::thread([this, id, ms]() {
-            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-            if (callbacks_.find(id) != callbacks_.end()) {
-                callbacks_[id]();
-                callbacks_.erase(id);
-            }
-        }).detach();
-    }
-
-    /**
-     * @brief Remove a timer
-     * @param id The id of the timer
-     */
-    void removeTimer(uint32_t id) {
-        if (callbacks_.find(id) != callbacks_.end())
-            callbacks_.erase(id);
-    }
-
-   private:
-    AsyncTimer() = default;
-    friend class Singleton<AsyncTimer>;
-
-    std::unordered_map<uint32_t, std::function<void()> > callbacks_;
-};
-
 namespace RType {
     namespace net {
         enum class owner {
@@ -0,0 +1,209 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include "NetCommon.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Open-addressing hash map with linear probing
+         *
+         * Slots live in one flat array whose size is a power of two, so a lookup is a
+         * hash, a mask and a few contiguous compares, without any allocation. Erasing
+         * shifts the following entries back instead of leaving tombstones. Pointers
+         * to values are invalidated by any insertion or erase.
+         *
+         * @tparam Key Key type, must be default constructible
+         * @tparam Value Value type, must be default constructible
+         * @tparam Hash Hash of the key, should mix all of its bits
+         * @tparam KeyEqual Key comparison
+         */
+        template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+        class FlatMap {
+           public:
+            /**
+             * @brief Construct a new Flat Map object
+             *
+             * @param count Number of entries it can hold before growing
+             */
+            explicit FlatMap(size_t count = 0) { reserve(count); }
+
+            /**
+             * @brief Find the value of key
+             *
+             * @return Value* The value, nullptr if key is not in the map
+             */
+            Value* find(const Key& key) {
+                if (size_ == 0)
+                    return nullptr;
+                for (size_t i = hash_(key) & mask_;; i = (i + 1) & mask_) {
+                    if (!used_[i])
+                        return nullptr;
+                    if (equal_(slots_[i].key, key))
+                        return &slots_[i].value;
+                }
+            }
+
+            const Value* find(const Key& key) const { return const_cast<FlatMap*>(this)->find(key); }
+
+            /**
+             * @brief Insert a default constructed value for key if it is not in the map yet
+             *
+             * @return std::pair<Value*, bool> The value, and whether it was inserted
+             */
+            std::pair<Value*, bool> try_emplace(const Key& key) {
+                if ((size_ + 1) * 4 > slots_.size() * 3)
+                    rehash(std::max<size_t>(slots_.size() * 2, MinCapacity));
+
+                size_t i = hash_(key) & mask_;
+                for (; used_[i]; i = (i + 1) & mask_) {
+                    if (equal_(slots_[i].key, key))
+                        return {&slots_[i].value, false};
+                }
+                used_[i] = true;
+                slots_[i].key = key;
+                slots_[i].value = Value();
+                size_++;
+                return {&slots_[i].value, true};
+            }
+
+            /**
+             * @brief Remove key from the map
+             *
+             * @return true if it was in the map
+             */
+            bool erase(const Key& key) {
+                if (size_ == 0)
+                    return false;
+                for (size_t i = hash_(key) & mask_;; i = (i + 1) & mask_) {
+                    if (!used_[i])
+                        return false;
+                    if (equal_(slots_[i].key, key)) {
+                        eraseSlot(i);
+                        return true;
+                    }
+                }
+            }
+
+            /**
+             * @brief Remove every entry for which pred(key, value) returns true
+             *
+             * pred may see an entry twice, but never one it already removed.
+             *
+             * @return size_t Number of removed entries
+             */
+            template <typename Predicate>
+            size_t erase_if(Predicate&& pred) {
+                size_t erased = 0;
+                for (size_t i = 0; i < slots_.size();) {
+                    if (used_[i] && pred(slots_[i].key, slots_[i].value)) {
+                        // The backward shift may move another entry into i, check it again
+                        eraseSlot(i);
+                        erased++;
+                    } else {
+                        i++;
+                    }
+                }
+                return erased;
+            }
+
+            /**
+             * @brief Call fn(key, value) for every entry
+             */
+            template <typename Function>
+            void for_each(Function&& fn) {
+                for (size_t i = 0; i < slots_.size(); i++) {
+                    if (used_[i])
+                        fn(static_cast<const Key&>(slots_[i].key), slots_[i].value);
+                }
+            }
+
+            /**
+             * @brief Make room for count entries without growing
+             */
+            void reserve(size_t count) {
+                size_t capacity = MinCapacity;
+                while (capacity * 3 < count * 4)
+                    capacity *= 2;
+                if (capacity > slots_.size())
+                    rehash(capacity);
+            }
+
+            /**
+             * @brief Remove every entry, the capacity is kept
+             */
+            void clear() {
+                std::fill(used_.begin(), used_.end(), 0);
+                for (auto& slot : slots_)
+                    slot = Slot();
+                size_ = 0;
+            }
+
+            [[nodiscard]] size_t size() const noexcept { return size_; }
+            [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+            [[nodiscard]] size_t capacity() const noexcept { return slots_.size(); }
+
+           private:
+            struct Slot {
+                Key key;
+                Value value;
+            };
+
+            static constexpr size_t MinCapacity = 16;
+
+            void eraseSlot(size_t hole) {
+                used_[hole] = false;
+                slots_[hole] = Slot();
+                size_--;
+
+                // Move back the following entries that would no longer be reachable
+                for (size_t i = (hole + 1) & mask_; used_[i]; i = (i + 1) & mask_) {
+                    size_t home = hash_(slots_[i].key) & mask_;
+                    if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+                        slots_[hole] = std::move(slots_[i]);
+                        used_[hole] = true;
+                        slots_[i] = Slot();
+                        used_[i] = false;
+                        hole = i;
+                    }
+                }
+            }
+
+            void rehash(size_t capacity) {
+                std::vector<Slot> oldSlots(capacity);
+                std::vector<uint8_t> oldUsed(capacity, 0);
+                oldSlots.swap(slots_);
+                oldUsed.swap(used_);
+                mask_ = capacity - 1;
+
+                for (size_t j = 0; j < oldSlots.size(); j++) {
+                    if (!oldUsed[j])
+                        continue;
+                    size_t i = hash_(oldSlots[j].key) & mask_;
+                    while (used_[i])
+                        i = (i + 1) & mask_;
+                    slots_[i] = std::move(oldSlots[j]);
+                    used_[i] = true;
+                }
+            }
+
+            std::vector<Slot> slots_;    ///< Entries, capacity is a power of two
+            std::vector<uint8_t> used_;  ///< Whether each slot holds an entry
+            size_t size_ = 0;            ///< Number of entries
+            size_t mask_ = 0;            ///< capacity - 1
+            Hash hash_;                  ///< Key hash
+            KeyEqual equal_;             ///< Key comparison
+        };
+    }  // namespace net
+}  // namespace RType
@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include "NetCommon.hpp"
+#include "NetWire.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Timestamped ping or pong exchanged by the heartbeats
+         *
+         * A ping carries the sender clock, the pong echoes it unchanged, so the RTT is
+         * measured on the sender clock only. On the wire it is a 4 bytes magic, the kind
+         * and the timestamp, little-endian.
+         */
+        struct Heartbeat {
+            enum class Kind : uint8_t {
+                Ping,
+                Pong
+            };
+
+            static constexpr uint32_t Magic = 0x42485452;  ///< "RTHB"
+            static constexpr size_t Size = 13;             ///< Encoded size in bytes
+
+            Kind kind = Kind::Ping;  ///< Ping or pong
+            uint64_t timestamp = 0;  ///< Sender steady clock, in nanoseconds
+
+            /**
+             * @brief A ping stamped with the current time
+             */
+            static Heartbeat MakePing() {
+                auto now = std::chrono::steady_clock::now().time_since_epoch();
+                return {Kind::Ping, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count())};
+            }
+
+            /**
+             * @brief Time elapsed since the ping was stamped
+             */
+            [[nodiscard]] std::chrono::steady_clock::duration Age() const {
+                auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+                return std::max(std::chrono::nanoseconds(now.count() - int64_t(timestamp)), std::chrono::nanoseconds(0));
+            }
+
+            /**
+             * @brief Encode into out, which must hold at least Size bytes
+             */
+            void Encode(uint8_t* out) const {
+                WireCodec<uint32_t>::encode(out, Magic);
+                WireCodec<Kind>::encode(out + 4, kind);
+                WireCodec<uint64_t>::encode(out + 5, timestamp);
+            }
+
+            /**
+             * @brief Decode buffer if it holds a heartbeat
+             *
+             * @return true if buffer is a heartbeat
+             */
+            static bool Decode(const void* buffer, size_t size, Heartbeat& out) {
+                if (size != Size)
+                    return false;
+                auto in = static_cast<const uint8_t*>(buffer);
+                uint32_t magic;
+                WireCodec<uint32_t>::decode(in, magic);
+                WireCodec<Kind>::decode(in + 4, out.kind);
+                if (magic != Magic || (out.kind != Kind::Ping && out.kind != Kind::Pong))
+                    return false;
+                WireCodec<uint64_t>::decode(in + 5, out.timestamp);
+                return true;
+            }
+        };
+
+        /**
+         * @brief Smoothed RTT and jitter, as in RFC 6298
+         */
+        class RttEstimator {
+           public:
+            /**
+             * @brief Add a RTT sample
+             */
+            void Sample(std::chrono::steady_clock::duration sample) {
+                std::chrono::duration<double> value = sample;
+                if (!hasSample_) {
+                    hasSample_ = true;
+                    srtt_ = value;
+                    rttvar_ = value / 2;
+                } else {
+                    auto delta = srtt_ > value ? srtt_ - value : value - srtt_;
+                    rttvar_ = rttvar_ * 0.75 + delta * 0.25;
+                    srtt_ = srtt_ * 0.875 + value * 0.125;
+                }
+            }
+
+            [[nodiscard]] bool HasSample() const noexcept { return hasSample_; }
+
+            /**
+             * @brief Smoothed RTT, 0 before the first sample
+             */
+            [[nodiscard]] std::chrono::microseconds GetRtt() const { return std::chrono::duration_cast<std::chrono::microseconds>(srtt_); }
+
+            /**
+             * @brief Mean deviation of the RTT, 0 before the first sample
+             */
+            [[nodiscard]] std::chrono::microseconds GetJitter() const { return std::chrono::duration_cast<std::chrono::microseconds>(rttvar_); }
+
+           private:
+            bool hasSample_ = false;                   ///< Whether srtt_ holds a sample
+            std::chrono::duration<double> srtt_{0};    ///< Smoothed RTT
+            std::chrono::duration<double> rttvar_{0};  ///< RTT variation
+        };
+    }  // namespace net
+}  // namespace RType
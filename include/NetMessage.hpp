@@ -11,7 +11,12 @@
 
 #pragma once
 
+#include <cassert>
+
+#include "NetBodyPool.hpp"
 #include "NetCommon.hpp"
+#include "NetSmallVector.hpp"
+#include "NetWire.hpp"
 
 namespace RType {
 
@@ -29,18 +34,23 @@ namespace RType {
             uint32_t size = 0; ///< Size of the message
         };
 
+        /// Number of body bytes a message stores inline before allocating
+        constexpr size_t MessageInlineSize = 128;
+
         /**
             @struct message
-            @brief Message Body contains a header and a std::vector, containing raw bytes
+            @brief Message Body contains a header and a vector-like buffer, containing raw bytes
             of information. This way the message can be variable length, but the size
-            in the header must be updated.
+            in the header must be updated. Bodies up to MessageInlineSize bytes are stored
+            inline and never touch the allocator.
 
             @tparam T Message type
+            @tparam Allocator Allocator of bodies bigger than MessageInlineSize, recycled through the BodyPool by default
         */
-        template <typename T>
+        template <typename T, typename Allocator = PoolAllocator<uint8_t>>
         struct message {
             message_header<T> header{}; ///< Header
-            std::vector<uint8_t> body; ///< Body of the message
+            SmallVector<uint8_t, MessageInlineSize, Allocator> body; ///< Body of the message
 
             /**
                 @brief Returns size of entire message packet in bytes
@@ -52,7 +62,7 @@ namespace RType {
             /**
                 @brief Returns a friendly description of the message
             */
-            friend std::ostream& operator<<(std::ostream& os, const message<T>& msg) {
+            friend std::ostream& operator<<(std::ostream& os, const message<T, Allocator>& msg) {
                 os << "ID:" << int(msg.header.id) << " Size:" << msg.header.size;
                 return os;
             }
@@ -64,10 +74,10 @@ namespace RType {
 
                 @param data POD-like data to push into buffer
 
-                @return message<T>&
+                @return message<T, Allocator>&
             */
             template <typename DataType>
-            friend message<T>& operator<<(message<T>& msg, const DataType& data) {
+            friend message<T, Allocator>& operator<<(message<T, Allocator>& msg, const DataType& data) {
                 static_assert(std::is_standard_layout<DataType>::value, "Data is too complex to be pushed into vector");
 
                 size_t i = msg.body.size();
@@ -86,10 +96,10 @@ namespace RType {
 
                 @param data POD-like data to pull from buffer
 
-                @return message<T>&
+                @return message<T, Allocator>&
             */
             template <typename DataType>
-            friend message<T>& operator>>(message<T>& msg, DataType& data) {
+            friend message<T, Allocator>& operator>>(message<T, Allocator>& msg, DataType& data) {
                 static_assert(std::is_standard_layout<DataType>::value, "Data is too complex to be pulled from vector");
 
                 size_t i = msg.body.size() - sizeof(DataType);
@@ -102,6 +112,213 @@ namespace RType {
             }
         };
 
+        /**
+            @brief Total size in bytes of a list of POD-like types, known at compile time
+
+            @tparam DataTypes POD-like data types
+        */
+        template <typename... DataTypes>
+        constexpr size_t payload_size_v = (sizeof(DataTypes) + ... + 0);
+
+        /**
+            @class MessageWriter
+            @brief Appends POD-like data to a message in push order. Each write grows the
+            body once by the compile-time size of all its arguments, then copies them in.
+
+            @tparam T Message type
+            @tparam Allocator Allocator of the message body
+        */
+        template <typename T, typename Allocator = PoolAllocator<uint8_t>>
+        class MessageWriter {
+           public:
+            /**
+                @brief Construct a writer appending to msg
+
+                @param msg The message to write to
+            */
+            explicit MessageWriter(message<T, Allocator>& msg) : msg_(msg) {}
+
+            /**
+                @brief Reserves room for the given types in a single allocation
+
+                @tparam DataTypes POD-like data types that will be written
+            */
+            template <typename... DataTypes>
+            MessageWriter& reserve() {
+                msg_.body.reserve(msg_.body.size() + payload_size_v<DataTypes...>);
+                return *this;
+            }
+
+            /**
+                @brief Appends every argument in order
+
+                @param data POD-like data to push into buffer
+
+                @return MessageWriter&
+            */
+            template <typename... DataTypes>
+            MessageWriter& write(const DataTypes&... data) {
+                static_assert((std::is_standard_layout<DataTypes>::value && ...), "Data is too complex to be pushed into vector");
+
+                size_t offset = msg_.body.size();
+                msg_.body.resize(offset + payload_size_v<DataTypes...>);
+
+                uint8_t* out = msg_.body.data() + offset;
+                ((std::memcpy(out, &data, sizeof(DataTypes)), out += sizeof(DataTypes)), ...);
+                msg_.header.size = msg_.size();
+
+                return *this;
+            }
+
+            /**
+                @brief Appends a payload in its packed wire layout, see Wire
+
+                @param payload The payload to encode
+
+                @return MessageWriter&
+            */
+            template <typename Payload>
+            MessageWriter& pack(const Payload& payload) {
+                size_t offset = msg_.body.size();
+                msg_.body.resize(offset + Wire<Payload>::size);
+
+                Wire<Payload>::encode(msg_.body.data() + offset, payload);
+                msg_.header.size = msg_.size();
+
+                return *this;
+            }
+
+            /**
+                @brief Appends data
+
+                @param data POD-like data to push into buffer
+
+                @return MessageWriter&
+            */
+            template <typename DataType>
+            MessageWriter& operator<<(const DataType& data) {
+                return write(data);
+            }
+
+           private:
+            message<T, Allocator>& msg_;
+        };
+
+        /**
+            @class MessageReader
+            @brief Reads POD-like data from a message in push order with a forward cursor.
+            The message is never modified, so it can be read again or forwarded.
+
+            @tparam T Message type
+            @tparam Allocator Allocator of the message body
+        */
+        template <typename T, typename Allocator = PoolAllocator<uint8_t>>
+        class MessageReader {
+           public:
+            /**
+                @brief Construct a reader starting at the beginning of msg
+
+                @param msg The message to read from
+            */
+            explicit MessageReader(const message<T, Allocator>& msg) : msg_(msg) {}
+
+            /**
+                @brief Reads every argument in order
+
+                @param data POD-like data to pull from buffer
+
+                @return true if the message held enough bytes, false otherwise (nothing is read)
+            */
+            template <typename... DataTypes>
+            bool read(DataTypes&... data) {
+                static_assert((std::is_standard_layout<DataTypes>::value && ...), "Data is too complex to be pulled from vector");
+
+                if (remaining() < payload_size_v<DataTypes...>)
+                    return false;
+
+                const uint8_t* in = msg_.body.data() + cursor_;
+                ((std::memcpy(&data, in, sizeof(DataTypes)), in += sizeof(DataTypes)), ...);
+                cursor_ += payload_size_v<DataTypes...>;
+
+                return true;
+            }
+
+            /**
+                @brief Reads a payload encoded with MessageWriter::pack
+
+                @param payload The payload to decode into
+
+                @return true if the message held enough bytes, false otherwise (nothing is read)
+            */
+            template <typename Payload>
+            bool unpack(Payload& payload) {
+                if (remaining() < Wire<Payload>::size)
+                    return false;
+
+                Wire<Payload>::decode(msg_.body.data() + cursor_, payload);
+                cursor_ += Wire<Payload>::size;
+
+                return true;
+            }
+
+            /**
+                @brief Reads data, the message must hold enough bytes
+
+                A short message fails an assert. Under NDEBUG it is not checked: data is
+                left unwritten and the reader does not move, so use read() or unpack() when
+                the message comes from the network and its size is not known to be right.
+
+                @param data POD-like data to pull from buffer
+
+                @return MessageReader&
+            */
+            template <typename DataType>
+            MessageReader& operator>>(DataType& data) {
+                [[maybe_unused]] bool ok = read(data);
+                assert(ok && "Not enough data left in the message!");
+                return *this;
+            }
+
+            /**
+                @brief Returns the number of bytes left to read
+            */
+            [[nodiscard]] size_t remaining() const { return msg_.body.size() - cursor_; }
+
+            /**
+                @brief Returns the offset of the next byte to read
+            */
+            [[nodiscard]] size_t offset() const { return cursor_; }
+
+           private:
+            const message<T, Allocator>& msg_;
+            size_t cursor_ = 0;
+        };
+
+        /**
+            @brief Immutable, reference counted message. It is built once and the same
+            buffer is queued to every connection it is sent to, which avoids copying the
+            body per recipient when broadcasting.
+
+            @tparam T Message type
+        */
+        template <typename T>
+        using shared_message = std::shared_ptr<const message<T>>;
+
+        /**
+            @brief Freezes a message into a shared_message
+
+            @tparam T Message type
+
+            @param msg The message to freeze, pass an rvalue to avoid copying its body
+
+            @return shared_message<T>
+        */
+        template <typename T>
+        shared_message<T> make_shared_message(message<T> msg) {
+            msg.header.size = msg.size();
+            return std::make_shared<const message<T>>(std::move(msg));
+        }
+
         /**
             @struct owned_message
             @brief An "owned" message is identical to a regular message, but it is associated with
@@ -114,6 +331,7 @@ namespace RType {
         struct owned_message {
             std::shared_ptr<ConnectionType> remote = nullptr; ///< Remote connection
             message<T> msg; ///< Actual message
+            std::chrono::steady_clock::time_point receivedAt{}; ///< When the message was read off the socket, on a server and on a client
 
             friend std::ostream& operator<<(std::ostream& os, const owned_message<T, ConnectionType>& message) {
                 os << message.msg;
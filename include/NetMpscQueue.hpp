@@ -0,0 +1,412 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <new>
+#include <type_traits>
+
+#include "NetCommon.hpp"
+#include "NetTsqueue.hpp"
+
+namespace RType {
+
+    namespace net {
+        /// Size of a cache line, used to keep producer and consumer state apart
+        constexpr size_t CacheLineSize = 64;
+
+        /**
+         * @brief Bounded lock-free multi-producer / single-consumer queue
+         *
+         * Any thread may push, only one thread may pop. Each slot carries a
+         * sequence number so producers claim slots with a single CAS and never
+         * block each other. The consumer only sleeps in wait(), and producers
+         * only touch the mutex when a consumer is actually sleeping.
+         *
+         * A producer that must not block, such as a network thread, uses try_push
+         * and asks notify_when_drained to call it back once the consumer emptied
+         * half of the Queue.
+         *
+         * The consumer side keeps the TsQueue interface: back, pop_back and
+         * push_front work on a private deque the ready items are moved to, so they
+         * cost nothing unless used.
+         *
+         * @tparam T Item type
+         * @tparam Capacity Number of slots, must be a power of two
+         */
+        template <typename T, size_t Capacity = 4096>
+        class MpscQueue {
+            static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+           public:
+            MpscQueue() : cells_(new Cell[Capacity]) {
+                for (size_t i = 0; i < Capacity; i++)
+                    cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            MpscQueue(const MpscQueue<T, Capacity>&) = delete;
+            virtual ~MpscQueue() { clear(); }
+
+           public:
+            /**
+             * @brief Tries to add an item to back of Queue
+             *
+             * @param item
+             * @return true if the item was queued, false if the Queue is full
+             */
+            template <typename U>
+            bool try_push(U&& item) {
+                return try_emplace(std::forward<U>(item));
+            }
+
+            /**
+             * @brief Tries to construct an item in place at back of Queue
+             *
+             * @param args Arguments forwarded to the constructor of T
+             * @return true if the item was queued, false if the Queue is full
+             */
+            template <typename... Args>
+            bool try_emplace(Args&&... args) {
+                Cell* cell;
+                size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+
+                for (;;) {
+                    cell = &cells_[pos & Mask];
+                    size_t seq = cell->sequence.load(std::memory_order_acquire);
+                    auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+                    if (diff == 0) {
+                        if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    } else if (diff < 0) {
+                        return false;
+                    } else {
+                        pos = enqueuePos_.load(std::memory_order_relaxed);
+                    }
+                }
+
+                new (&cell->storage) T(std::forward<Args>(args)...);
+                cell->sequence.store(pos + 1, std::memory_order_release);
+
+                notify();
+                return true;
+            }
+
+            /**
+             * @brief Adds an item to back of Queue, yielding while the Queue is full
+             *
+             * Blocks the calling thread while the Queue is full, network threads use
+             * try_push and notify_when_drained instead.
+             *
+             * @param item
+             */
+            void push_back(const T& item) {
+                while (!try_push(item))
+                    std::this_thread::yield();
+            }
+
+            /**
+             * @brief Moves an item to back of Queue, yielding while the Queue is full
+             *
+             * @param item
+             */
+            void push_back(T&& item) {
+                // try_emplace only moves from its arguments once a slot is claimed
+                while (!try_emplace(std::move(item)))
+                    std::this_thread::yield();
+            }
+
+            /**
+             * @brief Constructs an item in place at back of Queue, yielding while the Queue is full
+             *
+             * @param args Arguments forwarded to the constructor of T
+             */
+            template <typename... Args>
+            void emplace_back(Args&&... args) {
+                while (!try_emplace(std::forward<Args>(args)...))
+                    std::this_thread::yield();
+            }
+
+            /**
+             * @brief Calls callback once the Queue holds at most half its capacity
+             *
+             * Meant for a producer whose try_push failed. callback runs once, on the
+             * consumer thread or right away on the calling thread if the Queue already
+             * drained, so it should only schedule the work.
+             *
+             * @param callback Called once the Queue drained
+             */
+            void notify_when_drained(std::function<void()> callback) {
+                {
+                    std::scoped_lock lock(drainMutex_);
+                    drainWaiters_.push_back(std::move(callback));
+                    hasDrainWaiters_.store(true, std::memory_order_relaxed);
+                }
+                // Pairs with the fence in checkDrained(): either the consumer sees the
+                // waiter, or we see the slots it freed.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (ringCount() <= DrainedCount)
+                    resumeProducers();
+            }
+
+            /**
+             * @brief Tries to remove the front item of the Queue (consumer only)
+             *
+             * @param item Receives the item
+             * @return true if an item was removed, false if the Queue is empty
+             */
+            bool try_pop(T& item) {
+                if (empty())
+                    return false;
+                item = pop_front();
+                return true;
+            }
+
+            /**
+             * @brief Returns and maintains item at front of Queue (consumer only)
+             *
+             * @return const T&
+             */
+            const T& front() {
+                if (!spill_.empty())
+                    return spill_.front();
+                return *cells_[dequeuePos_.load(std::memory_order_relaxed) & Mask].item();
+            }
+
+            /**
+             * @brief Returns and maintains the latest ready item of Queue (consumer only)
+             *
+             * @return const T&
+             */
+            const T& back() {
+                spillRing();
+                return spill_.back();
+            }
+
+            /**
+             * @brief Removes and returns item from front of Queue (consumer only)
+             *
+             * @return T
+             */
+            T pop_front() {
+                if (!spill_.empty()) {
+                    T t = std::move(spill_.front());
+                    spill_.pop_front();
+                    return t;
+                }
+                T t = popRing();
+                checkDrained();
+                return t;
+            }
+
+            /**
+             * @brief Removes and returns the latest ready item of Queue (consumer only)
+             *
+             * @return T
+             */
+            T pop_back() {
+                spillRing();
+                T t = std::move(spill_.back());
+                spill_.pop_back();
+                return t;
+            }
+
+            /**
+             * @brief Adds an item to front of Queue, it is popped before anything else (consumer only)
+             *
+             * @param item
+             */
+            void push_front(const T& item) {
+                spill_.push_front(item);
+            }
+
+            /**
+             * @brief Moves an item to front of Queue, it is popped before anything else (consumer only)
+             *
+             * @param item
+             */
+            void push_front(T&& item) {
+                spill_.push_front(std::move(item));
+            }
+
+            /**
+             * @brief Returns true if the front item is not ready yet (consumer only)
+             *
+             * @return true
+             * @return false
+             */
+            bool empty() {
+                return spill_.empty() && ringEmpty();
+            }
+
+            /**
+             * @brief Returns approximate number of items in Queue (consumer only)
+             *
+             * @return size_t
+             */
+            size_t count() {
+                return ringCount() + spill_.size();
+            }
+
+            /**
+             * @brief Returns the maximum number of items the Queue can hold
+             *
+             * @return size_t
+             */
+            static constexpr size_t capacity() { return Capacity; }
+
+            /**
+             * @brief Moves up to max ready items from front of Queue into container (consumer only)
+             *
+             * @tparam Container Any container with push_back
+             * @param container The container receiving the items
+             * @param max The maximum number of items to move
+             * @return size_t The number of items moved
+             */
+            template <typename Container>
+            size_t drain_into(Container& container, size_t max = -1) {
+                size_t n = 0;
+                for (; n < max && !spill_.empty(); n++) {
+                    container.push_back(std::move(spill_.front()));
+                    spill_.pop_front();
+                }
+                for (; n < max && !ringEmpty(); n++)
+                    container.push_back(popRing());
+                checkDrained();
+                return n;
+            }
+
+            /**
+             * @brief Clears Queue (consumer only)
+             *
+             */
+            void clear() {
+                spill_.clear();
+                while (!ringEmpty())
+                    popRing();
+                checkDrained();
+            }
+
+            /**
+             * @brief Waits until Queue is not empty
+             */
+            void wait() {
+                while (empty()) {
+                    std::unique_lock<std::mutex> ul(blockingMutex_);
+                    waiters_.fetch_add(1, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (empty()) {
+                        blocking_.wait(ul);
+                    }
+                    waiters_.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+
+           private:
+            static constexpr size_t Mask = Capacity - 1;
+            static constexpr size_t DrainedCount = Capacity / 2;  ///< Fill level at which blocked producers resume
+
+            struct Cell {
+                std::atomic<size_t> sequence;
+                typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+                T* item() { return std::launder(reinterpret_cast<T*>(&storage)); }
+            };
+
+            bool ringEmpty() {
+                size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+                return cells_[pos & Mask].sequence.load(std::memory_order_acquire) != pos + 1;
+            }
+
+            void spillRing() {
+                while (!ringEmpty())
+                    spill_.push_back(popRing());
+                checkDrained();
+            }
+
+            T popRing() {
+                size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+                Cell& cell = cells_[pos & Mask];
+
+                T t = std::move(*cell.item());
+                cell.item()->~T();
+
+                cell.sequence.store(pos + Capacity, std::memory_order_release);
+                dequeuePos_.store(pos + 1, std::memory_order_release);
+                return t;
+            }
+
+            size_t ringCount() const {
+                size_t head = dequeuePos_.load(std::memory_order_acquire);
+                size_t tail = enqueuePos_.load(std::memory_order_acquire);
+                return tail > head ? tail - head : 0;
+            }
+
+            void checkDrained() {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (hasDrainWaiters_.load(std::memory_order_relaxed) && ringCount() <= DrainedCount)
+                    resumeProducers();
+            }
+
+            void resumeProducers() {
+                std::vector<std::function<void()>> waiters;
+                {
+                    std::scoped_lock lock(drainMutex_);
+                    waiters.swap(drainWaiters_);
+                    hasDrainWaiters_.store(false, std::memory_order_relaxed);
+                }
+                for (auto& waiter : waiters)
+                    waiter();
+            }
+
+            void notify() {
+                // Pairs with the fetch_add in wait(): either the consumer sees the
+                // new item, or we see the consumer registered as a waiter.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (waiters_.load(std::memory_order_relaxed) != 0) {
+                    std::unique_lock<std::mutex> ul(blockingMutex_);
+                    blocking_.notify_one();
+                }
+            }
+
+           protected:
+            alignas(CacheLineSize) std::atomic<size_t> enqueuePos_{0};  ///< Next slot claimed by producers
+            alignas(CacheLineSize) std::atomic<size_t> dequeuePos_{0};  ///< Next slot read by the consumer
+            alignas(CacheLineSize) std::atomic<uint32_t> waiters_{0};   ///< Number of sleeping consumers
+            std::condition_variable blocking_;                         ///< Blocking condition variable
+            std::mutex blockingMutex_;                                 ///< Mutex for the blocking condition variable
+            std::unique_ptr<Cell[]> cells_;                            ///< Ring storage
+
+            std::mutex drainMutex_;                                    ///< Protects drainWaiters_
+            std::vector<std::function<void()>> drainWaiters_;          ///< Producers waiting for room
+            std::atomic<bool> hasDrainWaiters_{false};                 ///< Whether drainWaiters_ is not empty
+
+            std::deque<T> spill_;  ///< Items taken out of the ring by back or pop_back, or added by push_front (consumer only)
+        };
+
+        /**
+         * @brief Queue type used for incoming messages
+         *
+         * Defaults to the lock-free MpscQueue, define RTYPE_NET_LOCKED_INCOMING_QUEUE
+         * to fall back to the mutex based TsQueue.
+         *
+         * @tparam T
+         */
+#ifdef RTYPE_NET_LOCKED_INCOMING_QUEUE
+        template <typename T>
+        using IncomingQueue = TsQueue<T>;
+#else
+        template <typename T>
+        using IncomingQueue = MpscQueue<T>;
+#endif
+    }  // namespace net
+}  // namespace RType
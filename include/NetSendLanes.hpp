@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Priority lane of an outgoing TCP message
+         *
+         * Each lane is a FIFO, messages of different lanes may be reordered.
+         */
+        enum class SendLane : uint8_t {
+            Control,  ///< Short, time critical messages, e.g. accept, deny, game start
+            Normal,   ///< Everything else
+            Bulk      ///< Large messages nobody waits on, e.g. lobby lists
+        };
+
+        constexpr size_t SendLaneCount = 3;  ///< Number of SendLane values
+
+        /// Bytes each lane may write per scheduling round, by default
+        constexpr std::array<size_t, SendLaneCount> DefaultLaneQuanta = {32 * 1024, 16 * 1024, 8 * 1024};
+
+        /**
+         * @brief Compile-time table giving the lane of each message id
+         *
+         * Every message goes to the Normal lane, so messages stay in send order unless
+         * this is specialized for MessageType:
+         *
+         * @code
+         * template <>
+         * struct SendLanes<MyMessages> {
+         *     static constexpr SendLane Of(MyMessages id) noexcept { return id == MyMessages::Kick ? SendLane::Control : SendLane::Normal; }
+         * };
+         * @endcode
+         *
+         * @tparam MessageType The enum class containing all the message types
+         */
+        template <typename MessageType>
+        struct SendLanes {
+            static constexpr SendLane Of(MessageType id) noexcept {
+                (void)id;
+                return SendLane::Normal;
+            }
+        };
+    }  // namespace net
+}  // namespace RType
@@ -13,6 +13,10 @@
 
 #include "NetCommon.hpp"
 #include "NetMessage.hpp"
+#include "NetMpscQueue.hpp"
+#include "NetSlotMap.hpp"
+#include "NetStats.hpp"
+#include "NetTimerWheel.hpp"
 #include "NetTcpConnection.hpp"
 #include "NetTsqueue.hpp"
 
@@ -34,11 +38,37 @@ namespace RType {
         template <typename MessageType>
         class ServerInterface {
            public:
+            using ClientMap = SlotMap<std::shared_ptr<TcpConnection<MessageType>>>;
+
+            /**
+             * @brief Locked, non-copying view of the connected clients
+             *
+             * The client list stays locked while the view lives, so keep it short and
+             * don't call back into the server from the loop.
+             */
+            class ClientsView {
+               public:
+                ClientsView(std::mutex& mutex, const ClientMap& clients) : lock_(mutex), clients_(clients) {}
+
+                typename ClientMap::const_iterator begin() const noexcept { return clients_.begin(); }
+                typename ClientMap::const_iterator end() const noexcept { return clients_.end(); }
+                [[nodiscard]] size_t size() const noexcept { return clients_.size(); }
+                [[nodiscard]] bool empty() const noexcept { return clients_.empty(); }
+
+               private:
+                std::unique_lock<std::mutex> lock_;  ///< Held while the view lives
+                const ClientMap& clients_;           ///< The server clients
+            };
+
             /**
                 @brief Construct the server interface
                 @param port The port to listen on
+                @param threadCount Number of threads running the asio context, each connection
+                stays serialized on its own strand whatever the number of threads
             */
-            explicit ServerInterface(uint16_t port) : asioAcceptor_(asioContext_, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port_)), port_(port) {
+            explicit ServerInterface(uint16_t port, size_t threadCount = 1) : asioAcceptor_(asioContext_, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port_)),
+                                                                                port_(port),
+                                                                                threadCount_(std::max<size_t>(threadCount, 1)) {
                 std::cout << "[SERVER] Listening on: " << getIp() << ":" << port_ << std::endl;
             }
 
@@ -47,6 +77,16 @@ namespace RType {
             */
             virtual ~ServerInterface() {
                 Stop();
+
+                // The clients hold sockets of asioContext_, release them before it is destroyed
+                {
+                    std::scoped_lock lock(connectionsMutex_);
+                    activeTcpConnections_.clear();
+                }
+                // So do the queued messages, and a paused client waits for the queue to drain
+                // with a work guard on asioContext_
+                batch_.clear();
+                incomingTcpMessages_.clear();
             }
 
             /**
@@ -56,7 +96,9 @@ namespace RType {
             bool Start() {
                 try {
                     WaitForClientConnection();
-                    threadContext_ = std::thread([this]() { asioContext_.run(); });
+                    for (size_t i = 0; i < threadCount_; i++) {
+                        threadPool_.emplace_back([this]() { asioContext_.run(); });
+                    }
                 } catch (std::exception& e) {
                     std::cerr << "[SERVER] Exception: " << e.what() << "\n";
                     return false;
@@ -72,7 +114,10 @@ namespace RType {
             void Stop() {
                 asioContext_.stop();
 
-                if (threadContext_.joinable()) threadContext_.join();
+                for (auto& thread : threadPool_) {
+                    if (thread.joinable()) thread.join();
+                }
+                threadPool_.clear();
 
                 std::cout << "[SERVER] Stopped!\n";
             }
@@ -84,7 +129,9 @@ namespace RType {
                 for each incoming connection attempt
             */
             void WaitForClientConnection() {
+                // Every accepted socket gets its own strand, its handlers never run concurrently
                 asioAcceptor_.async_accept(
+                    asio::make_strand(asioContext_),
                     [this](std::error_code ec, asio::ip::tcp::socket _socket) {
                         if (!ec) {
                             std::cout << "[SERVER] New Connection: " << _socket.remote_endpoint() << "\n";
@@ -93,12 +140,44 @@ namespace RType {
                                 std::make_shared<TcpConnection<MessageType>>(owner::server,
                                                                              asioContext_, std::move(_socket), incomingTcpMessages_);
 
-                            if (OnClientConnect(newConnection)) {
-                                activeTcpConnections_.push_back(std::move(newConnection));
-
-                                activeTcpConnections_.back()->ConnectToClient(this, IDCounter_++);
-
-                                std::cout << "[SERVER][" << activeTcpConnections_.back()->GetID() << "] Connection Approved\n";
+                            newConnection->SetCounters(&counters_);
+                            std::weak_ptr<TcpConnection<MessageType>> weak = newConnection;
+                            newConnection->SetBackpressure(backpressure_, [this, weak](const BackpressureEvent& event) {
+                                if (auto client = weak.lock())
+                                    OnBackpressure(client, event);
+                            });
+                            if (heartbeatId_)
+                                newConnection->SetHeartbeat(timers_, *heartbeatId_, heartbeatInterval_, heartbeatMaxMissed_);
+
+                            bool full;
+                            {
+                                std::scoped_lock lock(connectionsMutex_);
+                                full = activeTcpConnections_.full();
+                            }
+                            if (full) {
+                                // Refused before OnClientConnect, the user never hears of it
+                                std::cout << "[-----] Connection Denied, too many clients\n";
+                            } else if (OnClientConnect(newConnection)) {
+                                // The id of a client is its handle in the client map
+                                uint32_t id;
+                                {
+                                    std::scoped_lock lock(connectionsMutex_);
+                                    id = activeTcpConnections_.insert(newConnection);
+                                }
+                                if (id == ClientMap::InvalidHandle) {
+                                    // Only this handler inserts, but keep OnClientConnect and OnClientDisconnect paired
+                                    std::cout << "[-----] Connection Denied, too many clients\n";
+                                    OnClientDisconnect(newConnection);
+                                    WaitForClientConnection();
+                                    return;
+                                }
+
+                                // Start the handshake on the connection strand
+                                asio::dispatch(newConnection->GetExecutor(), [this, newConnection, id]() {
+                                    newConnection->ConnectToClient(this, id);
+                                });
+
+                                std::cout << "[SERVER][" << id << "] Connection Approved\n";
                             } else {
                                 std::cout << "[-----] Connection Denied\n";
                             }
@@ -116,17 +195,30 @@ namespace RType {
                 @param msg The message to send
             */
             void MessageClient(std::shared_ptr<TcpConnection<MessageType>> client, const message<MessageType>& msg) {
-                if (client && client->IsConnected()) {
-                    client->Send(msg);
-                } else {
-                    OnClientDisconnect(client);
+                MessageClient(std::move(client), make_shared_message(msg));
+            }
 
-                    client.reset();
+            /**
+                @brief Send a shared message to a specific client
+                @param client The client to send the message to
+                @param msg The message to send
+            */
+            void MessageClient(std::shared_ptr<TcpConnection<MessageType>> client, shared_message<MessageType> msg) {
+                if (!client)
+                    return;
+                if (client->IsConnected()) {
+                    client->Send(msg);
+                    return;
+                }
 
-                    // Then physically remove it from the container
-                    activeTcpConnections_.erase(
-                        std::remove(activeTcpConnections_.begin(), activeTcpConnections_.end(), client), activeTcpConnections_.end());
+                // A concurrent broadcast may have removed it already, only the remover reports it
+                bool removed;
+                {
+                    std::scoped_lock lock(connectionsMutex_);
+                    removed = RemoveClient(client);
                 }
+                if (removed)
+                    OnClientDisconnect(client);
             }
 
             /**
@@ -142,29 +234,55 @@ namespace RType {
                 }
             }
 
+            /**
+             * @brief Send a shared message to a specific client
+             *
+             * @param id Client id
+             * @param msg The message to send
+             */
+            void MessageClient(uint32_t id, shared_message<MessageType> msg) {
+                auto client = GetClientById(id);
+                if (client != nullptr) {
+                    MessageClient(client, std::move(msg));
+                }
+            }
+
             /**
                 @brief Send a message to all clients
                 @param msg The message to send
                 @param ignoreClient A client to ignore
             */
             void MessageAllClients(const message<MessageType>& msg, std::shared_ptr<TcpConnection<MessageType>> ignoreClient = nullptr) {
-                bool invalidClientExists = false;
-
-                for (auto& client : activeTcpConnections_) {
-                    if (client && client->IsConnected()) {
-                        if (client != ignoreClient)
-                            client->Send(msg);
-                    } else {
-                        OnClientDisconnect(client);
-                        client.reset();
+                MessageAllClients(make_shared_message(msg), std::move(ignoreClient));
+            }
 
-                        invalidClientExists = true;
+            /**
+                @brief Send a shared message to all clients, the body is shared by every client queue
+                @param msg The message to send
+                @param ignoreClient A client to ignore
+            */
+            void MessageAllClients(const shared_message<MessageType>& msg, std::shared_ptr<TcpConnection<MessageType>> ignoreClient = nullptr) {
+                std::vector<std::shared_ptr<TcpConnection<MessageType>>> invalidClients;
+
+                {
+                    std::scoped_lock lock(connectionsMutex_);
+                    for (auto& client : activeTcpConnections_) {
+                        if (client->IsConnected()) {
+                            if (client != ignoreClient)
+                                client->Send(msg);
+                        } else {
+                            invalidClients.push_back(client);
+                        }
                     }
+
+                    // Found under this lock, so each one is still in the map and removed here only
+                    for (auto& client : invalidClients)
+                        RemoveClient(client);
                 }
 
-                if (invalidClientExists)
-                    activeTcpConnections_.erase(
-                        std::remove(activeTcpConnections_.begin(), activeTcpConnections_.end(), nullptr), activeTcpConnections_.end());
+                // Called without the lock, so the callback may use the client list
+                for (auto& client : invalidClients)
+                    OnClientDisconnect(client);
             }
 
             /**
@@ -175,14 +293,14 @@ namespace RType {
             void Update(size_t maxMessages = -1, bool wait = false) {
                 if (wait) incomingTcpMessages_.wait();
 
-                size_t messageCount = 0;
-                while (messageCount < maxMessages && !incomingTcpMessages_.empty()) {
-                    auto msg = incomingTcpMessages_.pop_front();
+                incomingTcpMessages_.drain_into(batch_, maxMessages);
 
+                for (auto& msg : batch_) {
+                    counters_.incomingDwell.Record(std::chrono::steady_clock::now() - msg.receivedAt);
                     OnMessage(msg.remote, msg.msg);
-
-                    messageCount++;
                 }
+                // Keeps the capacity for the next call, but not the clients
+                batch_.clear();
             }
 
             /**
@@ -192,22 +310,97 @@ namespace RType {
              * @return std::shared_ptr<TcpConnection<MessageType>>
              */
             std::shared_ptr<TcpConnection<MessageType>> GetClientById(uint32_t id) {
-                for (auto& client : activeTcpConnections_) {
-                    if (client->GetID() == id)
-                        return client;
-                }
-                return nullptr;
+                std::scoped_lock lock(connectionsMutex_);
+                auto client = activeTcpConnections_.find(id);
+                return client != nullptr ? *client : nullptr;
             }
 
             /**
-             * @brief Get the Clients list
+             * @brief Get a copy of the Clients list
              *
              * @return std::deque<std::shared_ptr<TcpConnection<MessageType>>>
              */
             std::deque<std::shared_ptr<TcpConnection<MessageType>>> GetClients() {
-                return activeTcpConnections_;
+                std::scoped_lock lock(connectionsMutex_);
+                return {activeTcpConnections_.begin(), activeTcpConnections_.end()};
+            }
+
+            /**
+             * @brief Iterate over the clients without copying them
+             *
+             * @return ClientsView The clients, locked until the view is destroyed
+             */
+            ClientsView ViewClients() { return ClientsView(connectionsMutex_, activeTcpConnections_); }
+
+            /**
+             * @brief Get the number of clients
+             *
+             * @return size_t
+             */
+            [[nodiscard]] size_t GetClientCount() {
+                std::scoped_lock lock(connectionsMutex_);
+                return activeTcpConnections_.size();
+            }
+
+            /**
+             * @brief Snapshot of the TCP traffic since the server was created
+             *
+             * The counters are relaxed atomics split per io thread, so taking a snapshot
+             * costs a few thousand loads and a walk of the clients, and never stalls the
+             * io threads. Counters read while traffic flows may be a few messages apart.
+             *
+             * @return TcpStats
+             */
+            [[nodiscard]] TcpStats GetStats() {
+                TcpStats stats;
+                counters_.Collect(stats);
+
+                std::scoped_lock lock(connectionsMutex_);
+                stats.clients = activeTcpConnections_.size();
+                for (const auto& client : activeTcpConnections_) {
+                    size_t queued = client->GetOutgoingQueueSize();
+                    stats.queuedMessages += queued;
+                    stats.maxQueuedMessages = std::max(stats.maxQueuedMessages, queued);
+                }
+                return stats;
+            }
+
+            /**
+             * @brief Ping every client, must be called before Start
+             *
+             * Each connection measures its RTT (see TcpConnection::GetRtt) and is closed once
+             * maxMissed pings in a row went unanswered. Clients must enable it with the same id.
+             *
+             * @param pingId The message id of the heartbeats, e.g. ServerMessages::ServerPing
+             * @param interval Time between two pings
+             * @param maxMissed Unanswered pings before a client is dropped
+             */
+            void EnableHeartbeat(MessageType pingId, std::chrono::milliseconds interval = std::chrono::seconds(1), uint32_t maxMissed = 5) {
+                heartbeatId_ = pingId;
+                heartbeatInterval_ = interval;
+                heartbeatMaxMissed_ = maxMissed;
             }
 
+            /**
+             * @brief Bound the outgoing queue of every client, must be called before Start
+             *
+             * A message whose id is in config.conflated replaces the queued message of
+             * the same id, whatever the fill level, e.g. to only keep the latest
+             * ServerLobbyUpdated. Any other message that reaches a mark, 64k messages or
+             * 16 MiB by default, disconnects the client, or with DropOldest drops the
+             * oldest queued messages instead.
+             *
+             * @param config The high-water marks and the policy, 0 for no mark
+             */
+            void SetBackpressure(BackpressureConfig<MessageType> config) { backpressure_ = std::move(config); }
+
+            /**
+             * @brief Get the timer wheel of the server, its callbacks run on the network threads
+             *
+             * @return TimerWheel&
+             */
+            TimerWheel& GetTimers() noexcept { return timers_; }
+
            protected:
             /*
                 @brief Called when a client connects
@@ -229,22 +422,56 @@ namespace RType {
             */
             virtual void OnMessage(std::shared_ptr<TcpConnection<MessageType>> client, message<MessageType>& msg) = 0;
 
+            /**
+             * @brief Called each time a client outgoing queue reaches a high-water mark
+             *
+             * Runs on a network thread, not in Update, so don't block it.
+             *
+             * @param client The client whose queue is full
+             * @param event The applied policy and what it dropped
+             */
+            virtual void OnBackpressure(std::shared_ptr<TcpConnection<MessageType>> client, const BackpressureEvent& event) {
+                (void)client;
+                (void)event;
+            }
+
            public:
             virtual void OnClientValidated(std::shared_ptr<TcpConnection<MessageType>> client) = 0;
 
            protected:
+            /**
+             * @brief Remove client from the client map, connectionsMutex_ must be held
+             *
+             * @return true if client was in the map, its OnClientDisconnect is then up to the caller
+             */
+            bool RemoveClient(const std::shared_ptr<TcpConnection<MessageType>>& client) {
+                auto found = activeTcpConnections_.find(client->GetID());
+                if (found == nullptr || *found != client)
+                    return false;
+                return activeTcpConnections_.erase(client->GetID());
+            }
+
             uint16_t port_;  ///< Port to listen on
 
-            TsQueue<owned_message<MessageType, TcpConnection<MessageType>>> incomingTcpMessages_;  ///< Incoming message queue
+            IncomingQueue<owned_message<MessageType, TcpConnection<MessageType>>> incomingTcpMessages_;  ///< Incoming message queue
+            std::vector<owned_message<MessageType, TcpConnection<MessageType>>> batch_;                ///< Messages handled by the running Update
 
-            std::deque<std::shared_ptr<TcpConnection<MessageType>>> activeTcpConnections_;  ///< Active connections
+            ClientMap activeTcpConnections_;  ///< Active connections, by id
+            std::mutex connectionsMutex_;     ///< Protects activeTcpConnections_
 
-            asio::io_context asioContext_;  ///< ASIO context for networking operations
-            std::thread threadContext_;     ///< Thread context for networking events
+            asio::io_context asioContext_;         ///< ASIO context for networking operations
+            TimerWheel timers_{asioContext_};      ///< Timers run by asioContext_
+            TcpCounters counters_;                 ///< Traffic of every connection, see GetStats
+            std::vector<std::thread> threadPool_;  ///< Threads running the ASIO context
+            size_t threadCount_ = 1;               ///< Number of threads in threadPool_
 
             asio::ip::tcp::acceptor asioAcceptor_;  ///< Acceptor to allow client connection requests
 
-            uint32_t IDCounter_ = 10000;  ///< ID counter for clients
+            std::optional<MessageType> heartbeatId_;          ///< Message id of the heartbeats, unset when they are off
+            std::chrono::milliseconds heartbeatInterval_{0};  ///< Time between two pings
+            uint32_t heartbeatMaxMissed_ = 0;                 ///< Unanswered pings before a client is dropped
+
+            BackpressureConfig<MessageType> backpressure_;  ///< Outgoing queue limits of new clients
         };
     }  // namespace net
 }  // namespace RType
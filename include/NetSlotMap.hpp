@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include "NetCommon.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Container handing out 32-bit generational handles to its values
+         *
+         * Values are kept packed in one dense array, so iterating is a plain array
+         * walk. A handle holds the index of a slot pointing into that array and the
+         * generation of the slot, which is bumped on erase, so a stale handle is
+         * rejected instead of reaching the value that reused the slot. A slot whose
+         * generation is exhausted is retired rather than wrapped, so a handle is never
+         * valid again once its value is erased. Insert, find and erase are O(1), erase
+         * moves the last value into the hole, so pointers and dense order are
+         * invalidated by any insertion or erase.
+         *
+         * @tparam T Value type, must be movable
+         */
+        template <typename T>
+        class SlotMap {
+           public:
+            using Handle = uint32_t;
+            using iterator = typename std::vector<T>::iterator;
+            using const_iterator = typename std::vector<T>::const_iterator;
+
+            static constexpr uint32_t IndexBits = 20;                                 ///< Up to a million values at once
+            static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;              ///< Slot index of a handle
+            static constexpr uint32_t GenerationMask = (1u << (32 - IndexBits)) - 1;  ///< Generation of a handle, never 0
+            static constexpr Handle InvalidHandle = 0;                                ///< Never returned by insert
+
+            /**
+             * @brief Insert value
+             *
+             * @return Handle The handle of the value, InvalidHandle if the map is full
+             * @see full
+             */
+            Handle insert(T value) {
+                uint32_t index;
+                if (!freeSlots_.empty()) {
+                    index = freeSlots_.front();
+                    freeSlots_.pop_front();
+                } else if (slots_.size() <= IndexMask) {
+                    index = static_cast<uint32_t>(slots_.size());
+                    slots_.push_back({0, 1});
+                } else {
+                    return InvalidHandle;
+                }
+
+                Handle handle = (slots_[index].generation << IndexBits) | index;
+                slots_[index].dense = static_cast<uint32_t>(values_.size());
+                values_.push_back(std::move(value));
+                handles_.push_back(handle);
+                return handle;
+            }
+
+            /**
+             * @brief Find the value of handle
+             *
+             * @return T* The value, nullptr if the handle is stale or invalid
+             */
+            T* find(Handle handle) {
+                uint32_t index = handle & IndexMask;
+                if (index >= slots_.size() || slots_[index].dense == FreeSlot || slots_[index].generation != handle >> IndexBits)
+                    return nullptr;
+                return &values_[slots_[index].dense];
+            }
+
+            const T* find(Handle handle) const { return const_cast<SlotMap*>(this)->find(handle); }
+
+            [[nodiscard]] bool contains(Handle handle) const { return find(handle) != nullptr; }
+
+            /**
+             * @brief Remove the value of handle
+             *
+             * @return true if the handle was valid
+             */
+            bool erase(Handle handle) {
+                if (!contains(handle))
+                    return false;
+                eraseDense(slots_[handle & IndexMask].dense);
+                return true;
+            }
+
+            /**
+             * @brief Remove every value for which pred(handle, value) returns true
+             *
+             * @return size_t Number of removed values
+             */
+            template <typename Predicate>
+            size_t erase_if(Predicate&& pred) {
+                size_t erased = 0;
+                for (size_t i = 0; i < values_.size();) {
+                    if (pred(static_cast<Handle>(handles_[i]), values_[i])) {
+                        // The last value moved into i, check it too
+                        eraseDense(static_cast<uint32_t>(i));
+                        erased++;
+                    } else {
+                        i++;
+                    }
+                }
+                return erased;
+            }
+
+            /**
+             * @brief Make room for count values without reallocating
+             */
+            void reserve(size_t count) {
+                values_.reserve(count);
+                handles_.reserve(count);
+                slots_.reserve(count);
+            }
+
+            /**
+             * @brief Remove every value, every handle becomes stale
+             */
+            void clear() {
+                while (!values_.empty())
+                    eraseDense(static_cast<uint32_t>(values_.size() - 1));
+            }
+
+            /**
+             * @brief Handle of the value at position i of the dense array
+             */
+            [[nodiscard]] Handle handle_at(size_t i) const noexcept { return handles_[i]; }
+
+            /**
+             * @brief Whether the next insert would fail, every slot is in use or retired
+             */
+            [[nodiscard]] bool full() const noexcept { return freeSlots_.empty() && slots_.size() > IndexMask; }
+
+            [[nodiscard]] size_t size() const noexcept { return values_.size(); }
+            [[nodiscard]] bool empty() const noexcept { return values_.empty(); }
+
+            iterator begin() noexcept { return values_.begin(); }
+            iterator end() noexcept { return values_.end(); }
+            const_iterator begin() const noexcept { return values_.begin(); }
+            const_iterator end() const noexcept { return values_.end(); }
+
+           private:
+            static constexpr uint32_t FreeSlot = UINT32_MAX;  ///< Slot::dense of a slot without a value
+
+            struct Slot {
+                uint32_t dense;       ///< Position of the value in values_, FreeSlot while free
+                uint32_t generation;  ///< Generation of the live handle, or of the next one while free
+            };
+
+            void eraseDense(uint32_t dense) {
+                uint32_t index = handles_[dense] & IndexMask;
+                uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+                if (dense != last) {
+                    values_[dense] = std::move(values_[last]);
+                    handles_[dense] = handles_[last];
+                    slots_[handles_[dense] & IndexMask].dense = dense;
+                }
+                values_.pop_back();
+                handles_.pop_back();
+
+                slots_[index].dense = FreeSlot;
+                // A slot that went through every generation is never reused, its handles would come back
+                if (slots_[index].generation == GenerationMask)
+                    return;
+                slots_[index].generation++;
+                // Reused oldest first, so a slot goes through its generations as slowly as possible
+                freeSlots_.push_back(index);
+            }
+
+            std::vector<T> values_;           ///< Values, packed
+            std::vector<Handle> handles_;     ///< Handle of each value of values_
+            std::vector<Slot> slots_;         ///< Indexed by the handles
+            std::deque<uint32_t> freeSlots_;  ///< Slots without a value
+        };
+    }  // namespace net
+}  // namespace RType
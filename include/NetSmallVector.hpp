@@ -0,0 +1,188 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <iterator>
+#include <type_traits>
+
+#include "NetBodyPool.hpp"
+#include "NetCommon.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Vector with inline storage for the first InlineCapacity elements
+         *
+         * Only spills to the allocator once it grows past InlineCapacity, so small
+         * messages never allocate. Elements must be trivially copyable.
+         *
+         * Only the part of the std::vector interface used by message is provided: no
+         * insert, erase, emplace_back or at, no reverse iterators, iterators are raw
+         * pointers. Moving an inline vector copies its elements, so pointers into the
+         * source do not follow the move as they do with std::vector.
+         *
+         * @tparam T Element type
+         * @tparam InlineCapacity Number of elements stored inline
+         * @tparam Allocator Allocator used once the inline storage is exceeded
+         */
+        template <typename T, size_t InlineCapacity, typename Allocator = PoolAllocator<T>>
+        class SmallVector {
+            static_assert(std::is_trivially_copyable<T>::value, "SmallVector only holds trivially copyable types");
+
+           public:
+            using value_type = T;
+            using size_type = size_t;
+            using allocator_type = Allocator;
+            using iterator = T*;
+            using const_iterator = const T*;
+
+            SmallVector() = default;
+
+            explicit SmallVector(size_t count) { resize(count); }
+
+            SmallVector(const SmallVector& other) { assign(other.begin(), other.end()); }
+
+            SmallVector(SmallVector&& other) noexcept { steal(other); }
+
+            ~SmallVector() { release(); }
+
+            SmallVector& operator=(const SmallVector& other) {
+                if (this != &other)
+                    assign(other.begin(), other.end());
+                return *this;
+            }
+
+            SmallVector& operator=(SmallVector&& other) noexcept {
+                if (this != &other) {
+                    release();
+                    steal(other);
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Replaces the content with the elements of [first, last)
+             */
+            template <typename InputIt>
+            void assign(InputIt first, InputIt last) {
+                size_t count = std::distance(first, last);
+                size_ = 0;
+                reserve(count);
+                std::copy(first, last, data_);
+                size_ = count;
+            }
+
+            /**
+             * @brief Makes room for at least count elements
+             */
+            void reserve(size_t count) {
+                if (count <= capacity_)
+                    return;
+
+                size_t newCapacity = std::max(count, capacity_ * 2);
+                T* newData = allocator_.allocate(newCapacity);
+                std::memcpy(newData, data_, size_ * sizeof(T));
+
+                release();
+                data_ = newData;
+                capacity_ = newCapacity;
+            }
+
+            /**
+             * @brief Resizes to count elements, new elements are value-initialized
+             */
+            void resize(size_t count) {
+                reserve(count);
+                if (count > size_)
+                    std::memset(static_cast<void*>(data_ + size_), 0, (count - size_) * sizeof(T));
+                size_ = count;
+            }
+
+            void push_back(const T& value) {
+                reserve(size_ + 1);
+                data_[size_++] = value;
+            }
+
+            void pop_back() { --size_; }
+
+            /**
+             * @brief Removes every element, the capacity is kept
+             */
+            void clear() noexcept { size_ = 0; }
+
+            void swap(SmallVector& other) noexcept {
+                SmallVector tmp(std::move(other));
+                other = std::move(*this);
+                *this = std::move(tmp);
+            }
+
+            [[nodiscard]] T* data() noexcept { return data_; }
+            [[nodiscard]] const T* data() const noexcept { return data_; }
+            [[nodiscard]] size_t size() const noexcept { return size_; }
+            [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+            [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+            /**
+             * @brief Returns true while the elements live in the inline storage
+             */
+            [[nodiscard]] bool is_inline() const noexcept { return data_ == inline_; }
+
+            T& operator[](size_t i) noexcept { return data_[i]; }
+            const T& operator[](size_t i) const noexcept { return data_[i]; }
+            T& front() noexcept { return data_[0]; }
+            const T& front() const noexcept { return data_[0]; }
+            T& back() noexcept { return data_[size_ - 1]; }
+            const T& back() const noexcept { return data_[size_ - 1]; }
+
+            iterator begin() noexcept { return data_; }
+            iterator end() noexcept { return data_ + size_; }
+            const_iterator begin() const noexcept { return data_; }
+            const_iterator end() const noexcept { return data_ + size_; }
+
+            friend bool operator==(const SmallVector& lhs, const SmallVector& rhs) {
+                return lhs.size_ == rhs.size_ && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+            }
+
+            friend bool operator!=(const SmallVector& lhs, const SmallVector& rhs) { return !(lhs == rhs); }
+
+           private:
+            void release() noexcept {
+                if (!is_inline())
+                    allocator_.deallocate(data_, capacity_);
+                data_ = inline_;
+                capacity_ = InlineCapacity;
+            }
+
+            void steal(SmallVector& other) noexcept {
+                if (other.is_inline()) {
+                    std::memcpy(inline_, other.inline_, other.size_ * sizeof(T));
+                    data_ = inline_;
+                    capacity_ = InlineCapacity;
+                } else {
+                    data_ = other.data_;
+                    capacity_ = other.capacity_;
+                    other.data_ = other.inline_;
+                    other.capacity_ = InlineCapacity;
+                }
+                size_ = other.size_;
+                other.size_ = 0;
+            }
+
+            T* data_ = inline_;                     ///< Current storage, inline_ or a heap block
+            size_t size_ = 0;                       ///< Number of elements
+            size_t capacity_ = InlineCapacity;      ///< Number of elements data_ can hold
+            Allocator allocator_;                   ///< Allocator for the heap block
+            alignas(T) T inline_[InlineCapacity];  ///< Inline storage
+        };
+    }  // namespace net
+}  // namespace RType
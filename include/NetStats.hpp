@@ -0,0 +1,240 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "NetCommon.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Lock-free log-linear histogram of durations, in the spirit of HdrHistogram
+         *
+         * Durations are recorded in nanoseconds. Each power of two is split into 16
+         * linear buckets, so a reported percentile is within 1/16 of the recorded
+         * value, from 1 ns up to about 18 minutes. Recording is a few relaxed atomic
+         * adds, and any thread may record while another one takes a snapshot.
+         */
+        class LatencyHistogram {
+           public:
+            static constexpr size_t SubBucketBits = 4;                                         ///< log2 of the buckets per power of two
+            static constexpr size_t SubBuckets = size_t(1) << SubBucketBits;                   ///< Buckets per power of two
+            static constexpr size_t MaxBits = 40;                                              ///< Values are clamped below 2^MaxBits ns
+            static constexpr size_t BucketCount = (MaxBits - SubBucketBits + 1) * SubBuckets;  ///< Number of buckets
+
+            /**
+             * @brief Copy of a histogram, taken with Snapshot
+             */
+            struct Snapshot {
+                std::array<uint64_t, BucketCount> buckets{};  ///< Number of values per bucket
+                uint64_t count = 0;                           ///< Number of values
+                uint64_t sum = 0;                             ///< Sum of the values, in nanoseconds
+                uint64_t max = 0;                             ///< Largest value, in nanoseconds
+
+                /**
+                 * @brief Value below which p percent of the values are, 0 when empty
+                 *
+                 * @param p Percentile, between 0 and 100
+                 */
+                [[nodiscard]] std::chrono::nanoseconds Percentile(double p) const {
+                    uint64_t total = 0;
+                    for (auto bucket : buckets)
+                        total += bucket;
+                    if (total == 0)
+                        return std::chrono::nanoseconds(0);
+
+                    auto rank = static_cast<uint64_t>(std::clamp(p, 0.0, 100.0) / 100.0 * double(total - 1)) + 1;
+                    uint64_t seen = 0;
+                    for (size_t i = 0; i < BucketCount; i++) {
+                        seen += buckets[i];
+                        if (seen >= rank)
+                            return std::chrono::nanoseconds(std::min(BucketUpperBound(i), max));
+                    }
+                    return std::chrono::nanoseconds(max);
+                }
+
+                [[nodiscard]] std::chrono::nanoseconds Mean() const { return std::chrono::nanoseconds(count ? sum / count : 0); }
+                [[nodiscard]] std::chrono::nanoseconds Max() const { return std::chrono::nanoseconds(max); }
+            };
+
+            /**
+             * @brief Record a duration
+             */
+            void Record(std::chrono::nanoseconds duration) noexcept {
+                auto value = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+                buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+                count_.fetch_add(1, std::memory_order_relaxed);
+                sum_.fetch_add(value, std::memory_order_relaxed);
+
+                uint64_t max = max_.load(std::memory_order_relaxed);
+                while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+                }
+            }
+
+            /**
+             * @brief Copy the histogram, values recorded meanwhile may or may not be in it
+             */
+            [[nodiscard]] Snapshot TakeSnapshot() const {
+                Snapshot snapshot;
+                for (size_t i = 0; i < BucketCount; i++)
+                    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+                snapshot.count = count_.load(std::memory_order_relaxed);
+                snapshot.sum = sum_.load(std::memory_order_relaxed);
+                snapshot.max = max_.load(std::memory_order_relaxed);
+                return snapshot;
+            }
+
+            /**
+             * @brief Bucket holding value
+             */
+            static size_t BucketIndex(uint64_t value) noexcept {
+                value = std::min(value, (uint64_t(1) << MaxBits) - 1);
+                if (value < SubBuckets)
+                    return static_cast<size_t>(value);
+
+#if defined(__GNUC__) || defined(__clang__)
+                size_t msb = 63 - __builtin_clzll(value);
+#else
+                size_t msb = SubBucketBits;
+                while (value >> (msb + 1))
+                    msb++;
+#endif
+                size_t shift = msb - SubBucketBits;
+                return (shift + 1) * SubBuckets + static_cast<size_t>((value >> shift) & (SubBuckets - 1));
+            }
+
+            /**
+             * @brief Largest value held by bucket index
+             */
+            static uint64_t BucketUpperBound(size_t index) noexcept {
+                if (index < SubBuckets)
+                    return index;
+
+                size_t shift = index / SubBuckets - 1;
+                uint64_t base = (SubBuckets + index % SubBuckets) << shift;
+                return base + (uint64_t(1) << shift) - 1;
+            }
+
+           private:
+            std::array<std::atomic<uint64_t>, BucketCount> buckets_{};  ///< Number of values per bucket
+            std::atomic<uint64_t> count_{0};                            ///< Number of values
+            std::atomic<uint64_t> sum_{0};                              ///< Sum of the values
+            std::atomic<uint64_t> max_{0};                              ///< Largest value
+        };
+
+        /// Number of message ids counted one by one, higher ids share the last counter
+        constexpr size_t StatsMessageIds = 64;
+
+        /**
+         * @brief Snapshot of the TCP traffic of a server, returned by ServerInterface::GetStats
+         */
+        struct TcpStats {
+            uint64_t bytesIn = 0;                                     ///< Bytes read from the clients
+            uint64_t bytesOut = 0;                                    ///< Bytes written to the clients
+            uint64_t messagesIn = 0;                                  ///< Messages received
+            uint64_t messagesOut = 0;                                 ///< Messages written
+            std::array<uint64_t, StatsMessageIds> messagesInById{};   ///< Messages received, by message id
+            std::array<uint64_t, StatsMessageIds> messagesOutById{};  ///< Messages written, by message id
+            size_t clients = 0;                                       ///< Connected clients
+            size_t queuedMessages = 0;                                ///< Messages waiting in the outgoing queues
+            size_t maxQueuedMessages = 0;                             ///< Longest outgoing queue
+            uint64_t droppedMessages = 0;                             ///< Messages dropped by backpressure, conflated ones are not counted
+            uint64_t backpressureDisconnects = 0;                     ///< Clients closed by backpressure
+            LatencyHistogram::Snapshot incomingDwell;                 ///< Time from the socket to OnMessage
+            LatencyHistogram::Snapshot writeLatency;                  ///< Time from starting a write to its completion
+        };
+
+        /**
+         * @brief Live TCP counters, shared by the connections of a server
+         *
+         * The counters are split per thread on separate cache lines, so the io threads
+         * never write to the same line. Reading them sums every split.
+         */
+        class TcpCounters {
+           public:
+            void AddBytesIn(uint64_t bytes) noexcept { Local().bytesIn.fetch_add(bytes, std::memory_order_relaxed); }
+            void AddBytesOut(uint64_t bytes) noexcept { Local().bytesOut.fetch_add(bytes, std::memory_order_relaxed); }
+
+            template <typename MessageType>
+            void AddMessageIn(MessageType id) noexcept {
+                Local().messagesIn[IdIndex(id)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            template <typename MessageType>
+            void AddMessageOut(MessageType id) noexcept {
+                Local().messagesOut[IdIndex(id)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Count a backpressure event, they are rare so they share one counter
+             */
+            void AddBackpressure(uint64_t dropped, bool disconnected) noexcept {
+                droppedMessages_.fetch_add(dropped, std::memory_order_relaxed);
+                if (disconnected)
+                    backpressureDisconnects_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            LatencyHistogram incomingDwell;  ///< Time from the socket to OnMessage
+            LatencyHistogram writeLatency;   ///< Time from starting a write to its completion
+
+            /**
+             * @brief Fill the counters of stats
+             */
+            void Collect(TcpStats& stats) const {
+                for (const auto& split : splits_) {
+                    stats.bytesIn += split.bytesIn.load(std::memory_order_relaxed);
+                    stats.bytesOut += split.bytesOut.load(std::memory_order_relaxed);
+                    for (size_t i = 0; i < StatsMessageIds; i++) {
+                        uint64_t in = split.messagesIn[i].load(std::memory_order_relaxed);
+                        uint64_t out = split.messagesOut[i].load(std::memory_order_relaxed);
+                        stats.messagesInById[i] += in;
+                        stats.messagesOutById[i] += out;
+                        stats.messagesIn += in;
+                        stats.messagesOut += out;
+                    }
+                }
+                stats.droppedMessages = droppedMessages_.load(std::memory_order_relaxed);
+                stats.backpressureDisconnects = backpressureDisconnects_.load(std::memory_order_relaxed);
+                stats.incomingDwell = incomingDwell.TakeSnapshot();
+                stats.writeLatency = writeLatency.TakeSnapshot();
+            }
+
+           private:
+            static constexpr size_t Splits = 8;  ///< Threads beyond it share splits
+
+            struct alignas(64) Split {
+                std::atomic<uint64_t> bytesIn{0};                                  ///< Bytes read
+                std::atomic<uint64_t> bytesOut{0};                                 ///< Bytes written
+                std::array<std::atomic<uint64_t>, StatsMessageIds> messagesIn{};   ///< Messages received, by id
+                std::array<std::atomic<uint64_t>, StatsMessageIds> messagesOut{};  ///< Messages written, by id
+            };
+
+            template <typename MessageType>
+            static size_t IdIndex(MessageType id) noexcept {
+                auto index = static_cast<uint64_t>(id);
+                return index < StatsMessageIds ? static_cast<size_t>(index) : StatsMessageIds - 1;
+            }
+
+            Split& Local() noexcept {
+                static std::atomic<size_t> nextThread{0};
+                thread_local size_t thread = nextThread.fetch_add(1, std::memory_order_relaxed);
+                return splits_[thread % Splits];
+            }
+
+            std::array<Split, Splits> splits_;                   ///< Per thread counters
+            std::atomic<uint64_t> droppedMessages_{0};          ///< Messages dropped by backpressure, conflated ones are not counted
+            std::atomic<uint64_t> backpressureDisconnects_{0};  ///< Connections closed by backpressure
+        };
+    }  // namespace net
+}  // namespace RType
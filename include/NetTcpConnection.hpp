@@ -28,6 +28,8 @@ namespace RType {
         template <typename MessageType>
         class TcpConnection : public AConnection<MessageType>, public std::enable_shared_from_this<TcpConnection<MessageType>> {
            public:
+            static constexpr size_t ReadBufferSize = 16 * 1024;  ///< Initial size of the receive buffer
+
             /**
              * @brief Construct a new Tcp Connection object
              *
@@ -39,7 +41,7 @@ namespace RType {
             TcpConnection(owner parent,
                           asio::io_context& context,
                           asio::ip::tcp::socket socket,
-                          TsQueue<owned_message<MessageType, TcpConnection<MessageType>>>& incomingMessages) : AConnection<MessageType>(parent, context, std::move(socket), incomingMessages) {}
+                          IncomingQueue<owned_message<MessageType, TcpConnection<MessageType>>>& incomingMessages) : AConnection<MessageType>(parent, context, std::move(socket), incomingMessages) {}
 
             /**
              * @brief Destroy the Tcp Connection object
@@ -75,88 +77,338 @@ namespace RType {
              * @param msg
              */
             void Send(const message<MessageType>& msg) override {
-                asio::post(this->asioContext_,
-                           [this, msg]() {
-                               bool writingMessage = !this->outgoingMessages_.empty();
-                               this->outgoingMessages_.push_back(msg);
-                               if (!writingMessage) {
-                                   WriteHeader();
+                Send(make_shared_message(msg));
+            }
+
+            /**
+             * @brief Send a shared message, only the pointer is queued
+             *
+             * @param msg
+             */
+            void Send(shared_message<MessageType> msg) override {
+                asio::post(this->tcpSocket.get_executor(),
+                           [this, self = KeepAlive(), msg = std::move(msg)]() mutable {
+                               // Nothing will ever write it, don't let it pile up
+                               if (!this->IsConnected())
+                                   return;
+                               Enqueue(std::move(msg));
+                               if (!this->writing_ && this->queuedMessages_ > 0) {
+                                   WriteMessages();
                                }
                            });
             }
 
            private:
-            virtual void WriteHeader() final {
-                asio::async_write(this->tcpSocket,
-                                  asio::buffer(&this->outgoingMessages_.front().header, sizeof(message_header<MessageType>)),
-                                  [this](std::error_code ec, std::size_t length) {
-                                      (void)length;
+            /**
+             * @brief Reference held by the pending handlers, so a server may drop a client while
+             * they wait. A client connection is owned by its client instead, it returns nullptr.
+             */
+            std::shared_ptr<TcpConnection<MessageType>> KeepAlive() override { return this->weak_from_this().lock(); }
+
+            static constexpr size_t FrameSize(const message<MessageType>& msg) noexcept {
+                return sizeof(message_header<MessageType>) + msg.body.size();
+            }
+
+            static constexpr size_t LaneOf(MessageType id) noexcept {
+                return static_cast<size_t>(SendLanes<MessageType>::Of(id));
+            }
+
+            bool OverHighWater(size_t frameSize) const noexcept {
+                const auto& config = this->backpressure_;
+                return (config.maxQueuedMessages != 0 && this->queuedMessages_ + 1 > config.maxQueuedMessages) ||
+                       (config.maxQueuedBytes != 0 && this->queuedBytes_ + frameSize > config.maxQueuedBytes);
+            }
+
+            bool IsConflated(MessageType id) const {
+                const auto& conflated = this->backpressure_.conflated;
+                return std::find(conflated.begin(), conflated.end(), id) != conflated.end();
+            }
+
+            /**
+             * @brief Queues msg in its lane, applying the backpressure policy if it crosses a high-water mark
+             *
+             * A message of a conflated id replaces the queued one instead, so it never
+             * reaches a mark unless it is the only one of its id.
+             */
+            void Enqueue(shared_message<MessageType> msg) {
+                size_t frameSize = FrameSize(*msg);
+                bool conflated = IsConflated(msg->header.id);
+                if (conflated && Conflate(msg, frameSize))
+                    return;
+                if (OverHighWater(frameSize) && !ApplyBackpressure(frameSize))
+                    return;
+
+                auto& lane = this->lanes_[LaneOf(msg->header.id)];
+                if (conflated)
+                    *this->lastQueued_.try_emplace(msg->header.id).first = lane.pushed;
+                lane.messages.push_back(std::move(msg));
+                lane.pushed++;
+                this->queuedMessages_++;
+                this->queuedBytes_ += frameSize;
+                this->outgoingDepth_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Makes room for a message of frameSize bytes, or closes the connection
+             *
+             * @return true if the message must still be queued
+             */
+            bool ApplyBackpressure(size_t frameSize) {
+                const auto& config = this->backpressure_;
+                BackpressureEvent event{config.policy, this->queuedMessages_, this->queuedBytes_, 0, false};
+
+                if (config.policy == BackpressurePolicy::DropOldest) {
+                    // The least urgent messages go first
+                    for (size_t i = SendLaneCount; i-- > 0 && OverHighWater(frameSize);) {
+                        while (!this->lanes_[i].messages.empty() && OverHighWater(frameSize)) {
+                            PopOutgoing(this->lanes_[i]);
+                            event.droppedMessages++;
+                        }
+                    }
+                    ReportBackpressure(event);
+                    return true;
+                }
+
+                std::cout << "[Error][" << this->id_ << "] Outgoing queue full, disconnecting" << std::endl;
+                event.droppedMessages = this->queuedMessages_ + 1;
+                event.disconnected = true;
+                for (auto& lane : this->lanes_) {
+                    while (!lane.messages.empty())
+                        PopOutgoing(lane);
+                }
+                this->tcpSocket.close();
+                ReportBackpressure(event);
+                return false;
+            }
+
+            /**
+             * @brief Replaces the queued message with the id of msg by msg, in place
+             *
+             * @return false if no message with that id is queued
+             */
+            bool Conflate(shared_message<MessageType>& msg, size_t frameSize) {
+                // An id always maps to the same lane, so its push number indexes that lane
+                auto& lane = this->lanes_[LaneOf(msg->header.id)];
+                const uint64_t* pushed = this->lastQueued_.find(msg->header.id);
+                if (pushed == nullptr || *pushed < lane.popped)
+                    return false;
+
+                auto& queued = lane.messages[*pushed - lane.popped];
+                this->queuedBytes_ = this->queuedBytes_ - FrameSize(*queued) + frameSize;
+                queued = std::move(msg);
+                return true;
+            }
+
+            shared_message<MessageType> PopOutgoing(typename AConnection<MessageType>::OutgoingLane& lane) {
+                shared_message<MessageType> msg = std::move(lane.messages.front());
+                lane.messages.pop_front();
+                lane.popped++;
+                this->queuedMessages_--;
+                this->queuedBytes_ -= FrameSize(*msg);
+                this->outgoingDepth_.fetch_sub(1, std::memory_order_relaxed);
+                return msg;
+            }
+
+            void ReportBackpressure(const BackpressureEvent& event) {
+                if (this->counters_ != nullptr)
+                    this->counters_->AddBackpressure(event.droppedMessages, event.disconnected);
+                if (this->onBackpressure_)
+                    this->onBackpressure_(event);
+            }
+
+            /**
+             * @brief Gathers the header and body of queued messages, up to the coalescing
+             * caps, and writes them with a single vectored write
+             *
+             * The lanes are picked by deficit round robin: each round a non-empty lane earns
+             * its quantum of bytes and writes messages while it has enough, in priority order,
+             * so Control messages jump ahead of queued bulk data without starving it.
+             */
+            virtual void WriteMessages() final {
+                this->writing_ = true;
+                this->writeBuffers_.clear();
+
+                size_t bytes = 0;
+                bool full = false;
+                while (!full && this->queuedMessages_ > 0) {
+                    for (auto& lane : this->lanes_) {
+                        if (lane.messages.empty()) {
+                            // An idle lane does not save up bytes
+                            lane.deficit = 0;
+                            continue;
+                        }
+
+                        lane.deficit += lane.quantum;
+                        while (!lane.messages.empty()) {
+                            const auto& next = lane.messages.front();
+                            size_t frameSize = FrameSize(*next);
+                            size_t frameBuffers = next->body.empty() ? 1 : 2;
+                            if (frameSize > lane.deficit)
+                                break;
+                            if (!this->writingMessages_.empty() &&
+                                (bytes + frameSize > this->maxWriteBytes_ || this->writeBuffers_.size() + frameBuffers > this->maxWriteBuffers_)) {
+                                full = true;
+                                break;
+                            }
+
+                            lane.deficit -= frameSize;
+                            this->writingMessages_.push_back(PopOutgoing(lane));
+                            const auto& msg = this->writingMessages_.back();
+                            this->writeBuffers_.emplace_back(&msg->header, sizeof(message_header<MessageType>));
+                            if (!msg->body.empty()) {
+                                this->writeBuffers_.emplace_back(msg->body.data(), msg->body.size());
+                            }
+                            bytes += frameSize;
+                        }
+                        if (lane.messages.empty())
+                            lane.deficit = 0;
+                        if (full)
+                            break;
+                    }
+                }
+
+                this->writeStartedAt_ = std::chrono::steady_clock::now();
+                asio::async_write(this->tcpSocket, this->writeBuffers_,
+                                  [this, self = KeepAlive()](std::error_code ec, std::size_t length) {
+                                      if (!ec)
+                                          CountWrite(length);
+                                      this->writingMessages_.clear();
                                       if (!ec) {
-                                          if (this->outgoingMessages_.front().body.size() > 0) {
-                                              WriteBody();
+                                          if (this->queuedMessages_ > 0) {
+                                              WriteMessages();
                                           } else {
-                                              this->outgoingMessages_.pop_front();
-                                              if (!this->outgoingMessages_.empty()) {
-                                                  WriteHeader();
-                                              }
+                                              this->writing_ = false;
                                           }
                                       } else {
-                                          std::cout << "[Error][" << this->id_ << "] Write header failed: " << ec.message() << std::endl;
+                                          this->writing_ = false;
+                                          std::cout << "[Error][" << this->id_ << "] Write failed: " << ec.message() << std::endl;
                                           this->tcpSocket.close();
                                       }
                                   });
             }
 
-            virtual void WriteBody() final {
-                asio::async_write(this->tcpSocket,
-                                  asio::buffer(this->outgoingMessages_.front().body.data(), this->outgoingMessages_.front().body.size()),
-                                  [this](std::error_code ec, std::size_t length) {
-                                      (void)length;
-                                      if (!ec) {
-                                          this->outgoingMessages_.pop_front();
-                                          if (!this->outgoingMessages_.empty()) {
-                                              WriteHeader();
-                                          }
-                                      } else {
-                                          std::cout << "[Error][" << this->id_ << "] Write body failed: " << ec.message() << std::endl;
-                                          this->tcpSocket.close();
-                                      }
-                                  });
+            /**
+             * @brief Reads as many bytes as the socket has into the receive buffer, then
+             * parses every complete frame it holds
+             */
+            virtual void ReadFrames() final {
+                if (this->readBuffer_.empty()) {
+                    this->readBuffer_.resize(ReadBufferSize);
+                }
+
+                // Move the partial frame left by the previous read to the front
+                if (this->readStart_ > 0) {
+                    std::memmove(this->readBuffer_.data(), this->readBuffer_.data() + this->readStart_, this->readEnd_ - this->readStart_);
+                    this->readEnd_ -= this->readStart_;
+                    this->readStart_ = 0;
+                }
+
+                this->tcpSocket.async_read_some(asio::buffer(this->readBuffer_.data() + this->readEnd_, this->readBuffer_.size() - this->readEnd_),
+                                                [this, self = KeepAlive()](std::error_code ec, std::size_t length) {
+                                                    if (!ec) {
+                                                        this->readAt_ = std::chrono::steady_clock::now();
+                                                        this->bytesReceived_.fetch_add(length, std::memory_order_relaxed);
+                                                        if (this->counters_ != nullptr)
+                                                            this->counters_->AddBytesIn(length);
+                                                        this->readEnd_ += length;
+                                                        if (ParseFrames())
+                                                            ReadFrames();
+                                                        else
+                                                            PauseReading();
+                                                    } else {
+                                                        if (ec != asio::error::eof) {
+                                                            std::cout << "[Error][" << this->id_ << "] Read failed: " << ec.message() << std::endl;
+                                                        }
+                                                        this->tcpSocket.close();
+                                                    }
+                                                });
             }
 
-            virtual void ReadHeader() final {
-                asio::async_read(this->tcpSocket,
-                                 asio::buffer(&this->tempIncomingMessage_.header, sizeof(message_header<MessageType>)),
-                                 [this](std::error_code ec, std::size_t length) {
-                                     (void)length;
-                                     if (!ec) {
-                                         if (this->tempIncomingMessage_.header.size > 0) {
-                                             this->tempIncomingMessage_.body.resize(this->tempIncomingMessage_.header.size);
-                                             ReadBody();
-                                         } else {
-                                             this->AddToIncomingMessageQueue();
-                                         }
-                                     } else {
-                                         if (ec != asio::error::eof) {
-                                             std::cout << "[Error][" << this->id_ << "] Read header failed: " << ec.message() << std::endl;
-                                         }
-                                         this->tcpSocket.close();
-                                     }
-                                 });
+            /**
+             * @brief Queues every complete frame of the receive buffer, a trailing partial
+             * frame is kept for the next read
+             *
+             * @return false if the incoming queue is full, the unqueued frames stay in the buffer
+             */
+            bool ParseFrames() {
+                constexpr size_t headerSize = sizeof(message_header<MessageType>);
+
+                while (this->readEnd_ - this->readStart_ >= headerSize) {
+                    const uint8_t* frame = this->readBuffer_.data() + this->readStart_;
+                    std::memcpy(&this->tempIncomingMessage_.header, frame, headerSize);
+
+                    size_t frameSize = headerSize + this->tempIncomingMessage_.header.size;
+                    if (this->readEnd_ - this->readStart_ < frameSize) {
+                        // Make sure the whole frame fits once it is moved to the front
+                        if (this->readBuffer_.size() < frameSize) {
+                            this->readBuffer_.resize(frameSize);
+                        }
+                        break;
+                    }
+
+                    this->tempIncomingMessage_.body.assign(frame + headerSize, frame + frameSize);
+                    if (!HandleHeartbeat() && !this->AddToIncomingMessageQueue())
+                        return false;
+                    this->messagesReceived_.fetch_add(1, std::memory_order_relaxed);
+                    if (this->counters_ != nullptr)
+                        this->counters_->AddMessageIn(this->tempIncomingMessage_.header.id);
+                    this->readStart_ += frameSize;
+                }
+
+                if (this->readStart_ == this->readEnd_) {
+                    this->readStart_ = 0;
+                    this->readEnd_ = 0;
+                }
+                return true;
             }
 
-            virtual void ReadBody() final {
-                asio::async_read(this->tcpSocket,
-                                 asio::buffer(this->tempIncomingMessage_.body.data(), this->tempIncomingMessage_.body.size()),
-                                 [this](std::error_code ec, std::size_t length) {
-                                     (void)length;
-                                     if (!ec) {
-                                         this->AddToIncomingMessageQueue();
-                                     } else {
-                                         std::cout << "[Error][" << this->id_ << "] Read body failed: " << ec.message() << std::endl;
-                                         this->tcpSocket.close();
-                                     }
-                                 });
+            /**
+             * @brief Stops reading until the consumer drained the incoming queue
+             *
+             * Nothing is read from the socket meanwhile, so TCP flow control slows the
+             * peer down instead of blocking the io thread.
+             */
+            void PauseReading() {
+                this->readPaused_ = true;
+                // A client connection is not owned by a shared_ptr, it lives as long as its client
+                std::weak_ptr<TcpConnection<MessageType>> weak = this->weak_from_this();
+                bool shared = !weak.expired();
+                // Nothing else may be pending on the context meanwhile, keep it running
+                auto work = asio::make_work_guard(this->asioContext_);
+                this->incomingTcpMessages_.notify_when_drained([this, weak, shared, work]() {
+                    auto self = weak.lock();
+                    if (shared && !self)
+                        return;
+                    asio::post(this->GetExecutor(), [this, self]() { ResumeReading(); });
+                });
+            }
+
+            /**
+             * @brief Queues the frames left by PauseReading and reads again
+             */
+            void ResumeReading() {
+                if (!this->readPaused_ || !this->tcpSocket.is_open())
+                    return;
+                this->readPaused_ = false;
+                if (ParseFrames())
+                    ReadFrames();
+                else
+                    PauseReading();
+            }
+
+            /**
+             * @brief Counts the messages of the completed write
+             */
+            void CountWrite(size_t length) {
+                this->bytesSent_.fetch_add(length, std::memory_order_relaxed);
+                this->messagesSent_.fetch_add(this->writingMessages_.size(), std::memory_order_relaxed);
+                if (this->counters_ == nullptr)
+                    return;
+
+                this->counters_->writeLatency.Record(std::chrono::steady_clock::now() - this->writeStartedAt_);
+                this->counters_->AddBytesOut(length);
+                for (const auto& msg : this->writingMessages_)
+                    this->counters_->AddMessageOut(msg->header.id);
             }
 
             virtual void WriteValidation() final {
@@ -166,7 +418,8 @@ namespace RType {
                                       (void)length;
                                       if (!ec) {
                                           if (this->connectionOwner_ == owner::client) {
-                                              this->ReadHeader();
+                                              ArmHeartbeat();
+                                              this->ReadFrames();
                                           }
                                       } else {
                                           std::cout << "[Error][" << this->id_ << "] Write validation failed: " << ec.message() << std::endl;
@@ -177,27 +430,35 @@ namespace RType {
 
             virtual void ReadValidation(RType::net::ServerInterface<MessageType>* server = nullptr) final {
                 if (this->connectionOwner_ == owner::server) {
-                    AsyncTimer::GetInstance()->addTimer(this->id_, 5000, [this, server]() {
-                        std::cout << "Client Timed out while reading validation" << std::endl;
-                        this->tcpSocket.close();
+                    std::weak_ptr<TcpConnection<MessageType>> weak = this->shared_from_this();
+                    this->handshakeTimer_ = server->GetTimers().AddTimer(std::chrono::seconds(5), [weak]() {
+                        auto self = weak.lock();
+                        if (!self)
+                            return;
+                        asio::post(self->GetExecutor(), [self]() {
+                            std::cout << "Client Timed out while reading validation" << std::endl;
+                            self->tcpSocket.close();
+                        });
                     });
                 }
 
                 asio::async_read(this->tcpSocket, asio::buffer(&this->handshakeIn_, sizeof(uint64_t)),
                                  [this, server](std::error_code ec, std::size_t length) {
                                      (void)length;
+                                     if (this->connectionOwner_ == owner::server)
+                                         server->GetTimers().CancelTimer(this->handshakeTimer_);
                                      if (!ec) {
                                          if (this->connectionOwner_ == owner::server) {
                                              // Connection is a server, so check response from client
 
                                              // Compare sent data to actual solution
                                              if (this->handshakeIn_ == this->handshakeCheck_) {
-                                                 AsyncTimer::GetInstance()->removeTimer(this->id_);
                                                  // Client has provided valid solution, so allow it to connect properly
+                                                 ArmHeartbeat();
                                                  server->OnClientValidated(this->shared_from_this());
 
                                                  // Sit waiting to receive data now
-                                                 ReadHeader();
+                                                 ReadFrames();
                                              } else {
                                                  // Client gave incorrect data, so disconnect
                                                  std::cout << "Client Disconnected (Fail Validation)" << std::endl;
@@ -218,18 +479,94 @@ namespace RType {
                                  });
             }
 
-            virtual void AddToIncomingMessageQueue() final {
+            /**
+             * @brief Schedules the next ping, if heartbeats are on
+             */
+            void ArmHeartbeat() {
+                if (this->heartbeatTimers_ == nullptr || this->heartbeatInterval_.count() == 0 || this->heartbeatStopped_)
+                    return;
+
+                // A client connection is not owned by a shared_ptr, so the timer keeps a raw this:
+                // its wheel runs on the client context, which ClientInterface::Disconnect stops and
+                // joins before releasing the connection, so the callback never outlives it
+                std::weak_ptr<TcpConnection<MessageType>> weak = this->weak_from_this();
+                bool shared = !weak.expired();
+                this->heartbeatTimer_ = this->heartbeatTimers_->AddTimer(this->heartbeatInterval_, [this, weak, shared]() {
+                    auto self = weak.lock();
+                    if (shared && !self)
+                        return;
+                    asio::post(this->GetExecutor(), [this, self]() { Beat(); });
+                });
+            }
+
+            /**
+             * @brief Sends a ping, or closes the connection if too many went unanswered
+             */
+            void Beat() {
+                if (!this->IsConnected() || this->heartbeatStopped_)
+                    return;
+
+                if (this->missedBeats_ >= this->heartbeatMaxMissed_) {
+                    std::cout << "[Error][" << this->id_ << "] Heartbeat timed out" << std::endl;
+                    this->tcpSocket.close();
+                    return;
+                }
+
+                this->missedBeats_++;
+                SendHeartbeat(Heartbeat::MakePing());
+                ArmHeartbeat();
+            }
+
+            void SendHeartbeat(const Heartbeat& beat) {
+                message<MessageType> msg;
+                msg.header.id = this->heartbeatId_;
+                msg.body.resize(Heartbeat::Size);
+                beat.Encode(msg.body.data());
+                msg.header.size = msg.size();
+                Send(msg);
+            }
+
+            /**
+             * @brief Answers a ping or measures the RTT of a pong
+             *
+             * @return true if the received message was a heartbeat
+             */
+            bool HandleHeartbeat() {
+                Heartbeat beat;
+                if (this->heartbeatTimers_ == nullptr || this->tempIncomingMessage_.header.id != this->heartbeatId_ ||
+                    !Heartbeat::Decode(this->tempIncomingMessage_.body.data(), this->tempIncomingMessage_.body.size(), beat))
+                    return false;
+
+                if (beat.kind == Heartbeat::Kind::Ping) {
+                    beat.kind = Heartbeat::Kind::Pong;
+                    SendHeartbeat(beat);
+                } else {
+                    this->missedBeats_ = 0;
+                    this->rtt_.Sample(beat.Age());
+                    this->rttUs_.store(this->rtt_.GetRtt().count(), std::memory_order_relaxed);
+                    this->jitterUs_.store(this->rtt_.GetJitter().count(), std::memory_order_relaxed);
+                }
+                return true;
+            }
+
+            /**
+             * @brief Moves the parsed frame to the incoming queue
+             *
+             * @return false if the queue is full, the frame is left to be parsed again
+             */
+            virtual bool AddToIncomingMessageQueue() final {
+                // The body is moved, never copied, from here to OnMessage. The next frame
+                // gets a fresh buffer from the BodyPool, recycled from consumed messages.
+                owned_message<MessageType, TcpConnection<MessageType>> msg;
                 if (this->connectionOwner_ == owner::server) {
-                    owned_message<MessageType, TcpConnection<MessageType>> msg;
                     msg.remote = this->shared_from_this();
-                    msg.msg = this->tempIncomingMessage_;
-                    this->incomingTcpMessages_.push_back(msg);
-                } else {
-                    owned_message<MessageType, TcpConnection<MessageType>> msg{nullptr, this->tempIncomingMessage_};
-                    this->incomingTcpMessages_.push_back(msg);
                 }
+                msg.msg = std::move(this->tempIncomingMessage_);
+                msg.receivedAt = this->readAt_;
+                this->tempIncomingMessage_.body.clear();
 
-                ReadHeader();
+                // try_emplace only moves from msg once a slot is claimed
+                return this->incomingTcpMessages_.try_emplace(std::move(msg));
             }
         };
 
@@ -0,0 +1,238 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include "NetCommon.hpp"
+#include "NetServer.hpp"
+#include "NetStats.hpp"
+#include "NetUdpConnection.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief The tick being run, passed to the simulation step
+         */
+        struct TickInfo {
+            uint64_t index;                                  ///< Slot of the tick on the fixed schedule, ticks skipped by an overrun leave gaps
+            std::chrono::nanoseconds period;                 ///< Fixed time step of the simulation
+            std::chrono::steady_clock::time_point deadline;  ///< When the tick was due
+            std::chrono::nanoseconds lateness;               ///< How long after its deadline it started
+        };
+
+        /**
+         * @brief Timing of a TickScheduler, returned by TickScheduler::GetStats
+         */
+        struct TickStats {
+            uint64_t ticks = 0;                   ///< Ticks run
+            uint64_t overruns = 0;                ///< Ticks whose work took longer than the period
+            uint64_t skippedTicks = 0;            ///< Ticks dropped to catch up after overruns
+            std::chrono::nanoseconds period{0};   ///< Time between two ticks
+            LatencyHistogram::Snapshot lateness;  ///< Time from the deadline of a tick to its start
+            LatencyHistogram::Snapshot duration;  ///< Time taken by the work of a tick
+        };
+
+        /**
+         * @brief Runs a fixed-timestep server loop on an asio context
+         *
+         * Every tick polls the registered TCP servers in one batch, runs the simulation
+         * step, then flushes the registered UDP servers, so the state of a tick leaves in
+         * one burst. Deadlines are computed from the start time and the tick number, never
+         * from the previous wake up, so the rate does not drift. A tick that starts late
+         * is followed by the missed ones back to back, up to SetMaxCatchUp, the others
+         * are skipped.
+         *
+         * Everything runs on the thread running the context. Give the scheduler its own
+         * context, run by the game thread, rather than the context of a server, whose
+         * threads must stay free for the network. The scheduler must be destroyed after
+         * the context stopped running.
+         */
+        class TickScheduler {
+           public:
+            using Step = std::function<void(const TickInfo&)>;
+
+            /**
+             * @brief Construct a new Tick Scheduler object
+             *
+             * @param context The context running the ticks
+             * @param rate Ticks per second
+             */
+            explicit TickScheduler(asio::io_context& context, double rate = 60.0) : timer_(context) { SetRate(rate); }
+
+            TickScheduler(const TickScheduler&) = delete;
+            TickScheduler& operator=(const TickScheduler&) = delete;
+
+            /**
+             * @brief Set the number of ticks per second, only while stopped
+             */
+            void SetRate(double rate) {
+                if (IsRunning()) {
+                    std::cout << "[TICK] The rate can't change while running" << std::endl;
+                    return;
+                }
+                period_ = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / std::max(rate, 0.001)));
+            }
+
+            [[nodiscard]] std::chrono::nanoseconds GetPeriod() const noexcept { return period_; }
+
+            /**
+             * @brief Set how many late ticks may run back to back after an overrun
+             *
+             * 0 keeps the schedule without ever running a tick late twice in a row, more
+             * keeps the simulation time closer to the wall clock after short hiccups.
+             */
+            void SetMaxCatchUp(uint32_t ticks) noexcept { maxCatchUp_ = ticks; }
+
+            /**
+             * @brief Drain the incoming queue of server at the start of every tick, its OnMessage runs there
+             *
+             * @param server The server, it must outlive the scheduler
+             * @param maxMessages The maximum number of messages handled per tick
+             */
+            template <typename MessageType>
+            void AddTcpServer(ServerInterface<MessageType>& server, size_t maxMessages = -1) {
+                AddPoll([&server, maxMessages]() { server.Update(maxMessages, false); });
+            }
+
+            /**
+             * @brief Flush the datagrams queued by server at the end of every tick
+             *
+             * Pair it with UdpServerInterface::EnableBatchedIo, every SendAsync of the tick
+             * then leaves in a few sendmmsg calls.
+             */
+            void AddUdpServer(std::shared_ptr<UdpConnection> server) {
+                AddFlush([server = std::move(server)]() { server->Flush(); });
+            }
+
+            /**
+             * @brief Run poll at the start of every tick, before the step
+             */
+            void AddPoll(std::function<void()> poll) { polls_.push_back(std::move(poll)); }
+
+            /**
+             * @brief Set the simulation step, run once per tick
+             */
+            void SetStep(Step step) { step_ = std::move(step); }
+
+            /**
+             * @brief Run flush at the end of every tick, after the step
+             */
+            void AddFlush(std::function<void()> flush) { flushes_.push_back(std::move(flush)); }
+
+            /**
+             * @brief Start ticking, the first tick is due immediately
+             *
+             * @return false if already running
+             */
+            bool Start() {
+                if (IsRunning()) {
+                    std::cout << "[TICK] Already running" << std::endl;
+                    return false;
+                }
+
+                running_ = true;
+                uint64_t generation = ++generation_;
+                asio::post(timer_.get_executor(), [this, generation]() {
+                    start_ = std::chrono::steady_clock::now();
+                    tick_ = 0;
+                    Schedule(generation);
+                });
+                return true;
+            }
+
+            /**
+             * @brief Stop ticking, a tick already running completes
+             */
+            void Stop() {
+                if (!running_.exchange(false))
+                    return;
+                asio::post(timer_.get_executor(), [this]() { timer_.cancel(); });
+            }
+
+            [[nodiscard]] bool IsRunning() const noexcept { return running_; }
+
+            /**
+             * @brief Snapshot of the tick timing since the scheduler was created, callable from any thread
+             *
+             * @return TickStats
+             */
+            [[nodiscard]] TickStats GetStats() const {
+                TickStats stats;
+                stats.ticks = ticks_.load(std::memory_order_relaxed);
+                stats.overruns = overruns_.load(std::memory_order_relaxed);
+                stats.skippedTicks = skippedTicks_.load(std::memory_order_relaxed);
+                stats.period = period_;
+                stats.lateness = lateness_.TakeSnapshot();
+                stats.duration = duration_.TakeSnapshot();
+                return stats;
+            }
+
+           private:
+            std::chrono::steady_clock::time_point Deadline(uint64_t tick) const { return start_ + period_ * tick; }
+
+            void Schedule(uint64_t generation) {
+                timer_.expires_at(Deadline(tick_));
+                timer_.async_wait([this, generation](std::error_code ec) {
+                    if (!ec && running_ && generation == generation_)
+                        Tick(generation);
+                });
+            }
+
+            void Tick(uint64_t generation) {
+                auto started = std::chrono::steady_clock::now();
+                TickInfo info{tick_, period_, Deadline(tick_), started - Deadline(tick_)};
+                lateness_.Record(info.lateness);
+
+                for (auto& poll : polls_)
+                    poll();
+                if (step_)
+                    step_(info);
+                for (auto& flush : flushes_)
+                    flush();
+
+                auto finished = std::chrono::steady_clock::now();
+                duration_.Record(finished - started);
+                ticks_.fetch_add(1, std::memory_order_relaxed);
+                if (finished - started > period_)
+                    overruns_.fetch_add(1, std::memory_order_relaxed);
+
+                // Every tick from tick_ to due is late, run at most maxCatchUp_ of them
+                tick_++;
+                uint64_t due = static_cast<uint64_t>((finished - start_) / period_);
+                if (due >= tick_ && due - tick_ + 1 > maxCatchUp_) {
+                    uint64_t skipped = due - tick_ + 1 - maxCatchUp_;
+                    skippedTicks_.fetch_add(skipped, std::memory_order_relaxed);
+                    tick_ += skipped;
+                }
+                Schedule(generation);
+            }
+
+            asio::steady_timer timer_;                     ///< Wakes the context at each deadline
+            std::chrono::nanoseconds period_{0};           ///< Time between two ticks
+            std::chrono::steady_clock::time_point start_;  ///< Deadline of tick 0
+            uint64_t tick_ = 0;                            ///< Next tick to run
+            uint32_t maxCatchUp_ = 3;                      ///< Late ticks run back to back at most
+            std::atomic<bool> running_ = false;            ///< Whether the ticks are scheduled
+            std::atomic<uint64_t> generation_ = 0;         ///< Bumped by Start, stale waits are ignored
+
+            std::vector<std::function<void()>> polls_;    ///< Run first in a tick
+            Step step_;                                   ///< The simulation step
+            std::vector<std::function<void()>> flushes_;  ///< Run last in a tick
+
+            std::atomic<uint64_t> ticks_ = 0;         ///< Ticks run
+            std::atomic<uint64_t> overruns_ = 0;      ///< Ticks longer than the period
+            std::atomic<uint64_t> skippedTicks_ = 0;  ///< Ticks dropped by overruns
+            LatencyHistogram lateness_;               ///< Deadline to start of the ticks
+            LatencyHistogram duration_;               ///< Work time of the ticks
+        };
+    }  // namespace net
+}  // namespace RType
@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "NetCommon.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Hierarchical timing wheel driven by an asio context
+         *
+         * Timers are kept in 4 levels of 64 slots, one tick per level 0 slot, each
+         * level covering 64 times the span of the previous one. Adding or cancelling
+         * a timer links or unlinks a node, and a single steady_timer wakes the
+         * context when the next slot is due, so there is no thread and no asio
+         * timer per armed timer. Timers further than 64^4 ticks away fire late.
+         *
+         * Every method can be called from any thread. Callbacks run on a thread of
+         * the context, outside of the wheel lock, so they may add or cancel timers.
+         * The wheel must be destroyed after the context stopped running.
+         */
+        class TimerWheel {
+           public:
+            using Handle = uint64_t;
+
+            static constexpr Handle InvalidHandle = 0;  ///< Never returned by AddTimer
+
+            /**
+             * @brief Construct a new Timer Wheel object
+             *
+             * @param context The context running the callbacks
+             * @param tick Resolution of the wheel, a timer fires at most one tick after its delay
+             */
+            explicit TimerWheel(asio::io_context& context, std::chrono::milliseconds tick = std::chrono::milliseconds(1))
+                : timer_(context), tick_(std::max(tick, std::chrono::milliseconds(1))), start_(std::chrono::steady_clock::now()) {
+                for (auto& level : slots_)
+                    level.fill(NoNode);
+            }
+
+            TimerWheel(const TimerWheel&) = delete;
+            TimerWheel& operator=(const TimerWheel&) = delete;
+
+            /**
+             * @brief Call callback once delay elapsed
+             *
+             * @param delay Minimum time to wait
+             * @param callback Called on the context
+             * @return Handle To cancel the timer
+             */
+            Handle AddTimer(std::chrono::milliseconds delay, std::function<void()> callback) {
+                std::scoped_lock lock(mutex_);
+                uint64_t now = Now();
+                // Nothing to move when the wheel is empty, skip the idle ticks
+                if (count_ == 0)
+                    currentTick_ = std::max(currentTick_, now);
+
+                uint32_t node;
+                if (!freeNodes_.empty()) {
+                    node = freeNodes_.back();
+                    freeNodes_.pop_back();
+                } else {
+                    node = static_cast<uint32_t>(nodes_.size());
+                    nodes_.emplace_back();
+                }
+
+                // now is the start of the current tick, one more tick so it never fires early
+                uint64_t ticks = std::max<int64_t>((delay + tick_ - std::chrono::milliseconds(1)) / tick_, 0);
+                nodes_[node].expiry = now + ticks + 1;
+                nodes_[node].callback = std::move(callback);
+                nodes_[node].armed = true;
+                Place(node);
+                count_++;
+
+                if (!waiting_ || nodes_[node].expiry < wakeTick_)
+                    Schedule();
+                return (uint64_t(nodes_[node].generation) << 32) | node;
+            }
+
+            /**
+             * @brief Cancel a timer
+             *
+             * @return true if the timer was cancelled
+             * @return false if it already fired, or is firing, or was cancelled
+             */
+            bool CancelTimer(Handle handle) {
+                std::function<void()> callback;
+                {
+                    std::scoped_lock lock(mutex_);
+                    uint32_t node = static_cast<uint32_t>(handle);
+                    if (node >= nodes_.size() || nodes_[node].generation != handle >> 32 || !nodes_[node].armed)
+                        return false;
+
+                    Unlink(node);
+                    callback = Release(node);
+                }
+                // The captures are destroyed outside of the lock
+                return true;
+            }
+
+            /**
+             * @brief Get the number of armed timers
+             *
+             * @return size_t
+             */
+            [[nodiscard]] size_t GetTimerCount() {
+                std::scoped_lock lock(mutex_);
+                return count_;
+            }
+
+           private:
+            static constexpr size_t Levels = 4;
+            static constexpr size_t SlotBits = 6;
+            static constexpr size_t SlotsPerLevel = size_t(1) << SlotBits;
+            static constexpr uint64_t SlotMask = SlotsPerLevel - 1;
+            static constexpr uint32_t NoNode = UINT32_MAX;
+
+            struct Node {
+                std::function<void()> callback;  ///< Called when the timer fires
+                uint64_t expiry = 0;             ///< Tick at which the timer fires
+                uint32_t prev = NoNode;          ///< Previous node of the slot
+                uint32_t next = NoNode;          ///< Next node of the slot
+                uint32_t generation = 1;         ///< Generation of the live handle, never 0
+                uint8_t level = 0;               ///< Level of the slot holding the node
+                uint8_t slot = 0;                ///< Slot holding the node
+                bool armed = false;              ///< Whether the node holds a timer
+            };
+
+            uint64_t Now() const { return (std::chrono::steady_clock::now() - start_) / tick_; }
+
+            /**
+             * @brief Link node into the slot matching its expiry
+             */
+            void Place(uint32_t node) {
+                Node& timer = nodes_[node];
+                uint64_t diff = timer.expiry > currentTick_ ? timer.expiry - currentTick_ : 0;
+                uint64_t expiry = timer.expiry;
+                size_t level = 0;
+                while (level + 1 < Levels && diff >= (uint64_t(1) << (SlotBits * (level + 1))))
+                    level++;
+                // Beyond the last level, park it in the farthest slot, it is placed again when it is reached
+                if (diff >= (uint64_t(1) << (SlotBits * Levels)))
+                    expiry = currentTick_ + (uint64_t(1) << (SlotBits * Levels)) - 1;
+
+                timer.level = static_cast<uint8_t>(level);
+                timer.slot = static_cast<uint8_t>((expiry >> (SlotBits * level)) & SlotMask);
+                timer.prev = NoNode;
+                timer.next = slots_[level][timer.slot];
+                if (timer.next != NoNode)
+                    nodes_[timer.next].prev = node;
+                slots_[level][timer.slot] = node;
+            }
+
+            void Unlink(uint32_t node) {
+                Node& timer = nodes_[node];
+                if (timer.prev != NoNode)
+                    nodes_[timer.prev].next = timer.next;
+                else
+                    slots_[timer.level][timer.slot] = timer.next;
+                if (timer.next != NoNode)
+                    nodes_[timer.next].prev = timer.prev;
+            }
+
+            std::function<void()> Release(uint32_t node) {
+                Node& timer = nodes_[node];
+                timer.armed = false;
+                timer.generation = timer.generation % UINT32_MAX + 1;
+                freeNodes_.push_back(node);
+                count_--;
+                std::function<void()> callback = std::move(timer.callback);
+                timer.callback = nullptr;
+                return callback;
+            }
+
+            /**
+             * @brief Move the wheel one tick forward, the callbacks due are appended to due
+             */
+            void Advance(std::vector<std::function<void()>>& due) {
+                currentTick_++;
+
+                // Bring the timers of every level whose span just ended one level down
+                size_t crossed = 0;
+                while (crossed + 1 < Levels && (currentTick_ & ((uint64_t(1) << (SlotBits * (crossed + 1))) - 1)) == 0)
+                    crossed++;
+                for (size_t level = crossed; level > 0; level--) {
+                    size_t slot = (currentTick_ >> (SlotBits * level)) & SlotMask;
+                    uint32_t node = slots_[level][slot];
+                    slots_[level][slot] = NoNode;
+                    while (node != NoNode) {
+                        uint32_t next = nodes_[node].next;
+                        Place(node);
+                        node = next;
+                    }
+                }
+
+                size_t slot = currentTick_ & SlotMask;
+                uint32_t node = slots_[0][slot];
+                slots_[0][slot] = NoNode;
+                while (node != NoNode) {
+                    uint32_t next = nodes_[node].next;
+                    if (nodes_[node].expiry <= currentTick_)
+                        due.push_back(Release(node));
+                    else
+                        Place(node);
+                    node = next;
+                }
+            }
+
+            /**
+             * @brief Arm the steady timer for the next slot holding timers, mutex_ must be held
+             */
+            void Schedule() {
+                if (count_ == 0) {
+                    waiting_ = false;
+                    return;
+                }
+
+                // The first busy slot of the current level 0 turn, or the end of the turn
+                uint64_t boundary = (currentTick_ | SlotMask) + 1;
+                uint64_t next = currentTick_ + 1;
+                while (next < boundary && slots_[0][next & SlotMask] == NoNode)
+                    next++;
+
+                if (waiting_ && wakeTick_ == next)
+                    return;
+                waiting_ = true;
+                wakeTick_ = next;
+                timer_.expires_at(start_ + tick_ * next);
+                timer_.async_wait([this](std::error_code ec) {
+                    if (!ec)
+                        OnTick();
+                });
+            }
+
+            void OnTick() {
+                std::vector<std::function<void()>> due;
+                {
+                    std::scoped_lock lock(mutex_);
+                    waiting_ = false;
+                    uint64_t now = Now();
+                    while (currentTick_ < now)
+                        Advance(due);
+                    Schedule();
+                }
+
+                for (auto& callback : due)
+                    callback();
+            }
+
+            asio::steady_timer timer_;                                       ///< Wakes the context for the next busy slot
+            std::chrono::milliseconds tick_;                                 ///< Duration of a tick
+            std::chrono::steady_clock::time_point start_;                    ///< Time of tick 0
+            std::mutex mutex_;                                               ///< Protects everything below
+            std::array<std::array<uint32_t, SlotsPerLevel>, Levels> slots_;  ///< First node of each slot
+            std::vector<Node> nodes_;                                        ///< Timer pool, indexed by the handles
+            std::vector<uint32_t> freeNodes_;                                ///< Nodes without a timer
+            uint64_t currentTick_ = 0;                                       ///< Last processed tick
+            uint64_t wakeTick_ = 0;                                          ///< Tick timer_ is armed for
+            size_t count_ = 0;                                               ///< Number of armed timers
+            bool waiting_ = false;                                           ///< Whether timer_ is armed
+        };
+    }  // namespace net
+}  // namespace RType
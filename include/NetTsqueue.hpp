@@ -79,6 +79,19 @@ namespace RType {
              * @param item
              */
             void push_back(const T& item) {
+                std::scoped_lock lock(mutex_);
+                queue_.emplace_back(item);
+
+                std::unique_lock<std::mutex> ul(blockingMutex_);
+                blocking_.notify_one();
+            }
+
+            /**
+             * @brief Moves an item to back of Queue
+             *
+             * @param item
+             */
+            void push_back(T&& item) {
                 std::scoped_lock lock(mutex_);
                 queue_.emplace_back(std::move(item));
 
@@ -86,6 +99,41 @@ namespace RType {
                 blocking_.notify_one();
             }
 
+            /**
+             * @brief Constructs an item in place at back of Queue
+             *
+             * @param args Arguments forwarded to the constructor of T
+             */
+            template <typename... Args>
+            void emplace_back(Args&&... args) {
+                std::scoped_lock lock(mutex_);
+                queue_.emplace_back(std::forward<Args>(args)...);
+
+                std::unique_lock<std::mutex> ul(blockingMutex_);
+                blocking_.notify_one();
+            }
+
+            /**
+             * @brief Constructs an item in place at back of Queue, never fails as the Queue is unbounded
+             *
+             * @param args Arguments forwarded to the constructor of T
+             * @return true
+             */
+            template <typename... Args>
+            bool try_emplace(Args&&... args) {
+                emplace_back(std::forward<Args>(args)...);
+                return true;
+            }
+
+            /**
+             * @brief Calls callback right away, the Queue is never full
+             *
+             * @param callback The callback
+             */
+            void notify_when_drained(std::function<void()> callback) {
+                callback();
+            }
+
             /**
              * @brief Adds an item to front of Queue
              *
@@ -93,7 +141,7 @@ namespace RType {
              */
             void push_front(const T& item) {
                 std::scoped_lock lock(mutex_);
-                queue_.emplace_front(std::move(item));
+                queue_.emplace_front(item);
 
                 std::unique_lock<std::mutex> ul(blockingMutex_);
                 blocking_.notify_one();
@@ -120,6 +168,35 @@ namespace RType {
                 return queue_.size();
             }
 
+            /**
+             * @brief Moves up to max items from front of Queue into container under a single lock
+             *
+             * When container is an empty std::deque<T> and the whole Queue fits, the storage is
+             * swapped out in O(1).
+             *
+             * @tparam Container Any container with push_back
+             * @param container The container receiving the items
+             * @param max The maximum number of items to move
+             * @return size_t The number of items moved
+             */
+            template <typename Container>
+            size_t drain_into(Container& container, size_t max = -1) {
+                std::scoped_lock lock(mutex_);
+                size_t n = std::min(max, queue_.size());
+
+                if constexpr (std::is_same_v<Container, std::deque<T>>) {
+                    if (n == queue_.size() && container.empty()) {
+                        container.swap(queue_);
+                        return n;
+                    }
+                }
+                for (size_t i = 0; i < n; i++) {
+                    container.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+                return n;
+            }
+
             /**
              * @brief Clears Queue
              *
@@ -0,0 +1,543 @@
+/**
+ * Copyright (c) 2024 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <array>
+#include <unordered_map>
+
+#include "NetCommon.hpp"
+#include "NetUdpConnection.hpp"
+#include "NetWire.hpp"
+
+namespace RType {
+    namespace net {
+        /**
+         * @brief Delivery guarantee of a message sent through UdpChannels
+         */
+        enum class UdpChannel : uint8_t {
+            Unreliable = 0,           ///< May be lost, duplicated or reordered
+            UnreliableSequenced = 1,  ///< May be lost, messages older than the last delivered one are dropped
+            ReliableOrdered = 2,      ///< Retransmitted until acknowledged, delivered once and in order
+        };
+
+        /**
+         * @brief Why UdpChannels forgot an endpoint
+         */
+        enum class UdpPeerLoss : uint8_t {
+            IdleTimeout,     ///< Nothing was received from it for the idle timeout
+            RetransmitLimit  ///< A reliable message was resent the maximum number of times without an ack
+        };
+
+        /**
+         * @brief Per endpoint channels on top of an UdpConnection
+         *
+         * Every datagram carries a packet sequence number plus the latest sequence
+         * received from the peer and a bitfield acknowledging the 32 before it, so acks
+         * ride along with regular traffic. Reliable messages are resent when they are
+         * not acknowledged within a retransmission timeout derived from the measured
+         * RTT. When there is no traffic to piggyback on, a bare ack is sent by Update.
+         *
+         * Forward what the connection receives to Receive, and call Update regularly or
+         * let Start drive it from a timer on the connection's io_context.
+         *
+         * The state of an endpoint is created by its first datagram, up to SetMaxPeers
+         * endpoints. Update forgets the endpoints that stayed silent for the idle timeout
+         * and those that did not acknowledge a reliable message after the maximum number
+         * of retransmissions, and reports them to the peer lost handler.
+         */
+        class UdpChannels : public std::enable_shared_from_this<UdpChannels> {
+           public:
+            using Clock = std::chrono::steady_clock;
+            /// Called for every delivered message, with the endpoint, the channel and the payload
+            using MessageHandler = std::function<void(const asio::ip::udp::endpoint&, UdpChannel, const uint8_t*, size_t)>;
+            /// Called for every endpoint forgotten by Update, with the reason
+            using PeerLostHandler = std::function<void(const asio::ip::udp::endpoint&, UdpPeerLoss)>;
+
+            static constexpr uint8_t PacketMarker = 0xC7;          ///< First byte of every channel datagram
+            static constexpr size_t HeaderSize = 12;               ///< Size of the channel header
+            static constexpr size_t SentHistorySize = 1024;        ///< Number of sent packets remembered per endpoint
+            static constexpr size_t MaxPendingReliable = 512;      ///< Maximum unacknowledged reliable messages per endpoint
+            static constexpr size_t DefaultMaxPeers = 1024;        ///< Endpoints tracked at once, by default
+            static constexpr uint32_t DefaultMaxRetransmits = 10;  ///< Resends of a reliable message before giving up, by default
+
+            /**
+             * @brief Construct the channel layer
+             *
+             * @param connection The connection used to send datagrams
+             * @param handler Called for every delivered message
+             */
+            UdpChannels(UdpConnection& connection, MessageHandler handler) : connection_(connection),
+                                                                             handler_(std::move(handler)),
+                                                                             timer_(connection.GetContext()) {}
+
+            /**
+             * @brief Start calling Update periodically on the connection's io_context
+             *
+             * @param period The update period, it bounds how late a bare ack is sent
+             */
+            void Start(std::chrono::milliseconds period = std::chrono::milliseconds(10)) {
+                period_ = period;
+                running_ = true;
+                ArmTimer();
+            }
+
+            /**
+             * @brief Stop the periodic update
+             */
+            void Stop() {
+                running_ = false;
+                timer_.cancel();
+            }
+
+            /**
+             * @brief Set the maximum number of endpoints tracked at once
+             *
+             * Datagrams from new endpoints are dropped and Send to them fails while the
+             * limit is reached. Every endpoint costs about 17 KB plus its pending messages.
+             */
+            void SetMaxPeers(size_t maxPeers) {
+                std::scoped_lock lock(mutex_);
+                maxPeers_ = maxPeers;
+            }
+
+            /**
+             * @brief Set the silence after which an endpoint is forgotten, zero never forgets
+             */
+            void SetIdleTimeout(Clock::duration timeout) {
+                std::scoped_lock lock(mutex_);
+                idleTimeout_ = timeout;
+            }
+
+            /**
+             * @brief Set how many times a reliable message is resent before its endpoint is given up
+             */
+            void SetMaxRetransmits(uint32_t retransmits) {
+                std::scoped_lock lock(mutex_);
+                maxRetransmits_ = retransmits;
+            }
+
+            /**
+             * @brief Set the handler called for every endpoint forgotten by Update
+             *
+             * It runs without the lock held, it may Send, which starts over with a new state.
+             */
+            void SetPeerLostHandler(PeerLostHandler handler) {
+                std::scoped_lock lock(mutex_);
+                peerLostHandler_ = std::move(handler);
+            }
+
+            /**
+             * @brief Send a message to an endpoint
+             *
+             * @param endpoint The endpoint to send to
+             * @param channel The delivery guarantee
+             * @param data The payload
+             * @param size The size of the payload
+             * @return true if the message was sent or queued for retransmission, false if the
+             * reliable window of this endpoint is full or no more endpoints can be tracked
+             */
+            bool Send(const asio::ip::udp::endpoint& endpoint, UdpChannel channel, const void* data, size_t size) {
+                std::vector<uint8_t> packet;
+                {
+                    std::scoped_lock lock(mutex_);
+                    Peer* found = FindOrAddPeer(endpoint);
+                    if (found == nullptr)
+                        return false;
+                    Peer& peer = *found;
+                    uint16_t messageSequence = 0;
+
+                    if (channel == UdpChannel::UnreliableSequenced) {
+                        messageSequence = peer.sequencedOut++;
+                    } else if (channel == UdpChannel::ReliableOrdered) {
+                        if (peer.pending.size() >= MaxPendingReliable)
+                            return false;
+                        messageSequence = peer.reliableOut++;
+
+                        auto& pending = peer.pending[messageSequence];
+                        pending.payload.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+                        pending.lastSent = Clock::now();
+                    }
+                    packet = BuildPacket(peer, static_cast<uint8_t>(channel), messageSequence, data, size);
+                }
+                connection_.SendAsync(endpoint, packet.data(), packet.size());
+                return true;
+            }
+
+            /**
+             * @brief Handle a datagram received by the connection
+             *
+             * @param endpoint The endpoint it came from
+             * @param buffer The datagram
+             * @param size The size of the datagram
+             * @return true if it was a channel datagram, false otherwise
+             */
+            bool Receive(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) {
+                auto bytes = static_cast<const uint8_t*>(buffer);
+                if (size < HeaderSize || bytes[0] != PacketMarker)
+                    return false;
+
+                uint8_t kind = bytes[1];
+                uint16_t sequence, ack, messageSequence;
+                uint32_t ackBits;
+                WireCodec<uint16_t>::decode(bytes + 2, sequence);
+                WireCodec<uint16_t>::decode(bytes + 4, ack);
+                WireCodec<uint32_t>::decode(bytes + 6, ackBits);
+                WireCodec<uint16_t>::decode(bytes + 10, messageSequence);
+
+                const uint8_t* payload = bytes + HeaderSize;
+                size_t payloadSize = size - HeaderSize;
+                auto channel = static_cast<UdpChannel>(kind & KindMask);
+
+                // Payloads delivered after the lock is released, the handler may Send
+                std::vector<std::vector<uint8_t>> released;
+                std::vector<uint8_t> ackPacket;
+                bool deliverCurrent = false;
+                {
+                    std::scoped_lock lock(mutex_);
+                    // A bare ack from an unknown endpoint has nothing to acknowledge
+                    auto it = peers_.find(endpoint);
+                    if (it == peers_.end() && (kind & KindMask) == AckOnlyKind)
+                        return true;
+                    Peer* found = it != peers_.end() ? &it->second : FindOrAddPeer(endpoint);
+                    if (found == nullptr)
+                        return true;
+                    Peer& peer = *found;
+                    peer.lastReceived = Clock::now();
+
+                    if (kind & HasAckFlag)
+                        ProcessAcks(peer, ack, ackBits);
+
+                    if ((kind & KindMask) == AckOnlyKind)
+                        return true;
+
+                    RecordReceived(peer, sequence);
+
+                    // Ack right away before the bitfield slides past packets never acknowledged
+                    if (peer.receivedSinceAck >= ImmediateAckThreshold)
+                        ackPacket = BuildPacket(peer, AckOnlyKind, 0, nullptr, 0);
+
+                    switch (channel) {
+                        case UdpChannel::Unreliable:
+                            deliverCurrent = true;
+                            break;
+                        case UdpChannel::UnreliableSequenced:
+                            if (!peer.hasSequencedIn || SequenceGreater(messageSequence, peer.sequencedIn)) {
+                                peer.hasSequencedIn = true;
+                                peer.sequencedIn = messageSequence;
+                                deliverCurrent = true;
+                            }
+                            break;
+                        case UdpChannel::ReliableOrdered: {
+                            uint16_t distance = messageSequence - peer.reliableIn;
+                            if (distance == 0) {
+                                deliverCurrent = true;
+                                peer.reliableIn++;
+                                for (auto it = peer.outOfOrder.find(peer.reliableIn); it != peer.outOfOrder.end(); it = peer.outOfOrder.find(peer.reliableIn)) {
+                                    released.push_back(std::move(it->second));
+                                    peer.outOfOrder.erase(it);
+                                    peer.reliableIn++;
+                                }
+                            } else if (distance < MaxPendingReliable) {
+                                peer.outOfOrder.emplace(messageSequence, std::vector<uint8_t>(payload, payload + payloadSize));
+                            }
+                            // Otherwise it is a duplicate of a delivered message, the ack is enough
+                            break;
+                        }
+                        default:
+                            return true;
+                    }
+                }
+
+                if (!ackPacket.empty())
+                    connection_.SendAsync(endpoint, ackPacket.data(), ackPacket.size());
+                if (deliverCurrent)
+                    handler_(endpoint, channel, payload, payloadSize);
+                for (auto& message : released)
+                    handler_(endpoint, channel, message.data(), message.size());
+                return true;
+            }
+
+            /**
+             * @brief Retransmit timed out reliable messages, send pending bare acks and forget lost endpoints
+             */
+            void Update() {
+                std::vector<std::pair<asio::ip::udp::endpoint, std::vector<uint8_t>>> packets;
+                std::vector<std::pair<asio::ip::udp::endpoint, UdpPeerLoss>> lost;
+                PeerLostHandler peerLostHandler;
+                {
+                    std::scoped_lock lock(mutex_);
+                    auto now = Clock::now();
+
+                    for (auto it = peers_.begin(); it != peers_.end();) {
+                        auto& [endpoint, peer] = *it;
+                        std::optional<UdpPeerLoss> loss;
+                        if (idleTimeout_ > Clock::duration::zero() && now - peer.lastReceived >= idleTimeout_)
+                            loss = UdpPeerLoss::IdleTimeout;
+
+                        size_t queued = packets.size();
+                        for (auto& [messageSequence, pending] : peer.pending) {
+                            if (loss)
+                                break;
+                            auto timeout = std::min<Clock::duration>(peer.rto * (1 << std::min<uint32_t>(pending.retries, 3)), MaxRetransmitTimeout);
+                            if (now - pending.lastSent < timeout)
+                                continue;
+                            if (pending.retries >= maxRetransmits_) {
+                                loss = UdpPeerLoss::RetransmitLimit;
+                                break;
+                            }
+
+                            pending.lastSent = now;
+                            pending.retries++;
+                            packets.emplace_back(endpoint, BuildPacket(peer, static_cast<uint8_t>(UdpChannel::ReliableOrdered), messageSequence,
+                                                                       pending.payload.data(), pending.payload.size()));
+                        }
+
+                        if (loss) {
+                            // Nothing more goes to a lost endpoint
+                            packets.resize(queued);
+                            lost.emplace_back(endpoint, *loss);
+                            it = peers_.erase(it);
+                            continue;
+                        }
+                        if (peer.ackPending)
+                            packets.emplace_back(endpoint, BuildPacket(peer, AckOnlyKind, 0, nullptr, 0));
+                        ++it;
+                    }
+                    if (!lost.empty())
+                        peerLostHandler = peerLostHandler_;
+                }
+
+                for (auto& [endpoint, packet] : packets)
+                    connection_.SendAsync(endpoint, packet.data(), packet.size());
+                if (peerLostHandler) {
+                    for (auto& [endpoint, loss] : lost)
+                        peerLostHandler(endpoint, loss);
+                }
+            }
+
+            /**
+             * @brief Forget everything about an endpoint
+             *
+             * @param endpoint The endpoint
+             */
+            void RemoveEndpoint(const asio::ip::udp::endpoint& endpoint) {
+                std::scoped_lock lock(mutex_);
+                peers_.erase(endpoint);
+            }
+
+            /**
+             * @brief Get the number of endpoints tracked
+             */
+            size_t GetPeerCount() {
+                std::scoped_lock lock(mutex_);
+                return peers_.size();
+            }
+
+            /**
+             * @brief Get the smoothed round trip time to an endpoint
+             *
+             * @param endpoint The endpoint
+             * @return std::chrono::microseconds, zero until a first ack is received
+             */
+            std::chrono::microseconds GetRtt(const asio::ip::udp::endpoint& endpoint) {
+                std::scoped_lock lock(mutex_);
+                auto it = peers_.find(endpoint);
+                if (it == peers_.end() || !it->second.hasRtt)
+                    return std::chrono::microseconds(0);
+                return std::chrono::duration_cast<std::chrono::microseconds>(it->second.srtt);
+            }
+
+            /**
+             * @brief Get the number of reliable messages waiting for an ack
+             *
+             * @param endpoint The endpoint
+             * @return size_t
+             */
+            size_t GetPendingReliable(const asio::ip::udp::endpoint& endpoint) {
+                std::scoped_lock lock(mutex_);
+                auto it = peers_.find(endpoint);
+                return it == peers_.end() ? 0 : it->second.pending.size();
+            }
+
+           private:
+            static constexpr uint8_t HasAckFlag = 0x80;
+            static constexpr uint8_t KindMask = 0x7F;
+            static constexpr uint8_t AckOnlyKind = 0x7F;
+            static constexpr uint32_t ImmediateAckThreshold = 16;
+            static constexpr std::chrono::milliseconds MinRetransmitTimeout{20};
+            static constexpr std::chrono::milliseconds MaxRetransmitTimeout{1000};
+
+            struct SentPacket {
+                uint16_t sequence = 0;
+                bool acked = true;
+                bool reliable = false;
+                uint16_t messageSequence = 0;
+                Clock::time_point sentAt;
+            };
+
+            struct PendingMessage {
+                std::vector<uint8_t> payload;
+                Clock::time_point lastSent;
+                uint32_t retries = 0;
+            };
+
+            struct Peer {
+                // Outgoing
+                uint16_t packetSequence = 0;
+                uint16_t sequencedOut = 0;
+                uint16_t reliableOut = 0;
+                std::array<SentPacket, SentHistorySize> sent{};
+                std::unordered_map<uint16_t, PendingMessage> pending;
+
+                // Incoming
+                bool hasReceived = false;
+                uint16_t remoteSequence = 0;
+                uint32_t ackBits = 0;
+                bool ackPending = false;
+                uint32_t receivedSinceAck = 0;
+                bool hasSequencedIn = false;
+                uint16_t sequencedIn = 0;
+                uint16_t reliableIn = 0;
+                std::unordered_map<uint16_t, std::vector<uint8_t>> outOfOrder;
+                Clock::time_point lastReceived = Clock::now();
+
+                // Round trip time estimation (RFC 6298)
+                bool hasRtt = false;
+                std::chrono::duration<double> srtt{0};
+                std::chrono::duration<double> rttvar{0};
+                Clock::duration rto = std::chrono::milliseconds(200);
+            };
+
+            Peer* FindOrAddPeer(const asio::ip::udp::endpoint& endpoint) {
+                auto it = peers_.find(endpoint);
+                if (it != peers_.end())
+                    return &it->second;
+                if (peers_.size() >= maxPeers_)
+                    return nullptr;
+                return &peers_[endpoint];
+            }
+
+            static bool SequenceGreater(uint16_t a, uint16_t b) {
+                return a != b && uint16_t(a - b) < 0x8000;
+            }
+
+            std::vector<uint8_t> BuildPacket(Peer& peer, uint8_t kind, uint16_t messageSequence, const void* data, size_t size) {
+                std::vector<uint8_t> packet(HeaderSize + size);
+                uint16_t sequence = peer.packetSequence;
+
+                if (kind != AckOnlyKind) {
+                    auto& sent = peer.sent[sequence % SentHistorySize];
+                    sent.sequence = sequence;
+                    sent.acked = false;
+                    sent.reliable = kind == static_cast<uint8_t>(UdpChannel::ReliableOrdered);
+                    sent.messageSequence = messageSequence;
+                    sent.sentAt = Clock::now();
+                    peer.packetSequence++;
+                }
+
+                packet[0] = PacketMarker;
+                packet[1] = kind | (peer.hasReceived ? HasAckFlag : 0);
+                WireCodec<uint16_t>::encode(packet.data() + 2, sequence);
+                WireCodec<uint16_t>::encode(packet.data() + 4, peer.remoteSequence);
+                WireCodec<uint32_t>::encode(packet.data() + 6, peer.ackBits);
+                WireCodec<uint16_t>::encode(packet.data() + 10, messageSequence);
+                if (size > 0)
+                    std::memcpy(packet.data() + HeaderSize, data, size);
+
+                peer.ackPending = false;
+                peer.receivedSinceAck = 0;
+                return packet;
+            }
+
+            static void RecordReceived(Peer& peer, uint16_t sequence) {
+                peer.ackPending = true;
+                peer.receivedSinceAck++;
+
+                if (!peer.hasReceived) {
+                    peer.hasReceived = true;
+                    peer.remoteSequence = sequence;
+                    peer.ackBits = 0;
+                } else if (SequenceGreater(sequence, peer.remoteSequence)) {
+                    uint16_t shift = sequence - peer.remoteSequence;
+                    peer.ackBits = shift < 32 ? peer.ackBits << shift : 0;
+                    if (shift <= 32)
+                        peer.ackBits |= 1u << (shift - 1);
+                    peer.remoteSequence = sequence;
+                } else {
+                    uint16_t distance = peer.remoteSequence - sequence;
+                    if (distance >= 1 && distance <= 32)
+                        peer.ackBits |= 1u << (distance - 1);
+                }
+            }
+
+            static void ProcessAcks(Peer& peer, uint16_t ack, uint32_t ackBits) {
+                auto now = Clock::now();
+
+                for (uint16_t i = 0; i <= 32; i++) {
+                    if (i > 0 && !(ackBits & (1u << (i - 1))))
+                        continue;
+
+                    uint16_t sequence = ack - i;
+                    auto& sent = peer.sent[sequence % SentHistorySize];
+                    if (sent.acked || sent.sequence != sequence)
+                        continue;
+
+                    sent.acked = true;
+                    if (sent.reliable)
+                        peer.pending.erase(sent.messageSequence);
+                    // Packets only covered by the bitfield may have been acked late, skip them
+                    if (i == 0)
+                        SampleRtt(peer, now - sent.sentAt);
+                }
+            }
+
+            static void SampleRtt(Peer& peer, std::chrono::duration<double> sample) {
+                if (!peer.hasRtt) {
+                    peer.hasRtt = true;
+                    peer.srtt = sample;
+                    peer.rttvar = sample / 2;
+                } else {
+                    auto delta = peer.srtt > sample ? peer.srtt - sample : sample - peer.srtt;
+                    peer.rttvar = peer.rttvar * 0.75 + delta * 0.25;
+                    peer.srtt = peer.srtt * 0.875 + sample * 0.125;
+                }
+                auto rto = std::chrono::duration_cast<Clock::duration>(peer.srtt + peer.rttvar * 4);
+                peer.rto = std::clamp<Clock::duration>(rto, MinRetransmitTimeout, MaxRetransmitTimeout);
+            }
+
+            void ArmTimer() {
+                auto self = this->shared_from_this();
+                timer_.expires_after(period_);
+                timer_.async_wait([this, self](std::error_code ec) {
+                    if (ec || !running_)
+                        return;
+                    Update();
+                    ArmTimer();
+                });
+            }
+
+            UdpConnection& connection_;  ///< Connection the datagrams go through
+            MessageHandler handler_;     ///< Delivered message handler
+
+            std::mutex mutex_;                                                          ///< Protects peers_
+            std::unordered_map<asio::ip::udp::endpoint, Peer, UdpEndpointHash> peers_;  ///< Per endpoint state
+            size_t maxPeers_ = DefaultMaxPeers;                                         ///< Endpoints tracked at once
+            Clock::duration idleTimeout_ = std::chrono::seconds(10);                    ///< Silence after which an endpoint is forgotten
+            uint32_t maxRetransmits_ = DefaultMaxRetransmits;                           ///< Resends before an endpoint is given up
+            PeerLostHandler peerLostHandler_;                                           ///< Called for every forgotten endpoint
+
+            asio::steady_timer timer_;              ///< Update timer
+            std::chrono::milliseconds period_{10};  ///< Update period
+            std::atomic<bool> running_ = false;     ///< Whether the update timer is armed
+        };
+    }  // namespace net
+}  // namespace RType
@@ -61,14 +61,14 @@ namespace RType {
 
                 socket_.bind(asio::ip::udp::endpoint(endpoint_.protocol(), 0));
 
-                receiveBuffer_.resize(1024);
-                receiveBufferLimit_ = 4096;
+                AllocateReceiveSlabs();
 
                 bytesSending_ = 0;
                 bytesSent_ = 0;
                 bytesReceived_ = 0;
                 datagramsSent_ = 0;
                 datagramsReceived_ = 0;
+                datagramsDropped_ = 0;
 
                 connected_ = true;
 
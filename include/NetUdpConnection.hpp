@@ -11,10 +11,31 @@
 
 #pragma once
 
+#include "NetBodyPool.hpp"
 #include "NetCommon.hpp"
+#include "NetHeartbeat.hpp"
 
 namespace RType {
     namespace net {
+        /**
+         * @brief Hash of an UDP endpoint, mixes the address and the port
+         */
+        struct UdpEndpointHash {
+            size_t operator()(const asio::ip::udp::endpoint& endpoint) const noexcept {
+                uint64_t key = endpoint.port();
+                if (endpoint.address().is_v4()) {
+                    key |= uint64_t(endpoint.address().to_v4().to_uint()) << 16;
+                } else {
+                    for (auto byte : endpoint.address().to_v6().to_bytes())
+                        key = key * 0x100000001B3ULL ^ byte;
+                }
+                // splitmix64 finalizer
+                key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+                return static_cast<size_t>(key ^ (key >> 31));
+            }
+        };
+
         /**
          * @brief Abstract class for an UDP connection
          *
@@ -110,22 +131,53 @@ namespace RType {
             /**
              * @brief Send datagram (asynchronous)
              *
+             * The datagram is copied into a pooled buffer and queued, so the caller's buffer
+             * can be reused right away. Queued datagrams are sent back to back by the
+             * completion handler on the io thread.
+             *
              * @param endpoint The endpoint to send to
              * @param buffer The buffer to send
              * @param size The size of the buffer
-             * @return true
-             * @return false
+             * @return true if the datagram was queued
+             * @return false if the connection is down or the send queue is full
              */
             bool SendAsync(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) {
-                if (sending_) {
+                if (!IsConnected()) {
+                    return false;
+                }
+
+                if (size == 0) {
                     return false;
                 }
 
+                assert((buffer != nullptr) && "Pointer to the buffer should not be null!");
+                if (buffer == nullptr) {
+                    return false;
+                }
+
+                return QueueDatagrams(endpoint, static_cast<const uint8_t*>(buffer), size, size);
+            }
+
+            /**
+             * @brief Send a buffer split into datagrams of segmentSize bytes (asynchronous)
+             *
+             * With GSO on (see EnableSegmentationOffload) the kernel does the split and the
+             * whole buffer goes down in one system call, otherwise every segment is queued
+             * as its own datagram. Only the last segment may be shorter.
+             *
+             * @param endpoint The endpoint to send to
+             * @param buffer The buffer to send
+             * @param size The size of the buffer
+             * @param segmentSize The size of each datagram
+             * @return true if every segment was queued
+             * @return false if the connection is down or the send queue is full
+             */
+            bool SendSegmentsAsync(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size, size_t segmentSize) {
                 if (!IsConnected()) {
                     return false;
                 }
 
-                if (size == 0) {
+                if (size == 0 || segmentSize == 0) {
                     return false;
                 }
 
@@ -134,34 +186,106 @@ namespace RType {
                     return false;
                 }
 
-                sending_ = true;
-                bytesSending_ = size;
+                return QueueDatagrams(endpoint, static_cast<const uint8_t*>(buffer), size, segmentSize);
+            }
 
-                auto self = this->shared_from_this();
-                auto sendHandler = [this, self](std::error_code ec, size_t sent) {
-                    sending_ = false;
+            /**
+             * @brief Turn on UDP segmentation offload (GSO and GRO), the socket must be open
+             *
+             * GSO lets SendSegmentsAsync hand one buffer to the kernel, GRO lets the kernel
+             * hand back several datagrams from the same sender at once, which ReceiveAsync
+             * splits again before calling onReceived. Each one is only turned on if the
+             * kernel accepts it, the regular paths are used otherwise. Call it before the
+             * first ReceiveAsync, e.g. in onStarted. Linux only.
+             *
+             * @return true if GSO or GRO is on
+             * @return false otherwise
+             */
+            bool EnableSegmentationOffload() {
+#if defined(__linux__) && defined(UDP_SEGMENT) && defined(UDP_GRO)
+                if (!socket_.is_open()) {
+                    std::cout << "[UDP] Segmentation offload needs an open socket" << std::endl;
+                    return false;
+                }
 
-                    if (!this->IsConnected()) {
-                        return;
-                    }
+                int off = 0;
+                gsoEnabled_ = ::setsockopt(socket_.native_handle(), IPPROTO_UDP, UDP_SEGMENT, &off, sizeof(off)) == 0;
 
-                    if (sent > 0) {
-                        bytesSending_ = 0;
-                        ++datagramsSent_;
-                        bytesSent_ += sent;
+                if (SupportsReceiveOffload()) {
+                    int on = 1;
+                    groEnabled_ = ::setsockopt(socket_.native_handle(), IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+                    if (groEnabled_)
+                        coalescedBuffer_.resize(MaxOffloadSize);
+                }
+                return gsoEnabled_ || groEnabled_;
+#else
+                std::cout << "[UDP] Segmentation offload is only available on Linux" << std::endl;
+                return false;
+#endif
+            }
 
-                        onSent(endpoint_, sent);
-                    }
+            /**
+             * @brief Get whether sends are segmented by the kernel
+             *
+             * @return true
+             * @return false
+             */
+            [[nodiscard]] bool IsGsoEnabled() const noexcept { return gsoEnabled_; }
+            /**
+             * @brief Get whether coalesced datagrams are received
+             *
+             * @return true
+             * @return false
+             */
+            [[nodiscard]] bool IsGroEnabled() const noexcept { return groEnabled_; }
 
-                    if (ec) {
-                        SendError(ec);
+            static constexpr size_t MaxGsoSegments = 64;      ///< Most segments the kernel accepts in one GSO send
+            static constexpr size_t MaxOffloadSize = 65535;   ///< Largest GRO receive
+            static constexpr size_t MaxGsoPayloadV4 = 65507;  ///< Largest GSO send to an IPv4 endpoint, 65535 minus the IPv4 and UDP headers
+            static constexpr size_t MaxGsoPayloadV6 = 65527;  ///< Largest GSO send to an IPv6 endpoint, 65535 minus the UDP header
+
+            /**
+             * @brief Answer the heartbeat pings of the peer with a pong
+             *
+             * Heartbeat datagrams (see Heartbeat) are then consumed and never reach onReceived.
+             * Turn it on for a client talking to a server that has heartbeats enabled.
+             */
+            void AnswerHeartbeats(bool enable = true) noexcept { answerHeartbeats_ = enable; }
+
+            /**
+             * @brief Start sending the queued datagrams
+             *
+             * Only needed when sends are deferred (see UdpServerInterface::EnableBatchedIo),
+             * otherwise SendAsync already starts sending on its own.
+             */
+            void Flush() {
+                {
+                    std::scoped_lock lock(sendMutex_);
+                    if (sending_ || sendQueue_.empty() || !IsConnected()) {
                         return;
                     }
-                };
+                    sending_ = true;
+                }
 
-                socket_.async_send_to(asio::buffer(buffer, size), endpoint, 0, sendHandler);
+                auto self = this->shared_from_this();
+                asio::post(context_, [this, self]() { SendNext(); });
+            }
 
-                return true;
+            /**
+             * @brief Set the maximum number of datagrams waiting in the send queue
+             *
+             * @param limit The limit
+             */
+            void SetSendQueueLimit(size_t limit) noexcept { sendQueueLimit_ = limit; }
+
+            /**
+             * @brief Get the number of datagrams waiting in the send queue
+             *
+             * @return size_t
+             */
+            [[nodiscard]] size_t GetSendQueueSize() {
+                std::scoped_lock lock(sendMutex_);
+                return sendQueue_.size();
             }
 
             /**
@@ -204,7 +328,7 @@ namespace RType {
                 ++datagramsReceived_;
                 bytesReceived_ += received;
 
-                onReceived(endpoint, buffer, received);
+                DispatchReceived(endpoint, buffer, received);
 
                 if (ec) {
                     SendError(ec);
@@ -217,51 +341,47 @@ namespace RType {
             /**
              * @brief Receive datagram from the client (asynchronous)
              *
+             * Keeps up to the configured number of receives in flight (see SetReceiveSlabs),
+             * each one into its own slab. Call it again from onReceived to keep receiving.
              */
-            void ReceiveAsync() {
-                if (receiving_) {
-                    std::cout << "[UDP] Connection is already receiving a message" << std::endl;
-                    return;
-                }
-
+            virtual void ReceiveAsync() {
                 if (!this->IsConnected()) {
                     std::cout << "[UDP] Connection is not active" << std::endl;
                     return;
                 }
 
-                receiving_ = true;
-                auto self = this->shared_from_this();
-                auto receiveHandler = [this, self](std::error_code ec, size_t received) {
-                    receiving_ = false;
-
-                    if (!IsConnected())
-                        return;
-
-                    // Disconnect on error
-                    if (ec) {
-                        SendError(ec);
-                        DisconnectInternalAsync(true);
+#if defined(__linux__) && defined(UDP_GRO)
+                if (groEnabled_) {
+                    if (receiving_) {
+                        // Expected when called for each segment of a coalesced datagram
+                        if (!splitting_)
+                            std::cout << "[UDP] Connection is already receiving a message" << std::endl;
                         return;
                     }
+                    ReceiveCoalescedAsync();
+                    return;
+                }
+#endif
 
-                    ++datagramsReceived_;
-                    bytesReceived_ += received;
-
-                    onReceived(endpoint_, receiveBuffer_.data(), received);
-
-                    if (receiveBuffer_.size() == received) {
-                        // Check the reception buffer limit
-                        if (((2 * received) > receiveBufferLimit_) && (receiveBufferLimit_ > 0)) {
-                            SendError(asio::error::no_buffer_space);
-                            DisconnectInternalAsync(true);
-                            return;
-                        }
-
-                        receiveBuffer_.resize(2 * received);
-                    }
-                };
+                // A slab still in onReceived is re-armed once the callback returns
+                rearmReceive_ = true;
+                while (!freeSlabs_.empty())
+                    ReceiveIntoSlab(freeSlabs_.back());
+            }
 
-                socket_.async_receive_from(asio::buffer(receiveBuffer_.data(), receiveBuffer_.size()), endpoint_, receiveHandler);
+            /**
+             * @brief Set the receive slabs, must be called before the socket is opened
+             *
+             * @param outstanding Number of receives kept in flight
+             * @param slabSize Largest datagram accepted, bigger ones are dropped and counted
+             */
+            void SetReceiveSlabs(size_t outstanding, size_t slabSize) {
+                if (socket_.is_open()) {
+                    std::cout << "[UDP] Receive slabs must be set before opening the socket" << std::endl;
+                    return;
+                }
+                receiveOutstanding_ = std::max<size_t>(outstanding, 1);
+                receiveBufferLimit_ = std::max<size_t>(slabSize, 1);
             }
 
             /**
@@ -291,13 +411,13 @@ namespace RType {
             [[nodiscard]] asio::ip::udp::endpoint& GetEndpoint() noexcept { return endpoint_; }
 
             /**
-             * @brief Get the Receive Buffer object
+             * @brief Get the Receive Buffer object, which holds every receive slab
              *
              * @return std::vector<uint8_t>&
              */
             [[nodiscard]] std::vector<uint8_t>& GetReceiveBuffer() noexcept { return receiveBuffer_; }
             /**
-             * @brief Get the Receive Buffer Limit object
+             * @brief Get the Receive Buffer Limit object, the size of a slab
              *
              * @return size_t
              */
@@ -340,6 +460,12 @@ namespace RType {
              * @return uint64_t
              */
             [[nodiscard]] uint64_t GetDatagramsReceived() const noexcept { return datagramsReceived_; }
+            /**
+             * @brief Get the number of datagrams dropped because they did not fit a slab
+             *
+             * @return uint64_t
+             */
+            [[nodiscard]] uint64_t GetDatagramsDropped() const noexcept { return datagramsDropped_; }
 
             /**
              * @brief Get the Sending object
@@ -402,11 +528,42 @@ namespace RType {
             std::atomic<bool> resolving_ = false;  ///< Resolve flag
             std::atomic<bool> connected_ = false;  ///< Connected flag
 
-            std::vector<uint8_t> receiveBuffer_;  ///< Receive buffer
-            size_t receiveBufferLimit_{0};        ///< Receive buffer limit
-
-            bool sending_ = false;    ///< Sending flag
-            bool receiving_ = false;  ///< Receiving flag
+            std::vector<uint8_t> receiveBuffer_;  ///< Receive slabs, each one is receiveBufferLimit_ + 1 bytes
+            size_t receiveBufferLimit_{1500};     ///< Slab size, bigger datagrams are dropped
+            size_t receiveOutstanding_{4};        ///< Number of receives kept in flight
+
+            /// Receive slab, owned by one in-flight receive or by onReceived
+            struct ReceiveSlab {
+                asio::ip::udp::endpoint endpoint;  ///< Sender of the datagram
+                uint8_t* data = nullptr;           ///< Start of the slab in receiveBuffer_
+            };
+
+            std::vector<ReceiveSlab> receiveSlabs_;  ///< Every slab
+            std::vector<size_t> freeSlabs_;          ///< Slabs that are neither in flight nor in onReceived
+            bool rearmReceive_ = false;              ///< ReceiveAsync was called, re-arm slabs once returned
+            uint32_t receiveGeneration_ = 0;         ///< Bumped when the slabs are reallocated
+
+            std::atomic<bool> sending_ = false;  ///< Sending flag
+            bool receiving_ = false;             ///< Receiving flag
+
+            /// Datagram waiting in the send queue
+            struct QueuedDatagram {
+                asio::ip::udp::endpoint endpoint;                   ///< Destination
+                std::vector<uint8_t, PoolAllocator<uint8_t>> data;  ///< Owned copy of the datagram
+                uint16_t segmentSize = 0;                           ///< GSO segment size, 0 for a single datagram
+            };
+
+            std::mutex sendMutex_;                  ///< Protects the send queue
+            std::deque<QueuedDatagram> sendQueue_;  ///< Datagrams waiting to be sent, the front one is in flight
+            uint32_t sendGeneration_ = 0;           ///< Bumped when the send queue is cleared, stale completions are ignored
+            size_t sendQueueLimit_ = 4096;          ///< Maximum number of queued datagrams
+            bool deferSend_ = false;                ///< SendAsync only queues, Flush starts sending
+            bool answerHeartbeats_ = false;         ///< Pings are answered and heartbeats kept from onReceived
+
+            std::atomic<bool> gsoEnabled_ = false;  ///< Sends may carry several segments
+            bool groEnabled_ = false;               ///< Receives may carry several segments
+            bool splitting_ = false;                ///< Calling onReceived for the segments of a coalesced datagram
+            std::vector<uint8_t> coalescedBuffer_;  ///< Receive buffer for coalesced datagrams
 
             // Transfer statistic
             uint64_t bytesSending_;       ///< Bytes sending
@@ -414,6 +571,7 @@ namespace RType {
             uint64_t bytesReceived_;      ///< Bytes received
             uint64_t datagramsSent_;      ///< Datagrams sent
             uint64_t datagramsReceived_;  ///< Datagrams received
+            uint64_t datagramsDropped_{0};  ///< Oversized datagrams dropped
 
             /**
              * @brief Disconnect the client (internal)
@@ -436,6 +594,10 @@ namespace RType {
                 receiving_ = false;
                 sending_ = false;
 
+                // Socket options are gone with the socket
+                gsoEnabled_ = false;
+                groEnabled_ = false;
+
                 // Clear send/receive buffers
                 ClearBuffers();
 
@@ -462,13 +624,395 @@ namespace RType {
                 return true;
             }
 
+            /**
+             * @brief Allocate the receive slabs, called when the socket is opened
+             */
+            void AllocateReceiveSlabs() {
+                size_t stride = receiveBufferLimit_ + 1;
+                receiveBuffer_.assign(receiveOutstanding_ * stride, 0);
+                receiveSlabs_.assign(receiveOutstanding_, ReceiveSlab());
+                freeSlabs_.clear();
+                for (size_t i = receiveOutstanding_; i-- > 0;) {
+                    receiveSlabs_[i].data = receiveBuffer_.data() + i * stride;
+                    freeSlabs_.push_back(i);
+                }
+                rearmReceive_ = false;
+                receiving_ = false;
+                receiveGeneration_++;
+            }
+
+            /**
+             * @brief Start a receive into a free slab
+             *
+             * The slab is one byte bigger than receiveBufferLimit_, a datagram that fills it
+             * is oversized and gets dropped.
+             */
+            void ReceiveIntoSlab(size_t index) {
+                freeSlabs_.erase(std::find(freeSlabs_.begin(), freeSlabs_.end(), index));
+                receiving_ = true;
+
+                auto self = this->shared_from_this();
+                auto receiveHandler = [this, self, index, generation = receiveGeneration_](std::error_code ec, size_t received) {
+                    if (generation != receiveGeneration_ || !IsConnected())
+                        return;
+
+                    ReceiveSlab& slab = receiveSlabs_[index];
+                    if (ec) {
+                        freeSlabs_.push_back(index);
+                        receiving_ = freeSlabs_.size() < receiveSlabs_.size();
+                        // Disconnect on error
+                        SendError(ec);
+                        DisconnectInternalAsync(true);
+                        return;
+                    }
+
+                    if (received > receiveBufferLimit_) {
+                        // Oversized, drop it and receive again into the same slab
+                        ++datagramsDropped_;
+                        freeSlabs_.push_back(index);
+                        ReceiveIntoSlab(index);
+                        return;
+                    }
+
+                    ++datagramsReceived_;
+                    bytesReceived_ += received;
+
+                    endpoint_ = slab.endpoint;
+                    rearmReceive_ = false;
+                    DispatchReceived(slab.endpoint, slab.data, received);
+                    if (!IsConnected() || generation != receiveGeneration_)
+                        return;
+
+                    // The slab is back in the pool once onReceived returned
+                    freeSlabs_.push_back(index);
+                    receiving_ = freeSlabs_.size() < receiveSlabs_.size();
+                    if (rearmReceive_)
+                        ReceiveAsync();
+                };
+
+                socket_.async_receive_from(asio::buffer(receiveSlabs_[index].data, receiveBufferLimit_ + 1), receiveSlabs_[index].endpoint, receiveHandler);
+            }
+
+            /**
+             * @brief Hands a received datagram to onReceived, every receive path goes through it
+             *
+             * @param endpoint The endpoint of the received datagram
+             * @param buffer The buffer of the received datagram
+             * @param size The size of the received datagram
+             */
+            virtual void DispatchReceived(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) {
+                Heartbeat beat;
+                if (answerHeartbeats_ && Heartbeat::Decode(buffer, size, beat)) {
+                    if (beat.kind == Heartbeat::Kind::Ping)
+                        SendHeartbeat(endpoint, {Heartbeat::Kind::Pong, beat.timestamp});
+                    // onReceived usually re-arms the receive, do it in its place
+                    ReceiveAsync();
+                    return;
+                }
+                onReceived(endpoint, buffer, size);
+            }
+
+            /**
+             * @brief Queue a heartbeat for endpoint
+             */
+            bool SendHeartbeat(const asio::ip::udp::endpoint& endpoint, const Heartbeat& beat) {
+                uint8_t datagram[Heartbeat::Size];
+                beat.Encode(datagram);
+                return SendAsync(endpoint, datagram, sizeof(datagram));
+            }
+
+            /**
+             * @brief Whether GRO may be turned on, false when another receive path reads the socket
+             */
+            virtual bool SupportsReceiveOffload() const { return true; }
+
+            /**
+             * @brief Queue a buffer as datagrams of segmentSize bytes and start sending
+             *
+             * With GSO on, up to MaxGsoSegments segments share a single queue entry,
+             * as long as the entry fits in one UDP payload of the endpoint's IP version.
+             */
+            bool QueueDatagrams(const asio::ip::udp::endpoint& endpoint, const uint8_t* data, size_t size, size_t segmentSize) {
+                const auto& address = endpoint.address();
+                size_t maxPayload = address.is_v6() && !address.to_v6().is_v4_mapped() ? MaxGsoPayloadV6 : MaxGsoPayloadV4;
+                size_t entrySize = segmentSize;
+                if (gsoEnabled_ && segmentSize < size && segmentSize <= maxPayload)
+                    entrySize = segmentSize * std::min(MaxGsoSegments, maxPayload / segmentSize);
+                size_t entries = (size + entrySize - 1) / entrySize;
+
+                {
+                    std::scoped_lock lock(sendMutex_);
+                    if (sendQueue_.size() + entries > sendQueueLimit_) {
+                        return false;
+                    }
+
+                    for (size_t offset = 0; offset < size; offset += entrySize) {
+                        size_t chunk = std::min(entrySize, size - offset);
+                        auto& datagram = sendQueue_.emplace_back();
+                        datagram.endpoint = endpoint;
+                        datagram.data.assign(data + offset, data + offset + chunk);
+                        datagram.segmentSize = chunk > segmentSize ? static_cast<uint16_t>(segmentSize) : 0;
+                        bytesSending_ += chunk;
+                    }
+
+                    if (sending_ || deferSend_) {
+                        return true;
+                    }
+                    sending_ = true;
+                }
+
+                auto self = this->shared_from_this();
+                asio::post(context_, [this, self]() { SendNext(); });
+
+                return true;
+            }
+
+            /**
+             * @brief Sends the datagram at the front of the send queue, called on the io thread
+             */
+            virtual void SendNext() {
+                QueuedDatagram* datagram;
+                uint32_t generation;
+                {
+                    std::scoped_lock lock(sendMutex_);
+                    if (sendQueue_.empty() || !IsConnected()) {
+                        sending_ = false;
+                        return;
+                    }
+                    // References to deque elements survive push_back, so the front stays valid
+                    datagram = &sendQueue_.front();
+                    generation = sendGeneration_;
+                }
+
+#if defined(__linux__) && defined(UDP_SEGMENT)
+                if (datagram->segmentSize > 0) {
+                    SendSegmented(*datagram, generation);
+                    return;
+                }
+#endif
+
+                auto self = this->shared_from_this();
+                auto sendHandler = [this, self, generation](std::error_code ec, size_t sent) {
+                    asio::ip::udp::endpoint endpoint;
+                    {
+                        std::scoped_lock lock(sendMutex_);
+                        // The queue was cleared by a disconnect, the front belongs to a later connection
+                        if (generation != sendGeneration_ || sendQueue_.empty())
+                            return;
+                        endpoint = sendQueue_.front().endpoint;
+                        bytesSending_ -= sendQueue_.front().data.size();
+                        sendQueue_.pop_front();
+                    }
+
+                    if (sent > 0) {
+                        ++datagramsSent_;
+                        bytesSent_ += sent;
+
+                        onSent(endpoint, sent);
+                    }
+
+                    if (ec) {
+                        SendError(ec);
+                    }
+
+                    SendNext();
+                };
+
+                socket_.async_send_to(asio::buffer(datagram->data.data(), datagram->data.size()), datagram->endpoint, 0, sendHandler);
+            }
+
+#if defined(__linux__) && defined(UDP_SEGMENT)
+            /**
+             * @brief Sends a queued GSO datagram with sendmsg, called on the io thread
+             *
+             * Falls back to sending the segments one by one if the kernel refuses it,
+             * GSO stays on when it only refused the size of this entry (EMSGSIZE).
+             */
+            void SendSegmented(QueuedDatagram& datagram, uint32_t generation) {
+                iovec iov{datagram.data.data(), datagram.data.size()};
+                alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+
+                msghdr msg{};
+                msg.msg_name = datagram.endpoint.data();
+                msg.msg_namelen = static_cast<socklen_t>(datagram.endpoint.size());
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control;
+                msg.msg_controllen = sizeof(control);
+
+                cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+                cmsg->cmsg_level = IPPROTO_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                std::memcpy(CMSG_DATA(cmsg), &datagram.segmentSize, sizeof(uint16_t));
+
+                auto self = this->shared_from_this();
+                ssize_t sent = ::sendmsg(socket_.native_handle(), &msg, MSG_DONTWAIT);
+                if (sent < 0) {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        // Socket buffer is full, resume once it is writable again
+                        socket_.async_wait(asio::ip::udp::socket::wait_write, [this, self, generation](std::error_code ec) {
+                            {
+                                std::scoped_lock lock(sendMutex_);
+                                if (generation != sendGeneration_)
+                                    return;
+                                if (ec) {
+                                    sending_ = false;
+                                    return;
+                                }
+                            }
+                            SendNext();
+                        });
+                        return;
+                    }
+
+                    int error = errno;
+                    std::scoped_lock lock(sendMutex_);
+                    if (generation != sendGeneration_)
+                        return;
+                    if (error == EMSGSIZE || error == EIO || error == EINVAL || error == ENOPROTOOPT || error == EOPNOTSUPP) {
+                        // No GSO on this route, or an entry too big for it, replace the entry by its segments
+                        if (error != EMSGSIZE)
+                            gsoEnabled_ = false;
+                        QueuedDatagram coalesced = std::move(sendQueue_.front());
+                        sendQueue_.pop_front();
+                        size_t segmentSize = coalesced.segmentSize;
+                        size_t count = (coalesced.data.size() + segmentSize - 1) / segmentSize;
+                        for (size_t i = count; i-- > 0;) {
+                            size_t offset = i * segmentSize;
+                            size_t chunk = std::min(segmentSize, coalesced.data.size() - offset);
+                            auto& segment = *sendQueue_.emplace(sendQueue_.begin());
+                            segment.endpoint = coalesced.endpoint;
+                            segment.data.assign(coalesced.data.data() + offset, coalesced.data.data() + offset + chunk);
+                        }
+                    } else {
+                        SendError(std::error_code(error, std::system_category()));
+                        bytesSending_ -= sendQueue_.front().data.size();
+                        sendQueue_.pop_front();
+                    }
+                } else {
+                    asio::ip::udp::endpoint endpoint;
+                    size_t segmentSize;
+                    {
+                        std::scoped_lock lock(sendMutex_);
+                        if (generation != sendGeneration_)
+                            return;
+                        endpoint = sendQueue_.front().endpoint;
+                        segmentSize = sendQueue_.front().segmentSize;
+                        bytesSending_ -= sendQueue_.front().data.size();
+                        sendQueue_.pop_front();
+                    }
+
+                    for (size_t offset = 0; offset < static_cast<size_t>(sent); offset += segmentSize) {
+                        size_t size = std::min(segmentSize, static_cast<size_t>(sent) - offset);
+                        ++datagramsSent_;
+                        bytesSent_ += size;
+
+                        onSent(endpoint, size);
+                    }
+                }
+
+                asio::post(context_, [this, self]() { SendNext(); });
+            }
+#endif
+
+#if defined(__linux__) && defined(UDP_GRO)
+            /**
+             * @brief Receives with recvmsg to learn the GRO segment size, then splits the buffer
+             *
+             * Segments bigger than receiveBufferLimit_ are dropped and counted like on the slab path.
+             */
+            void ReceiveCoalescedAsync() {
+                receiving_ = true;
+                auto self = this->shared_from_this();
+                socket_.async_wait(asio::ip::udp::socket::wait_read, [this, self](std::error_code ec) {
+                    receiving_ = false;
+
+                    if (!IsConnected())
+                        return;
+
+                    if (ec) {
+                        SendError(ec);
+                        DisconnectInternalAsync(true);
+                        return;
+                    }
+
+                    iovec iov{coalescedBuffer_.data(), coalescedBuffer_.size()};
+                    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+                    msghdr msg{};
+                    msg.msg_name = endpoint_.data();
+                    msg.msg_namelen = static_cast<socklen_t>(endpoint_.capacity());
+                    msg.msg_iov = &iov;
+                    msg.msg_iovlen = 1;
+                    msg.msg_control = control;
+                    msg.msg_controllen = sizeof(control);
+
+                    ssize_t received = ::recvmsg(socket_.native_handle(), &msg, MSG_DONTWAIT);
+                    if (received < 0) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                            ReceiveAsync();
+                            return;
+                        }
+                        SendError(std::error_code(errno, std::system_category()));
+                        DisconnectInternalAsync(true);
+                        return;
+                    }
+                    endpoint_.resize(msg.msg_namelen);
+
+                    if (msg.msg_flags & MSG_TRUNC) {
+                        ++datagramsDropped_;
+                        ReceiveAsync();
+                        return;
+                    }
+
+                    size_t segmentSize = static_cast<size_t>(received);
+                    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                        if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+                            int size;
+                            std::memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+                            if (size > 0)
+                                segmentSize = static_cast<size_t>(size);
+                        }
+                    }
+
+                    bool dispatched = false;
+                    splitting_ = true;
+                    for (size_t offset = 0; offset < static_cast<size_t>(received) && IsConnected(); offset += segmentSize) {
+                        size_t size = std::min(segmentSize, static_cast<size_t>(received) - offset);
+                        if (size > receiveBufferLimit_) {
+                            // Oversized, as on the slab path
+                            ++datagramsDropped_;
+                            continue;
+                        }
+                        ++datagramsReceived_;
+                        bytesReceived_ += size;
+
+                        dispatched = true;
+                        DispatchReceived(endpoint_, coalescedBuffer_.data() + offset, size);
+                    }
+                    splitting_ = false;
+
+                    // Nothing reached onReceived to re-arm the receive
+                    if (!dispatched && IsConnected())
+                        ReceiveAsync();
+                });
+            }
+#endif
+
             /**
              * @brief Clear the send/receive buffers
              *
              */
             void ClearBuffers() {
                 receiveBuffer_.clear();
+                receiveSlabs_.clear();
+                freeSlabs_.clear();
+                receiveGeneration_++;
 
+                std::scoped_lock lock(sendMutex_);
+                sendQueue_.clear();
+                sendGeneration_++;
                 bytesSending_ = 0;
             }
 
@@ -11,12 +11,30 @@
 
 #pragma once
 
+#include <any>
+
 #include "NetCommon.hpp"
+#include "NetFlatMap.hpp"
 #include "NetMessage.hpp"
 #include "NetUdpConnection.hpp"
 
 namespace RType {
     namespace net {
+        /**
+         * @brief State kept by the server for each remote endpoint
+         */
+        struct UdpSession {
+            asio::ip::udp::endpoint endpoint;                ///< Remote endpoint
+            uint32_t id = 0;                                 ///< Session id, unique while the server runs
+            std::chrono::steady_clock::time_point openedAt;  ///< First datagram
+            std::chrono::steady_clock::time_point lastSeen;  ///< Last datagram
+            uint64_t datagramsReceived = 0;                  ///< Datagrams received from the endpoint
+            uint64_t bytesReceived = 0;                      ///< Bytes received from the endpoint
+            RttEstimator rtt;                                ///< Round trip time, measured by the heartbeats
+            uint32_t missedBeats = 0;                        ///< Heartbeats sent since the last answer
+            std::any userData;                               ///< Free for the game, e.g. the player id
+        };
+
         /**
          * @brief UdpServerInterface is the base class for all UDP servers
          */
@@ -50,22 +68,37 @@ namespace RType {
                     }
                     socket_.open(endpoint_.protocol());
 
+#if defined(SO_REUSEPORT)
+                    if (reusePort_) {
+                        int enable = 1;
+                        setsockopt(socket_.native_handle(), SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+                    }
+#endif
                     socket_.bind(endpoint_);
 
                     port_ = socket_.local_endpoint().port();
 
-                    receiveBuffer_.resize(1024);
-                    receiveBufferLimit_ = 4096;
+                    AllocateReceiveSlabs();
+#if defined(__linux__)
+                    if (batchSize_ > 0)
+                        receiveSlab_.assign(batchSize_ * receiveBufferLimit_, 0);
+#endif
 
                     bytesReceived_ = 0;
                     bytesSending_ = 0;
                     bytesSent_ = 0;
                     datagramsReceived_ = 0;
+                    datagramsDropped_ = 0;
                     datagramsSent_ = 0;
 
                     _started = true;
                     connected_ = true;
 
+                    if (sessionTimer_)
+                        ArmSessionTimer();
+                    if (heartbeatTimer_)
+                        ArmHeartbeatTimer();
+
                     onStarted();
                 };
 
@@ -94,6 +127,15 @@ namespace RType {
                     _started = false;
                     receiving_ = false;
                     sending_ = false;
+                    gsoEnabled_ = false;
+                    groEnabled_ = false;
+
+                    if (heartbeatTimer_)
+                        heartbeatTimer_->cancel();
+                    if (sessionTimer_) {
+                        sessionTimer_->cancel();
+                        CloseSessionsIf([](const UdpSession&) { return true; });
+                    }
 
                     onStopped();
                 };
@@ -111,6 +153,174 @@ namespace RType {
              */
             [[nodiscard]] bool IsStarted() const { return _started; }
 
+            /**
+             * @brief Let other sockets bind the same port with SO_REUSEPORT, must be called before Start
+             *
+             * The kernel then spreads the incoming datagrams over every socket bound to
+             * the port, see UdpShardGroup.
+             *
+             * @return true
+             * @return false if SO_REUSEPORT is not available or the server is already started
+             */
+            bool SetReusePort(bool enable) {
+#if defined(SO_REUSEPORT)
+                if (this->IsStarted()) {
+                    std::cout << "[UDP] Reuse port must be set before starting the server" << std::endl;
+                    return false;
+                }
+                reusePort_ = enable;
+                return true;
+#else
+                (void)enable;
+                std::cout << "[UDP] SO_REUSEPORT is not available on this platform" << std::endl;
+                return false;
+#endif
+            }
+
+            /**
+             * @brief Switch to batched datagram I/O, must be called before Start
+             *
+             * ReceiveAsync then waits once for the socket to be readable and drains up
+             * to batchSize datagrams with a single recvmmsg. SendAsync only queues the
+             * datagrams, call Flush once per tick to send all of them with sendmmsg.
+             * Only available on Linux.
+             *
+             * @param batchSize Maximum number of datagrams per system call
+             * @return true if batched I/O is enabled
+             * @return false on other platforms or if the server is already started
+             */
+            bool EnableBatchedIo(size_t batchSize = 32) {
+#if defined(__linux__)
+                if (this->IsStarted()) {
+                    std::cout << "[UDP] Batched I/O must be enabled before starting the server" << std::endl;
+                    return false;
+                }
+                if (batchSize == 0) {
+                    return false;
+                }
+
+                batchSize_ = batchSize;
+                deferSend_ = true;
+
+                receiveAddresses_.resize(batchSize_);
+                receiveIovecs_.resize(batchSize_);
+                receiveHeaders_.resize(batchSize_);
+                sendIovecs_.resize(batchSize_);
+                sendHeaders_.resize(batchSize_);
+                return true;
+#else
+                (void)batchSize;
+                std::cout << "[UDP] Batched I/O is only available on Linux" << std::endl;
+                return false;
+#endif
+            }
+
+            /**
+             * @brief Receive datagrams (asynchronous)
+             *
+             * In batched mode, every datagram of the batch is passed to onReceived, calling
+             * ReceiveAsync again from there arms the next batch.
+             */
+            void ReceiveAsync() override {
+#if defined(__linux__)
+                if (batchSize_ > 0) {
+                    ReceiveBatchAsync();
+                    return;
+                }
+#endif
+                UdpConnection::ReceiveAsync();
+            }
+
+            /**
+             * @brief Track a session per remote endpoint, must be called before Start
+             *
+             * A session is opened by the first datagram of an endpoint and closed once the
+             * endpoint stayed silent for idleTimeout. Sessions only live on the io thread,
+             * use them from onReceived and the session hooks.
+             *
+             * @param idleTimeout Silence after which a session is closed
+             * @param expectedSessions Number of sessions to make room for
+             * @return true
+             * @return false if the server is already started
+             */
+            bool EnableSessions(std::chrono::milliseconds idleTimeout, size_t expectedSessions = 64) {
+                if (this->IsStarted()) {
+                    std::cout << "[UDP] Sessions must be enabled before starting the server" << std::endl;
+                    return false;
+                }
+
+                sessionTimeout_ = idleTimeout;
+                sessions_.reserve(expectedSessions);
+                sessionTimer_ = std::make_unique<asio::steady_timer>(context_);
+                return true;
+            }
+
+            /**
+             * @brief Ping every session, must be called after EnableSessions and before Start
+             *
+             * The pongs feed the RTT of each session (UdpSession::rtt). A session is closed
+             * once maxMissed pings in a row went unanswered. Clients must call AnswerHeartbeats.
+             *
+             * @param interval Time between two pings
+             * @param maxMissed Unanswered pings before a session is closed
+             * @return true
+             * @return false if sessions are off or the server is already started
+             */
+            bool EnableHeartbeat(std::chrono::milliseconds interval = std::chrono::seconds(1), uint32_t maxMissed = 5) {
+                if (this->IsStarted() || !sessionTimer_) {
+                    std::cout << "[UDP] Heartbeats need sessions and must be enabled before starting the server" << std::endl;
+                    return false;
+                }
+
+                heartbeatInterval_ = std::max(interval, std::chrono::milliseconds(1));
+                heartbeatMaxMissed_ = std::max<uint32_t>(maxMissed, 1);
+                heartbeatTimer_ = std::make_unique<asio::steady_timer>(context_);
+                answerHeartbeats_ = true;
+                return true;
+            }
+
+            /**
+             * @brief Get the session of an endpoint
+             *
+             * The pointer is only valid until the next session is opened or closed.
+             *
+             * @param endpoint The remote endpoint
+             * @return UdpSession* The session, nullptr if there is none
+             */
+            [[nodiscard]] UdpSession* GetSession(const asio::ip::udp::endpoint& endpoint) { return sessions_.find(endpoint); }
+
+            /**
+             * @brief Close the session of an endpoint, onSessionClosed is called
+             *
+             * @param endpoint The remote endpoint
+             * @return true if there was a session
+             */
+            bool CloseSession(const asio::ip::udp::endpoint& endpoint) {
+                UdpSession* found = sessions_.find(endpoint);
+                if (found == nullptr)
+                    return false;
+
+                UdpSession session = std::move(*found);
+                sessions_.erase(endpoint);
+                onSessionClosed(session);
+                return true;
+            }
+
+            /**
+             * @brief Call fn(UdpSession&) for every open session
+             */
+            template <typename Function>
+            void ForEachSession(Function&& fn) {
+                sessions_.for_each([&fn](const asio::ip::udp::endpoint&, UdpSession& session) { fn(session); });
+            }
+
+            /**
+             * @brief Get the number of open sessions
+             *
+             * @return size_t
+             */
+            [[nodiscard]] size_t GetSessionCount() const noexcept { return sessions_.size(); }
+
            protected:
             /**
              * @brief onStarted is called when the server is started
@@ -120,8 +330,349 @@ namespace RType {
              * @brief onStopped is called when the server is stopped
              */
             virtual void onStopped() = 0;
+            /**
+             * @brief onSessionOpened is called on the first datagram of an endpoint, before onReceived
+             *
+             * @param session The new session
+             * @return false to refuse the endpoint, its datagram is dropped and it is asked again on the next one
+             */
+            virtual bool onSessionOpened(UdpSession& /* session */) { return true; }
+            /**
+             * @brief onSessionClosed is called when a session times out, is closed or the server stops
+             *
+             * The session is already out of the session map, so the hook may close others.
+             *
+             * @param session The closed session
+             */
+            virtual void onSessionClosed(UdpSession& /* session */) {}
+
+            /**
+             * @brief Updates the session of the sender before calling onReceived
+             */
+            void DispatchReceived(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) override {
+                if (sessionTimer_) {
+                    auto now = std::chrono::steady_clock::now();
+                    auto [session, opened] = sessions_.try_emplace(endpoint);
+                    if (opened) {
+                        session->endpoint = endpoint;
+                        session->id = nextSessionId_++;
+                        session->openedAt = now;
+                        if (!onSessionOpened(*session)) {
+                            // onReceived usually re-arms the receive, do it in its place
+                            sessions_.erase(endpoint);
+                            ReceiveAsync();
+                            return;
+                        }
+                        // onSessionOpened may have opened or closed other sessions
+                        session = sessions_.find(endpoint);
+                        if (session == nullptr)
+                            return;
+                    }
+                    session->lastSeen = now;
+                    session->datagramsReceived++;
+                    session->bytesReceived += size;
+
+                    Heartbeat beat;
+                    if (answerHeartbeats_ && Heartbeat::Decode(buffer, size, beat)) {
+                        if (beat.kind == Heartbeat::Kind::Pong) {
+                            session->missedBeats = 0;
+                            session->rtt.Sample(beat.Age());
+                        } else {
+                            SendHeartbeat(endpoint, {Heartbeat::Kind::Pong, beat.timestamp});
+                        }
+                        ReceiveAsync();
+                        return;
+                    }
+                }
+
+                UdpConnection::DispatchReceived(endpoint, buffer, size);
+            }
+
+#if defined(__linux__)
+            /**
+             * @brief Sends the next batch of queued datagrams with sendmmsg, called on the io thread
+             */
+            void SendNext() override {
+                if (batchSize_ == 0) {
+                    UdpConnection::SendNext();
+                    return;
+                }
+
+                size_t count = 0;
+                uint32_t generation;
+                {
+                    std::unique_lock lock(sendMutex_);
+                    if (sendQueue_.empty() || !IsConnected()) {
+                        sending_ = false;
+                        return;
+                    }
+                    if (sendQueue_.front().segmentSize > 0) {
+                        // GSO datagrams need their own control message
+                        lock.unlock();
+                        UdpConnection::SendNext();
+                        return;
+                    }
+                    generation = sendGeneration_;
+                    // Only the io thread pops, so the queued datagrams stay put while sending
+                    for (auto it = sendQueue_.begin(); it != sendQueue_.end() && it->segmentSize == 0 && count < batchSize_; ++it, ++count) {
+                        sendIovecs_[count].iov_base = it->data.data();
+                        sendIovecs_[count].iov_len = it->data.size();
+                        sendHeaders_[count] = {};
+                        sendHeaders_[count].msg_hdr.msg_name = it->endpoint.data();
+                        sendHeaders_[count].msg_hdr.msg_namelen = static_cast<socklen_t>(it->endpoint.size());
+                        sendHeaders_[count].msg_hdr.msg_iov = &sendIovecs_[count];
+                        sendHeaders_[count].msg_hdr.msg_iovlen = 1;
+                    }
+                }
+
+                int sent = ::sendmmsg(socket_.native_handle(), sendHeaders_.data(), static_cast<unsigned int>(count), MSG_DONTWAIT);
+                if (sent < 0) {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        // Socket buffer is full, resume once it is writable again
+                        auto self = this->shared_from_this();
+                        socket_.async_wait(asio::ip::udp::socket::wait_write, [this, self, generation](std::error_code ec) {
+                            {
+                                std::scoped_lock lock(sendMutex_);
+                                if (generation != sendGeneration_)
+                                    return;
+                                if (ec) {
+                                    sending_ = false;
+                                    return;
+                                }
+                            }
+                            SendNext();
+                        });
+                        return;
+                    }
+                    // Drop the datagram that failed and go on with the others
+                    SendError(std::error_code(errno, std::system_category()));
+                    sent = 1;
+                    sendHeaders_[0].msg_len = 0;
+                }
+
+                sentBatch_.clear();
+                {
+                    std::scoped_lock lock(sendMutex_);
+                    if (generation != sendGeneration_)
+                        return;
+                    for (int i = 0; i < sent; i++) {
+                        sentBatch_.emplace_back(sendQueue_.front().endpoint, sendHeaders_[i].msg_len);
+                        bytesSending_ -= sendQueue_.front().data.size();
+                        sendQueue_.pop_front();
+                    }
+                }
+
+                for (auto& [endpoint, size] : sentBatch_) {
+                    if (size == 0)
+                        continue;
+                    ++datagramsSent_;
+                    bytesSent_ += size;
+
+                    onSent(endpoint, size);
+                }
+
+                // Let the other handlers run before the next batch
+                auto self = this->shared_from_this();
+                asio::post(context_, [this, self]() { SendNext(); });
+            }
+
+            /**
+             * @brief GRO is not used by the recvmmsg path
+             */
+            bool SupportsReceiveOffload() const override { return batchSize_ == 0; }
+#endif
 
            private:
+            /**
+             * @brief Closes every session for which pred(session) returns true
+             *
+             * onSessionClosed is only called once the sweep is over, the hook may then
+             * use the session map freely.
+             */
+            template <typename Predicate>
+            void CloseSessionsIf(Predicate&& pred) {
+                std::vector<UdpSession> closed;
+                closed.swap(closedSessions_);
+                sessions_.erase_if([&pred, &closed](const asio::ip::udp::endpoint&, UdpSession& session) {
+                    if (!pred(static_cast<const UdpSession&>(session)))
+                        return false;
+                    closed.push_back(std::move(session));
+                    return true;
+                });
+
+                for (auto& session : closed)
+                    onSessionClosed(session);
+                // Keep the storage for the next sweep, unless a hook swept meanwhile
+                closed.clear();
+                if (closedSessions_.capacity() < closed.capacity())
+                    closedSessions_.swap(closed);
+            }
+
+            /**
+             * @brief Pings every session, and closes the ones that missed too many pings
+             */
+            void ArmHeartbeatTimer() {
+                heartbeatTimer_->expires_after(heartbeatInterval_);
+
+                auto self = this->shared_from_this();
+                heartbeatTimer_->async_wait([this, self](std::error_code ec) {
+                    if (ec || !this->IsStarted())
+                        return;
+
+                    CloseSessionsIf([this](const UdpSession& session) { return session.missedBeats >= heartbeatMaxMissed_; });
+
+                    Heartbeat ping = Heartbeat::MakePing();
+                    sessions_.for_each([this, &ping](const asio::ip::udp::endpoint& endpoint, UdpSession& session) {
+                        session.missedBeats++;
+                        SendHeartbeat(endpoint, ping);
+                    });
+                    if (deferSend_)
+                        Flush();
+
+                    ArmHeartbeatTimer();
+                });
+            }
+
+            /**
+             * @brief Closes the idle sessions every quarter of the timeout
+             */
+            void ArmSessionTimer() {
+                auto period = std::max<std::chrono::steady_clock::duration>(sessionTimeout_ / 4, std::chrono::milliseconds(10));
+                sessionTimer_->expires_after(period);
+
+                auto self = this->shared_from_this();
+                sessionTimer_->async_wait([this, self](std::error_code ec) {
+                    if (ec || !this->IsStarted())
+                        return;
+
+                    auto deadline = std::chrono::steady_clock::now() - sessionTimeout_;
+                    CloseSessionsIf([deadline](const UdpSession& session) { return session.lastSeen < deadline; });
+
+                    ArmSessionTimer();
+                });
+            }
+
+#if defined(__linux__)
+            /**
+             * @brief Waits for the socket to be readable then drains it with recvmmsg
+             */
+            void ReceiveBatchAsync() {
+                if (draining_) {
+                    // Called from onReceived, the drain loop goes on with the next batch
+                    receiveRequested_ = true;
+                    return;
+                }
+
+                if (receiving_) {
+                    return;
+                }
+
+                if (!this->IsConnected()) {
+                    std::cout << "[UDP] Connection is not active" << std::endl;
+                    return;
+                }
+
+                receiving_ = true;
+                auto self = this->shared_from_this();
+                socket_.async_wait(asio::ip::udp::socket::wait_read, [this, self](std::error_code ec) {
+                    receiving_ = false;
+
+                    if (!IsConnected())
+                        return;
+
+                    if (ec) {
+                        SendError(ec);
+                        DisconnectInternalAsync(true);
+                        return;
+                    }
+
+                    DrainBatches();
+                });
+            }
+
+            /**
+             * @brief Reads full batches until the socket is empty, at most MaxDrainRounds of them
+             *
+             * Stops early if onReceived did not ask for more, then re-arms the wait if it did.
+             */
+            void DrainBatches() {
+                draining_ = true;
+                receiveRequested_ = true;
+
+                for (size_t round = 0; round < MaxDrainRounds && receiveRequested_ && IsConnected(); round++) {
+                    receiveRequested_ = false;
+
+                    for (size_t i = 0; i < batchSize_; i++) {
+                        receiveIovecs_[i].iov_base = receiveSlab_.data() + i * receiveBufferLimit_;
+                        receiveIovecs_[i].iov_len = receiveBufferLimit_;
+                        receiveHeaders_[i] = {};
+                        receiveHeaders_[i].msg_hdr.msg_name = &receiveAddresses_[i];
+                        receiveHeaders_[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+                        receiveHeaders_[i].msg_hdr.msg_iov = &receiveIovecs_[i];
+                        receiveHeaders_[i].msg_hdr.msg_iovlen = 1;
+                    }
+
+                    int received = ::recvmmsg(socket_.native_handle(), receiveHeaders_.data(), static_cast<unsigned int>(batchSize_), MSG_DONTWAIT, nullptr);
+                    if (received < 0) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                            receiveRequested_ = true;
+                            break;
+                        }
+                        draining_ = false;
+                        SendError(std::error_code(errno, std::system_category()));
+                        DisconnectInternalAsync(true);
+                        return;
+                    }
+
+                    for (int i = 0; i < received && IsConnected(); i++) {
+                        auto& header = receiveHeaders_[i];
+                        if (header.msg_hdr.msg_flags & MSG_TRUNC) {
+                            ++datagramsDropped_;
+                            receiveRequested_ = true;
+                            continue;
+                        }
+
+                        std::memcpy(endpoint_.data(), &receiveAddresses_[i], header.msg_hdr.msg_namelen);
+                        endpoint_.resize(header.msg_hdr.msg_namelen);
+
+                        ++datagramsReceived_;
+                        bytesReceived_ += header.msg_len;
+
+                        DispatchReceived(endpoint_, header.msg_hdr.msg_iov->iov_base, header.msg_len);
+                    }
+
+                    if (static_cast<size_t>(received) < batchSize_)
+                        break;
+                }
+
+                draining_ = false;
+                if (receiveRequested_ && IsConnected())
+                    ReceiveBatchAsync();
+            }
+
+            static constexpr size_t MaxDrainRounds = 8;  ///< Batches read per wakeup before yielding to other handlers
+
+            size_t batchSize_ = 0;                                               ///< Datagrams per system call, 0 when batched I/O is off
+            std::vector<uint8_t> receiveSlab_;                                   ///< batchSize_ slots of receiveBufferLimit_ bytes
+            std::vector<sockaddr_storage> receiveAddresses_;                     ///< Source address of each slot
+            std::vector<iovec> receiveIovecs_;                                   ///< One iovec per slot
+            std::vector<mmsghdr> receiveHeaders_;                                ///< recvmmsg headers
+            std::vector<iovec> sendIovecs_;                                      ///< One iovec per sent datagram
+            std::vector<mmsghdr> sendHeaders_;                                   ///< sendmmsg headers
+            std::vector<std::pair<asio::ip::udp::endpoint, size_t>> sentBatch_;  ///< Datagrams of the last sendmmsg, for onSent
+            bool draining_ = false;                                              ///< Inside DrainBatches
+            bool receiveRequested_ = false;                                      ///< ReceiveAsync was called during the drain
+#endif
+
+            FlatMap<asio::ip::udp::endpoint, UdpSession, UdpEndpointHash> sessions_;  ///< Sessions by endpoint
+            std::vector<UdpSession> closedSessions_;                                   ///< Storage reused by CloseSessionsIf
+            std::unique_ptr<asio::steady_timer> sessionTimer_;                      ///< Idle eviction timer, set when sessions are enabled
+            std::chrono::milliseconds sessionTimeout_{0};                           ///< Idle timeout
+            uint32_t nextSessionId_ = 1;                                            ///< Id of the next session
+            std::unique_ptr<asio::steady_timer> heartbeatTimer_;                    ///< Ping timer, set when heartbeats are enabled
+            std::chrono::milliseconds heartbeatInterval_{0};                        ///< Time between two pings
+            uint32_t heartbeatMaxMissed_ = 0;                                       ///< Unanswered pings before a session is closed
+            bool reusePort_ = false;                                                ///< Set SO_REUSEPORT before binding
             std::atomic<bool> _started = false;
         };
 
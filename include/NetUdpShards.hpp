@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2024 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <type_traits>
+
+#include "NetCommon.hpp"
+#include "NetUdpServer.hpp"
+
+#if defined(__linux__)
+    #include <linux/filter.h>
+#endif
+
+namespace RType {
+    namespace net {
+        /**
+         * @brief Several UDP servers bound to the same port, each one on its own thread
+         *
+         * Every shard owns a socket bound with SO_REUSEPORT, an io_context and a thread,
+         * so the kernel spreads the datagrams over several receive queues and cores.
+         * On Linux a steering program is attached to the sockets, it sends every
+         * datagram of an endpoint to shard ShardOf(endpoint). Elsewhere the kernel
+         * hashes the source address itself, which also keeps an endpoint on one
+         * shard, but ShardOf no longer tells which one.
+         *
+         * A shard is only ever used from its own thread, use Post to reach another one.
+         *
+         * @tparam Server A UdpServerInterface, constructed with (io_context&, port, args...)
+         */
+        template <typename Server>
+        class UdpShardGroup {
+            static_assert(std::is_base_of<UdpServerInterface, Server>::value, "Shards must be UDP servers");
+
+           public:
+            /**
+             * @brief UdpShardGroup constructor
+             *
+             * @param shardCount Number of sockets and threads, e.g. std::thread::hardware_concurrency()
+             * @param port The port every shard binds to, can't be 0
+             * @param args Forwarded to each shard constructor after the context and the port
+             */
+            template <typename... Args>
+            UdpShardGroup(size_t shardCount, uint16_t port, Args&&... args) : port_(port) {
+                shardCount = std::max<size_t>(shardCount, 1);
+                contexts_.reserve(shardCount);
+                shards_.reserve(shardCount);
+                for (size_t i = 0; i < shardCount; i++) {
+                    contexts_.push_back(std::make_unique<asio::io_context>());
+                    shards_.push_back(std::make_shared<Server>(*contexts_.back(), port, args...));
+                }
+            }
+
+            ~UdpShardGroup() {
+                if (IsStarted())
+                    Stop();
+            }
+
+            UdpShardGroup(const UdpShardGroup&) = delete;
+            UdpShardGroup& operator=(const UdpShardGroup&) = delete;
+
+            /**
+             * @brief Bind every shard and start their threads
+             *
+             * The shards are bound one after the other from the calling thread, so their
+             * onStarted runs here too.
+             *
+             * @return true
+             * @return false if the group is already started or a shard could not be bound
+             */
+            bool Start() {
+                if (IsStarted()) {
+                    std::cout << "[UDP] Shard group already started" << std::endl;
+                    return false;
+                }
+                if (port_ == 0) {
+                    std::cout << "[UDP] Shards need a fixed port" << std::endl;
+                    return false;
+                }
+
+                for (size_t i = 0; i < shards_.size(); i++) {
+                    workGuards_.emplace_back(contexts_[i]->get_executor());
+                    if (!shards_[i]->SetReusePort(true) || !shards_[i]->Start()) {
+                        Stop();
+                        return false;
+                    }
+
+                    // The steering program indexes the sockets in bind order, bind them one by one
+                    try {
+                        contexts_[i]->poll();
+                    } catch (const std::exception& e) {
+                        std::cout << "[UDP] Shard " << i << " failed to start: " << e.what() << std::endl;
+                        shards_[i]->GetSocket().close();
+                    }
+                    if (!shards_[i]->IsStarted()) {
+                        Stop();
+                        return false;
+                    }
+                    if (i == 0)
+                        steered_ = AttachSteering();
+                }
+
+                for (auto& context : contexts_)
+                    threads_.emplace_back([&context]() { context->run(); });
+                return true;
+            }
+
+            /**
+             * @brief Stop every shard and join their threads
+             */
+            void Stop() {
+                for (size_t i = 0; i < workGuards_.size(); i++) {
+                    if (shards_[i]->IsStarted())
+                        shards_[i]->Stop();
+                    if (threads_.empty())
+                        contexts_[i]->poll();
+                }
+                workGuards_.clear();
+
+                for (auto& thread : threads_) {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                threads_.clear();
+                for (auto& context : contexts_)
+                    context->restart();
+                steered_ = false;
+            }
+
+            /**
+             * @brief Whether the shards are running
+             */
+            [[nodiscard]] bool IsStarted() const noexcept { return !threads_.empty(); }
+
+            /**
+             * @brief Whether datagrams are steered with ShardOf, false when the kernel picks the shard itself
+             */
+            [[nodiscard]] bool IsSteered() const noexcept { return steered_; }
+
+            [[nodiscard]] size_t GetShardCount() const noexcept { return shards_.size(); }
+
+            /**
+             * @brief Get a shard, only use it from its own thread (see Post)
+             */
+            [[nodiscard]] const std::shared_ptr<Server>& GetShard(size_t index) const { return shards_[index]; }
+
+            /**
+             * @brief Index of the shard receiving the datagrams of endpoint
+             *
+             * Mirrors the steering program, so it is only the receiving shard when
+             * IsSteered is true. It stays a stable owner for the endpoint either way.
+             */
+            [[nodiscard]] size_t ShardOf(const asio::ip::udp::endpoint& endpoint) const noexcept {
+                uint32_t key = endpoint.port();
+                if (endpoint.address().is_v4())
+                    key ^= endpoint.address().to_v4().to_uint();
+                return ((key * HashMultiplier) >> 16) % shards_.size();
+            }
+
+            /**
+             * @brief Run fn(Server&) on the thread of a shard
+             */
+            template <typename Function>
+            void Post(size_t index, Function&& fn) {
+                asio::post(*contexts_[index], [shard = shards_[index], fn = std::forward<Function>(fn)]() mutable { fn(*shard); });
+            }
+
+            /**
+             * @brief Run fn(Server&) on the thread of the shard owning endpoint
+             */
+            template <typename Function>
+            void PostTo(const asio::ip::udp::endpoint& endpoint, Function&& fn) {
+                Post(ShardOf(endpoint), std::forward<Function>(fn));
+            }
+
+            /**
+             * @brief Run a copy of fn(Server&) on the thread of every shard
+             */
+            template <typename Function>
+            void PostToAll(const Function& fn) {
+                for (size_t i = 0; i < shards_.size(); i++)
+                    Post(i, fn);
+            }
+
+           private:
+            static constexpr uint32_t HashMultiplier = 0x9E3779B1;  ///< Fibonacci hashing, spreads close ports apart
+
+            /**
+             * @brief Attach the steering program to the reuseport group of the first shard
+             *
+             * The program computes ShardOf from the IPv4 header, it assumes there are no
+             * IP options, which only moves such senders to another fixed shard.
+             */
+            bool AttachSteering() {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+                sock_filter code[] = {
+                    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 12)),  // A = source address
+                    BPF_STMT(BPF_MISC | BPF_TAX, 0),                                          // X = A
+                    BPF_STMT(BPF_LD | BPF_H | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 20)),  // A = source port
+                    BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+                    BPF_STMT(BPF_ALU | BPF_MUL | BPF_K, HashMultiplier),
+                    BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 16),
+                    BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(shards_.size())),
+                    BPF_STMT(BPF_RET | BPF_A, 0),
+                };
+                sock_fprog program = {static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code};
+
+                int fd = shards_[0]->GetSocket().native_handle();
+                if (::setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == 0)
+                    return true;
+                std::cout << "[UDP] Could not attach the shard steering program, the kernel picks the shards" << std::endl;
+#endif
+                return false;
+            }
+
+            uint16_t port_;                                                                       ///< Port shared by the shards
+            std::vector<std::unique_ptr<asio::io_context>> contexts_;                             ///< One context per shard
+            std::vector<asio::executor_work_guard<asio::io_context::executor_type>> workGuards_;  ///< Keep the contexts running
+            std::vector<std::shared_ptr<Server>> shards_;                                         ///< The servers
+            std::vector<std::thread> threads_;                                                    ///< One thread per shard
+            bool steered_ = false;                                                                ///< The steering program is attached
+        };
+    }  // namespace net
+}  // namespace RType
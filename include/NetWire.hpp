@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2023 - Kleo
+ * Authors:
+ * - Antoine FRANKEL <antoine.frankel@epitech.eu>
+ * NOTICE: All information contained herein is, and remains
+ * the property of Kleo © and its suppliers, if any.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Kleo ©.
+ */
+
+#pragma once
+
+#include <type_traits>
+
+#include "NetCommon.hpp"
+
+namespace RType {
+
+    namespace net {
+        /**
+         * @brief Encodes one value to its packed, little-endian wire form
+         *
+         * Specialize it for any field type that is not an integer, an enum, a
+         * floating point number or an array of those. A specialization provides
+         * a constexpr size, an encode and a decode function.
+         *
+         * @tparam T Field type
+         */
+        template <typename T, typename = void>
+        struct WireCodec;
+
+        /// @private
+        template <typename T>
+        struct WireCodec<T, std::enable_if_t<(std::is_integral<T>::value && !std::is_same<T, bool>::value) || std::is_enum<T>::value>> {
+            static constexpr size_t size = sizeof(T);
+
+            static void encode(uint8_t* out, const T& value) {
+                auto raw = static_cast<std::make_unsigned_t<UnderlyingType>>(value);
+                for (size_t i = 0; i < size; i++)
+                    out[i] = static_cast<uint8_t>(raw >> (8 * i));
+            }
+
+            static void decode(const uint8_t* in, T& value) {
+                std::make_unsigned_t<UnderlyingType> raw = 0;
+                for (size_t i = 0; i < size; i++)
+                    raw |= static_cast<std::make_unsigned_t<UnderlyingType>>(in[i]) << (8 * i);
+                value = static_cast<T>(raw);
+            }
+
+           private:
+            using UnderlyingType = typename std::conditional_t<std::is_enum<T>::value, std::underlying_type<T>, std::common_type<T>>::type;
+        };
+
+        /// @private
+        template <>
+        struct WireCodec<bool> {
+            static constexpr size_t size = 1;
+
+            static void encode(uint8_t* out, const bool& value) { out[0] = value ? 1 : 0; }
+
+            static void decode(const uint8_t* in, bool& value) { value = in[0] != 0; }
+        };
+
+        /// @private
+        template <typename T>
+        struct WireCodec<T, std::enable_if_t<std::is_floating_point<T>::value>> {
+            static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Only 32 and 64 bits floating point numbers can be encoded");
+            using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+            static constexpr size_t size = sizeof(T);
+
+            static void encode(uint8_t* out, const T& value) {
+                Bits bits;
+                std::memcpy(&bits, &value, sizeof(T));
+                WireCodec<Bits>::encode(out, bits);
+            }
+
+            static void decode(const uint8_t* in, T& value) {
+                Bits bits;
+                WireCodec<Bits>::decode(in, bits);
+                std::memcpy(&value, &bits, sizeof(T));
+            }
+        };
+
+        /// @private
+        template <typename T, size_t N>
+        struct WireCodec<T[N]> {
+            static constexpr size_t size = N * WireCodec<T>::size;
+
+            static void encode(uint8_t* out, const T (&value)[N]) {
+                for (size_t i = 0; i < N; i++)
+                    WireCodec<T>::encode(out + i * WireCodec<T>::size, value[i]);
+            }
+
+            static void decode(const uint8_t* in, T (&value)[N]) {
+                for (size_t i = 0; i < N; i++)
+                    WireCodec<T>::decode(in + i * WireCodec<T>::size, value[i]);
+            }
+        };
+
+        /// @private
+        template <typename MemberPointer>
+        struct member_pointer_traits;
+
+        /// @private
+        template <typename Class, typename Field>
+        struct member_pointer_traits<Field Class::*> {
+            using class_type = Class;
+            using field_type = Field;
+        };
+
+        /**
+         * @brief Packed wire layout of a struct, described by the list of its sent members
+         *
+         * Fields are written back to back in the listed order with no padding, members
+         * that are not listed are not sent. Everything is resolved at compile time, so
+         * encode and decode are straight-line code.
+         *
+         * @tparam Struct The described struct
+         * @tparam Members Pointers to the sent members of Struct
+         */
+        template <typename Struct, auto... Members>
+        struct WireLayout {
+            static_assert((std::is_same<typename member_pointer_traits<decltype(Members)>::class_type, Struct>::value && ...),
+                          "Every member must belong to the described struct");
+
+            /// Size in bytes of the encoded struct
+            static constexpr size_t size = (WireCodec<typename member_pointer_traits<decltype(Members)>::field_type>::size + ... + 0);
+
+            /**
+             * @brief Encode value into out, which must hold at least size bytes
+             */
+            static void encode(uint8_t* out, const Struct& value) {
+                ((WireCodec<typename member_pointer_traits<decltype(Members)>::field_type>::encode(out, value.*Members),
+                  out += WireCodec<typename member_pointer_traits<decltype(Members)>::field_type>::size),
+                 ...);
+            }
+
+            /**
+             * @brief Decode value from in, which must hold at least size bytes
+             */
+            static void decode(const uint8_t* in, Struct& value) {
+                ((WireCodec<typename member_pointer_traits<decltype(Members)>::field_type>::decode(in, value.*Members),
+                  in += WireCodec<typename member_pointer_traits<decltype(Members)>::field_type>::size),
+                 ...);
+            }
+        };
+
+        /**
+         * @brief Wire layout of a payload, specialize it by inheriting from WireLayout
+         *
+         * @tparam Payload The payload struct
+         */
+        template <typename Payload>
+        struct Wire;
+    }  // namespace net
+}  // namespace RType
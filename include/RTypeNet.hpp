@@ -11,13 +11,26 @@
 
 #pragma once
 
+#include "NetBodyPool.hpp"
 #include "NetClient.hpp"
 #include "NetCommon.hpp"
+#include "NetFlatMap.hpp"
+#include "NetHeartbeat.hpp"
 #include "NetMessage.hpp"
+#include "NetMpscQueue.hpp"
 #include "NetServer.hpp"
+#include "NetSlotMap.hpp"
+#include "NetSendLanes.hpp"
+#include "NetSmallVector.hpp"
+#include "NetStats.hpp"
 #include "NetTcpConnection.hpp"
+#include "NetTickScheduler.hpp"
+#include "NetTimerWheel.hpp"
 #include "NetTsqueue.hpp"
+#include "NetUdpChannels.hpp"
 #include "NetUdpServer.hpp"
+#include "NetUdpShards.hpp"
+#include "NetWire.hpp"
 #include "RTypeServerMessages.hpp"
 
 #define UUID_SYSTEM_GENERATOR
@@ -328,4 +341,125 @@ namespace RType {
         } AddEnemy;
 
     }  // namespace udp
+
+    ////////////////////////////////////////////////////////////////
+    //                        Wire layouts                        //
+    // Packed, little-endian encoding of the payloads, see        //
+    // MessageWriter::pack and MessageReader::unpack. The message //
+    // type is already in the header so it is never sent twice.   //
+    ////////////////////////////////////////////////////////////////
+
+    namespace net {
+        /// @private
+        template <>
+        struct WireCodec<uuids::uuid> {
+            static constexpr size_t size = 16;
+
+            static void encode(uint8_t* out, const uuids::uuid& value) {
+                std::memcpy(out, value.as_bytes().data(), size);
+            }
+
+            static void decode(const uint8_t* in, uuids::uuid& value) {
+                value = uuids::uuid(in, in + size);
+            }
+        };
+
+        /// @private
+        template <>
+        struct WireCodec<glm::vec2> {
+            static constexpr size_t size = 2 * WireCodec<float>::size;
+
+            static void encode(uint8_t* out, const glm::vec2& value) {
+                WireCodec<float>::encode(out, value.x);
+                WireCodec<float>::encode(out + WireCodec<float>::size, value.y);
+            }
+
+            static void decode(const uint8_t* in, glm::vec2& value) {
+                WireCodec<float>::decode(in, value.x);
+                WireCodec<float>::decode(in + WireCodec<float>::size, value.y);
+            }
+        };
+
+        /// @private
+        template <>
+        struct Wire<tcp::CreateLobby_t> : WireLayout<tcp::CreateLobby_t, &tcp::CreateLobby_t::maxPlayers> {};
+        static_assert(Wire<tcp::CreateLobby_t>::size == 2, "Unexpected CreateLobby wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::LobbyCreated_t> : WireLayout<tcp::LobbyCreated_t, &tcp::LobbyCreated_t::uuid,
+                                                      &tcp::LobbyCreated_t::port,
+                                                      &tcp::LobbyCreated_t::maxPlayers> {};
+        static_assert(Wire<tcp::LobbyCreated_t>::size == 20, "Unexpected LobbyCreated wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::DeleteLobby_t> : WireLayout<tcp::DeleteLobby_t, &tcp::DeleteLobby_t::uuid> {};
+        static_assert(Wire<tcp::DeleteLobby_t>::size == 16, "Unexpected DeleteLobby wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::LobbyDeleted_t> : WireLayout<tcp::LobbyDeleted_t, &tcp::LobbyDeleted_t::uuid> {};
+        static_assert(Wire<tcp::LobbyDeleted_t>::size == 16, "Unexpected LobbyDeleted wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::JoinLobby_t> : WireLayout<tcp::JoinLobby_t, &tcp::JoinLobby_t::lobbyUuid,
+                                                   &tcp::JoinLobby_t::clientUuid,
+                                                   &tcp::JoinLobby_t::username,
+                                                   &tcp::JoinLobby_t::color> {};
+        static_assert(Wire<tcp::JoinLobby_t>::size == 65, "Unexpected JoinLobby wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::LobbyJoined_t> : WireLayout<tcp::LobbyJoined_t, &tcp::LobbyJoined_t::lobbyUuid,
+                                                     &tcp::LobbyJoined_t::clientUuid,
+                                                     &tcp::LobbyJoined_t::username> {};
+        static_assert(Wire<tcp::LobbyJoined_t>::size == 64, "Unexpected LobbyJoined wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::LeaveLobby_t> : WireLayout<tcp::LeaveLobby_t, &tcp::LeaveLobby_t::clientUuid,
+                                                    &tcp::LeaveLobby_t::lobbyUuid> {};
+        static_assert(Wire<tcp::LeaveLobby_t>::size == 32, "Unexpected LeaveLobby wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::LobbyLeft_t> : WireLayout<tcp::LobbyLeft_t, &tcp::LobbyLeft_t::clientUuid,
+                                                   &tcp::LobbyLeft_t::lobbyUuid> {};
+        static_assert(Wire<tcp::LobbyLeft_t>::size == 32, "Unexpected LobbyLeft wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::StartLobby_t> : WireLayout<tcp::StartLobby_t, &tcp::StartLobby_t::uuid> {};
+        static_assert(Wire<tcp::StartLobby_t>::size == 16, "Unexpected StartLobby wire size");
+
+        /// @private
+        template <>
+        struct Wire<tcp::LobbyStarted_t> : WireLayout<tcp::LobbyStarted_t, &tcp::LobbyStarted_t::uuid> {};
+        static_assert(Wire<tcp::LobbyStarted_t>::size == 16, "Unexpected LobbyStarted wire size");
+
+        /// @private
+        template <>
+        struct Wire<udp::Move_t> : WireLayout<udp::Move_t, &udp::Move_t::clientUuid,
+                                              &udp::Move_t::position,
+                                              &udp::Move_t::velocity> {};
+        static_assert(Wire<udp::Move_t>::size == 32, "Unexpected Move wire size");
+
+        /// @private
+        template <>
+        struct Wire<udp::Shoot_t> : WireLayout<udp::Shoot_t, &udp::Shoot_t::clientUuid,
+                                               &udp::Shoot_t::position,
+                                               &udp::Shoot_t::target_velocity,
+                                               &udp::Shoot_t::id> {};
+        static_assert(Wire<udp::Shoot_t>::size == 33, "Unexpected Shoot wire size");
+
+        /// @private
+        template <>
+        struct Wire<udp::AddEnemy> : WireLayout<udp::AddEnemy, &udp::AddEnemy::id,
+                                                &udp::AddEnemy::position,
+                                                &udp::AddEnemy::velocity,
+                                                &udp::AddEnemy::time> {};
+        static_assert(Wire<udp::AddEnemy>::size == 25, "Unexpected AddEnemy wire size");
+    }  // namespace net
 }  // namespace RType
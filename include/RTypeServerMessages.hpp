@@ -13,6 +13,8 @@
 
 #include <iostream>
 
+#include "NetSendLanes.hpp"
+
 namespace RType {
 
     enum class ServerMessages : uint32_t {
@@ -120,4 +122,26 @@ namespace RType {
         return os;
     }
 
+    namespace net {
+        /**
+         * @brief Accepting, denying and starting a game skip ahead of the lobby lists
+         */
+        template <>
+        struct SendLanes<ServerMessages> {
+            static constexpr SendLane Of(ServerMessages id) noexcept {
+                switch (id) {
+                    case ServerMessages::ServerAccept:
+                    case ServerMessages::ServerDeny:
+                    case ServerMessages::ServerPing:
+                    case ServerMessages::ServerLobbyStarted:
+                        return SendLane::Control;
+                    case ServerMessages::ServerLobbyUpdated:
+                        return SendLane::Bulk;
+                    default:
+                        return SendLane::Normal;
+                }
+            }
+        };
+    }  // namespace net
+
 }  // namespace RType
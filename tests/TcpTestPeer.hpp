@@ -0,0 +1,117 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** TCP helpers shared by the tests
+*/
+
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <atomic>
+
+#include "NetServer.hpp"
+#include "UdpTestPeer.hpp"
+
+namespace test {
+    /**
+     * @brief The server check of the handshake, see AConnection::scramble
+     */
+    inline uint64_t Scramble(uint64_t input) {
+        uint64_t out = input ^ 0xDEADBEEFC0DECAFE;
+        out = (out & 0xF0F0F0F0F0F0F0) >> 4 | (out & 0x0F0F0F0F0F0F0F) << 4;
+        return out ^ 0xC0DEFACE12345678;
+    }
+
+    /**
+     * @brief Plain blocking client that answers the handshake, then writes and reads raw bytes
+     */
+    class RawTcpClient {
+       public:
+        /**
+         * @param port The loopback port of the server
+         * @param receiveBufferSize SO_RCVBUF of the socket, 0 to keep the default
+         */
+        explicit RawTcpClient(uint16_t port, int receiveBufferSize = 0) {
+            socket_.open(asio::ip::tcp::v4());
+            // A small receive window makes the server queue fill up instead of the kernel buffers
+            if (receiveBufferSize > 0)
+                setsockopt(socket_.native_handle(), SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+            timeval timeout{5, 0};
+            setsockopt(socket_.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            socket_.connect(asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), port));
+            socket_.set_option(asio::ip::tcp::no_delay(true));
+
+            uint64_t challenge = 0;
+            asio::read(socket_, asio::buffer(&challenge, sizeof(challenge)));
+            challenge = Scramble(challenge);
+            asio::write(socket_, asio::buffer(&challenge, sizeof(challenge)));
+        }
+
+        /**
+         * @brief Write bytes [begin, end) of stream, then give the server time to read them on their own
+         */
+        void Write(const std::vector<uint8_t>& stream, size_t begin, size_t end) {
+            asio::write(socket_, asio::buffer(stream.data() + begin, end - begin));
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+
+        /**
+         * @brief Read the next message, false on error or after 5 seconds without data
+         */
+        template <typename MessageType>
+        bool Read(RType::net::message<MessageType>& msg) {
+            asio::error_code ec;
+            asio::read(socket_, asio::buffer(&msg.header, sizeof(msg.header)), ec);
+            if (ec)
+                return false;
+            msg.body.resize(msg.header.size);
+            asio::read(socket_, asio::buffer(msg.body.data(), msg.body.size()), ec);
+            return !ec;
+        }
+
+       private:
+        asio::io_context context_;
+        asio::ip::tcp::socket socket_{context_};
+    };
+
+    /**
+     * @brief Server accepting every client and ignoring its messages, counts the validated clients
+     */
+    template <typename MessageType>
+    class TcpServerStub : public RType::net::ServerInterface<MessageType> {
+       public:
+        using RType::net::ServerInterface<MessageType>::ServerInterface;
+
+        /**
+         * @brief Wait for count clients to pass the handshake, the test traffic may go after it
+         */
+        bool WaitValidated(size_t count = 1) {
+            return WaitFor([this, count]() { return validated >= count; });
+        }
+
+        void OnClientValidated(std::shared_ptr<RType::net::TcpConnection<MessageType>> /* client */) override { validated++; }
+
+        std::atomic<size_t> validated = 0;  ///< Clients that passed the handshake
+
+       protected:
+        bool OnClientConnect(std::shared_ptr<RType::net::TcpConnection<MessageType>> /* client */) override { return true; }
+        void OnClientDisconnect(std::shared_ptr<RType::net::TcpConnection<MessageType>> /* client */) override {}
+        void OnMessage(std::shared_ptr<RType::net::TcpConnection<MessageType>> /* client */, RType::net::message<MessageType>& /* msg */) override {}
+    };
+
+    /**
+     * @brief A shared message of id with a zeroed body of size bytes, starting with value
+     */
+    template <typename MessageType>
+    inline RType::net::shared_message<MessageType> MakeMessage(MessageType id, size_t size, uint32_t value = 0) {
+        RType::net::message<MessageType> msg;
+        msg.header.id = id;
+        msg.body.resize(std::max(size, sizeof(value)));
+        std::memcpy(msg.body.data(), &value, sizeof(value));
+        msg.header.size = msg.size();
+        return RType::net::make_shared_message(msg);
+    }
+}  // namespace test
@@ -0,0 +1,10 @@
+# Every tests/*.cpp is linked into one GTest executable, run it with ctest:
+#   cmake -S . -B build -DIS_TESTING=TRUE && cmake --build build && ctest --test-dir build
+find_package(Threads REQUIRED)
+include(GoogleTest)
+
+file(GLOB TEST_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/tests/*.cpp")
+
+add_executable(${PROJECT_NAME}-tests ${TEST_SOURCES})
+target_link_libraries(${PROJECT_NAME}-tests PRIVATE ${PROJECT_NAME} gtest gtest_main Threads::Threads)
+gtest_discover_tests(${PROJECT_NAME}-tests DISCOVERY_TIMEOUT 30)
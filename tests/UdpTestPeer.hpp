@@ -0,0 +1,144 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** UDP helpers shared by the tests
+*/
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "NetUdpServer.hpp"
+
+namespace test {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Wait until done returns true, at most timeout
+     */
+    template <typename Predicate>
+    inline bool WaitFor(Predicate done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        auto deadline = Clock::now() + timeout;
+        while (!done()) {
+            if (Clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    /**
+     * @brief An asio context run by its own thread until Stop or destruction
+     */
+    class IoThread {
+       public:
+        IoThread() : thread_([this]() { context.run(); }) {}
+        ~IoThread() { Stop(); }
+
+        void Stop() {
+            if (!thread_.joinable())
+                return;
+            work_.reset();
+            context.stop();
+            thread_.join();
+        }
+
+        asio::io_context context;
+
+       private:
+        asio::executor_work_guard<asio::io_context::executor_type> work_ = asio::make_work_guard(context);
+        std::thread thread_;
+    };
+
+    /**
+     * @brief Run fn on a thread of context, wait for it and return its result
+     */
+    template <typename Function>
+    inline auto RunOn(asio::io_context& context, Function fn) -> decltype(fn()) {
+        std::packaged_task<decltype(fn())()> task(std::move(fn));
+        auto result = task.get_future();
+        asio::post(context, [&task]() { task(); });
+        return result.get();
+    }
+
+    /**
+     * @brief Loopback endpoint of port
+     */
+    inline asio::ip::udp::endpoint Loopback(uint16_t port) {
+        return asio::ip::udp::endpoint(asio::ip::make_address("127.0.0.1"), port);
+    }
+
+    /**
+     * @brief Plain blocking socket bound to an ephemeral loopback port
+     */
+    class RawSocket {
+       public:
+        RawSocket() : socket_(context_, Loopback(0)) {}
+
+        void SendTo(uint16_t port, const void* data, size_t size) { socket_.send_to(asio::buffer(data, size), Loopback(port)); }
+
+        [[nodiscard]] asio::ip::udp::endpoint Endpoint() const { return socket_.local_endpoint(); }
+
+       private:
+        asio::io_context context_;
+        asio::ip::udp::socket socket_;
+    };
+
+    /**
+     * @brief UDP server keeping every datagram it receives, with its sender
+     */
+    class UdpPeer : public RType::net::UdpServerInterface {
+       public:
+        using UdpServerInterface::UdpServerInterface;
+
+        struct Datagram {
+            asio::ip::udp::endpoint sender;
+            std::vector<uint8_t> data;
+        };
+
+        /**
+         * @brief Start and wait for the socket to be bound
+         */
+        bool StartAndWait() {
+            return Start() && WaitFor([this]() { return IsStarted(); });
+        }
+
+        std::vector<Datagram> Received() {
+            std::scoped_lock lock(mutex_);
+            return datagrams_;
+        }
+
+        std::atomic<size_t> received = 0;  ///< Datagrams passed to onReceived
+        std::atomic<size_t> sent = 0;      ///< Datagrams passed to onSent
+
+       protected:
+        void onStarted() override { ReceiveAsync(); }
+        void onStopped() override {}
+        void onConnected() override {}
+        void onDisconnected() override {}
+
+        void onReceived(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) override {
+            {
+                std::scoped_lock lock(mutex_);
+                const auto* bytes = static_cast<const uint8_t*>(buffer);
+                datagrams_.push_back({endpoint, std::vector<uint8_t>(bytes, bytes + size)});
+            }
+            received++;
+            ReceiveAsync();
+        }
+
+        void onSent(const asio::ip::udp::endpoint& /* endpoint */, size_t /* sent */) override { sent++; }
+
+        void onError(int /* error */, const std::string& category, const std::string& message) override {
+            std::cout << "[TEST] " << category << ": " << message << std::endl;
+        }
+
+       private:
+        std::mutex mutex_;
+        std::vector<Datagram> datagrams_;
+    };
+}  // namespace test
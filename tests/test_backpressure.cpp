@@ -0,0 +1,130 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Backpressure, a client that stops reading is dropped or has its queue trimmed, conflated ids replaced
+*/
+
+#include "TcpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    enum class Msg : uint32_t { Data, State };
+
+    class BackpressureServer : public test::TcpServerStub<Msg> {
+       public:
+        using TcpServerStub::TcpServerStub;
+
+        std::atomic<int> events = 0;
+        std::atomic<int> disconnects = 0;
+        std::atomic<size_t> dropped = 0;
+
+       protected:
+        void OnBackpressure(std::shared_ptr<TcpConnection<Msg>> /* client */, const BackpressureEvent& event) override {
+            events++;
+            dropped += event.droppedMessages;
+            if (event.disconnected)
+                disconnects++;
+        }
+    };
+
+    class BackpressureTest : public testing::Test {
+       protected:
+        /**
+         * @brief Start a server bounded to 1000 messages and connect a stalled client to it
+         */
+        void Start(uint16_t port, BackpressurePolicy policy) {
+            server_ = std::make_unique<BackpressureServer>(port);
+            BackpressureConfig<Msg> config;
+            config.maxQueuedMessages = 1000;
+            config.maxQueuedBytes = 0;
+            config.policy = policy;
+            config.conflated = {Msg::State};
+            server_->SetBackpressure(config);
+            ASSERT_TRUE(server_->Start());
+            // A tiny receive window, the client only reads when the test asks it to
+            client_ = std::make_unique<test::RawTcpClient>(port, 4096);
+            ASSERT_TRUE(server_->WaitValidated());
+        }
+
+        void TearDown() override {
+            if (server_)
+                server_->Stop();
+        }
+
+        std::unique_ptr<BackpressureServer> server_;
+        std::unique_ptr<test::RawTcpClient> client_;
+    };
+}  // namespace
+
+TEST_F(BackpressureTest, DisconnectPolicyDropsTheStalledClient) {
+    Start(47901, BackpressurePolicy::Disconnect);
+    auto data = test::MakeMessage(Msg::Data, 1000);
+    size_t maxQueued = 0;
+    for (int i = 0; i < 20000 && server_->disconnects == 0; i++) {
+        server_->MessageAllClients(data);
+        if (i % 100 == 0)
+            maxQueued = std::max(maxQueued, server_->GetStats().maxQueuedMessages);
+    }
+
+    ASSERT_TRUE(test::WaitFor([this]() { return server_->disconnects == 1; }));
+    EXPECT_EQ(server_->events, 1);
+    EXPECT_LE(maxQueued, 1000u);
+    auto stats = server_->GetStats();
+    EXPECT_EQ(stats.backpressureDisconnects, 1u);
+    EXPECT_GT(stats.droppedMessages, 0u) << "the whole queue goes with the client";
+}
+
+TEST_F(BackpressureTest, DropOldestKeepsTheClient) {
+    Start(47902, BackpressurePolicy::DropOldest);
+    auto data = test::MakeMessage(Msg::Data, 1000);
+    size_t maxQueued = 0;
+    for (int i = 0; i < 20000; i++) {
+        server_->MessageAllClients(data);
+        if (i % 100 == 0)
+            maxQueued = std::max(maxQueued, server_->GetStats().maxQueuedMessages);
+    }
+
+    ASSERT_TRUE(test::WaitFor([this]() { return server_->dropped > 0; }));
+    EXPECT_EQ(server_->disconnects, 0);
+    EXPECT_LE(maxQueued, 1000u);
+    EXPECT_EQ(server_->GetClientCount(), 1u);
+    EXPECT_EQ(server_->GetStats().backpressureDisconnects, 0u);
+}
+
+TEST_F(BackpressureTest, ConflatedIdsAreReplacedAndOthersKept) {
+    Start(47903, BackpressurePolicy::Disconnect);
+    // Enough data to fill the kernel buffers, the states are sent while it is still queued
+    const uint32_t dataCount = 900;
+    const uint32_t stateCount = 5000;
+    for (uint32_t i = 0; i < dataCount; i++)
+        server_->MessageAllClients(test::MakeMessage(Msg::Data, 8192, i));
+    for (uint32_t i = 0; i < stateCount; i++)
+        server_->MessageAllClients(test::MakeMessage(Msg::State, sizeof(i), i));
+
+    // Far past the message mark, yet the replaced states never count towards it
+    uint32_t nextData = 0;
+    uint32_t states = 0;
+    uint32_t lastState = 0;
+    message<Msg> msg;
+    while (lastState != stateCount - 1 || nextData != dataCount) {
+        ASSERT_TRUE(client_->Read(msg)) << "the stream ended after " << nextData << " data and " << states << " states";
+        uint32_t value = 0;
+        std::memcpy(&value, msg.body.data(), sizeof(value));
+        if (msg.header.id == Msg::Data) {
+            ASSERT_EQ(value, nextData) << "a data message was lost";
+            nextData++;
+        } else {
+            ASSERT_TRUE(states == 0 || value > lastState) << "a state went backwards";
+            lastState = value;
+            states++;
+        }
+    }
+
+    EXPECT_LT(states, stateCount / 10);
+    EXPECT_EQ(server_->disconnects, 0);
+    EXPECT_EQ(server_->events, 0);
+    EXPECT_EQ(server_->GetStats().droppedMessages, 0u) << "a replaced message is not a dropped one";
+}
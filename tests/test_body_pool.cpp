@@ -0,0 +1,109 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** BodyPool, size classes, the unpooled path, reuse across threads and the bounded depot
+*/
+
+#include <thread>
+#include <vector>
+
+#include "NetBodyPool.hpp"
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using RType::net::BodyPool;
+
+TEST(BodyPool, RoundsSizesUpToAPowerOfTwo) {
+    EXPECT_EQ(BodyPool::SizeClass(0), 0u);
+    EXPECT_EQ(BodyPool::SizeClass(1), 0u);
+    EXPECT_EQ(BodyPool::SizeClass(64), 0u);
+    EXPECT_EQ(BodyPool::SizeClass(65), 1u);
+    EXPECT_EQ(BodyPool::SizeClass(128), 1u);
+    EXPECT_EQ(BodyPool::SizeClass(129), 2u);
+    EXPECT_EQ(BodyPool::SizeClass(BodyPool::MaxBlockSize), BodyPool::ClassCount - 1);
+    EXPECT_EQ(BodyPool::SizeClass(BodyPool::MaxBlockSize + 1), BodyPool::ClassCount);
+    EXPECT_EQ(BodyPool::BlockSize(BodyPool::ClassCount - 1), BodyPool::MaxBlockSize);
+
+    for (size_t size = 1; size <= BodyPool::MaxBlockSize; size = size * 3 / 2 + 1) {
+        size_t block = BodyPool::BlockSize(BodyPool::SizeClass(size));
+        EXPECT_GE(block, size);
+        EXPECT_TRUE(block == BodyPool::MinBlockSize || block / 2 < size) << size << " got a block of " << block;
+    }
+
+    // A freed block serves the next request of its class, not of another one
+    void* block = BodyPool::Allocate(100);
+    BodyPool::Deallocate(block, 100);
+    void* other = BodyPool::Allocate(129);
+    EXPECT_NE(other, block);
+    void* same = BodyPool::Allocate(65);
+    EXPECT_EQ(same, block);
+    BodyPool::Deallocate(same, 65);
+    BodyPool::Deallocate(other, 129);
+}
+
+TEST(BodyPool, LargeBlocksGoToOperatorNew) {
+    const size_t size = BodyPool::MaxBlockSize + 1;
+    auto before = BodyPool::GetStats();
+    void* block = BodyPool::Allocate(size);
+    std::memset(block, 0xAB, size);
+    auto allocated = BodyPool::GetStats();
+    EXPECT_EQ(allocated.allocations - before.allocations, 1u);
+    EXPECT_EQ(allocated.systemAllocations - before.systemAllocations, 1u);
+
+    BodyPool::Deallocate(block, size);
+    auto freed = BodyPool::GetStats();
+    EXPECT_EQ(freed.deallocations - allocated.deallocations, 1u);
+    EXPECT_EQ(freed.systemFrees - allocated.systemFrees, 1u);
+}
+
+TEST(BodyPool, BodiesFreedOnAnotherThreadAreReused) {
+    constexpr size_t perRound = 100;
+    constexpr size_t size = 200;
+    test::IoThread io;
+    std::vector<void*> blocks;
+
+    // The io thread allocates, the game thread frees, as for incoming messages
+    auto round = [&]() {
+        test::RunOn(io.context, [&]() {
+            for (size_t i = 0; i < perRound; i++)
+                blocks.push_back(BodyPool::Allocate(size));
+            return true;
+        });
+        for (void* block : blocks)
+            BodyPool::Deallocate(block, size);
+        blocks.clear();
+    };
+
+    for (int warmUp = 0; warmUp < 10; warmUp++)
+        round();
+    auto before = BodyPool::GetStats();
+    for (int steady = 0; steady < 100; steady++)
+        round();
+    auto after = BodyPool::GetStats();
+
+    EXPECT_EQ(after.allocations - before.allocations, 100 * perRound);
+    EXPECT_EQ(after.deallocations - before.deallocations, 100 * perRound);
+    EXPECT_EQ(after.systemAllocations, before.systemAllocations) << "steady traffic still went to operator new";
+    EXPECT_EQ(after.systemFrees, before.systemFrees);
+}
+
+TEST(BodyPool, DepotGivesPeakMemoryBack) {
+    constexpr size_t count = 200;
+    const size_t depotBlocks = BodyPool::DepotSize / BodyPool::MaxBlockSize;
+    auto before = BodyPool::GetStats();
+
+    // A peak on a thread that then exits, its cache goes to the depot as well
+    std::thread peak([&]() {
+        std::vector<void*> blocks;
+        for (size_t i = 0; i < count; i++)
+            blocks.push_back(BodyPool::Allocate(BodyPool::MaxBlockSize));
+        for (void* block : blocks)
+            BodyPool::Deallocate(block, BodyPool::MaxBlockSize);
+    });
+    peak.join();
+
+    auto after = BodyPool::GetStats();
+    EXPECT_EQ(after.allocations - before.allocations, count) << "the counters of an exited thread are kept";
+    EXPECT_GE(after.systemFrees - before.systemFrees, count - depotBlocks) << "the depot kept more than DepotSize";
+}
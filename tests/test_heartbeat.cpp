@@ -0,0 +1,150 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Heartbeats, RTT measured on answered pings and silent peers dropped, over TCP and UDP
+*/
+
+#include "NetClient.hpp"
+#include "NetServer.hpp"
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    enum class Msg : uint32_t { Ping, Data };
+
+    class PingServer : public ServerInterface<Msg> {
+       public:
+        using ServerInterface::ServerInterface;
+
+        std::atomic<int> pingsSeen = 0;
+        std::atomic<int> disconnected = 0;
+
+       protected:
+        bool OnClientConnect(std::shared_ptr<TcpConnection<Msg>> /* client */) override { return true; }
+        void OnClientDisconnect(std::shared_ptr<TcpConnection<Msg>> /* client */) override { disconnected++; }
+        void OnClientValidated(std::shared_ptr<TcpConnection<Msg>> /* client */) override {}
+        void OnMessage(std::shared_ptr<TcpConnection<Msg>> /* client */, message<Msg>& msg) override {
+            if (msg.header.id == Msg::Ping)
+                pingsSeen++;
+        }
+    };
+
+    class PingClient : public ClientInterface<Msg> {
+       public:
+        std::atomic<int> pingsSeen = 0;
+
+       protected:
+        void OnMessage(message<Msg>& msg) override {
+            if (msg.header.id == Msg::Ping)
+                pingsSeen++;
+        }
+    };
+
+    /**
+     * @brief UDP peer counting the sessions it closed
+     */
+    class SessionPeer : public test::UdpPeer {
+       public:
+        using UdpPeer::UdpPeer;
+
+        std::atomic<int> closed = 0;
+
+       protected:
+        void onSessionClosed(UdpSession& /* session */) override { closed++; }
+    };
+}  // namespace
+
+TEST(Heartbeat, EncodeDecode) {
+    auto ping = Heartbeat::MakePing();
+    uint8_t buffer[Heartbeat::Size];
+    ping.Encode(buffer);
+
+    Heartbeat decoded;
+    ASSERT_TRUE(Heartbeat::Decode(buffer, sizeof(buffer), decoded));
+    EXPECT_EQ(decoded.kind, Heartbeat::Kind::Ping);
+    EXPECT_EQ(decoded.timestamp, ping.timestamp);
+    EXPECT_FALSE(Heartbeat::Decode(buffer, sizeof(buffer) - 1, decoded));
+    buffer[0] ^= 0xFF;
+    EXPECT_FALSE(Heartbeat::Decode(buffer, sizeof(buffer), decoded)) << "a datagram without the magic is not a heartbeat";
+}
+
+TEST(Heartbeat, TcpPingsMeasureRttAndDropSilentClients) {
+    PingServer server(47801, 2);
+    server.EnableHeartbeat(Msg::Ping, std::chrono::milliseconds(50), 3);
+    ASSERT_TRUE(server.Start());
+
+    PingClient answering;
+    answering.EnableHeartbeat(Msg::Ping, std::chrono::milliseconds(50));
+    answering.ConnectToServer("127.0.0.1", 47801);
+    // Does not know the ping id, the pings reach OnMessage and are never answered
+    PingClient silent;
+    silent.ConnectToServer("127.0.0.1", 47801);
+    ASSERT_TRUE(test::WaitFor([&]() { return server.GetClientCount() == 2; }));
+
+    ASSERT_TRUE(test::WaitFor([&]() {
+        // A broadcast finds the closed connection and removes it
+        message<Msg> msg;
+        msg.header.id = Msg::Data;
+        server.MessageAllClients(msg);
+        return server.GetClientCount() == 1;
+    })) << "the silent client was never dropped";
+    EXPECT_EQ(server.disconnected, 1);
+
+    auto clients = server.GetClients();
+    ASSERT_EQ(clients.size(), 1u);
+    ASSERT_TRUE(test::WaitFor([&]() { return clients.front()->GetRtt().count() > 0 && answering.GetRtt().count() > 0; }));
+    EXPECT_LT(clients.front()->GetRtt(), std::chrono::seconds(1));
+
+    server.Update(-1, false);
+    answering.PollBatch();
+    silent.PollBatch();
+    EXPECT_EQ(server.pingsSeen, 0) << "answered heartbeats must not reach OnMessage";
+    EXPECT_EQ(answering.pingsSeen, 0);
+    EXPECT_GT(silent.pingsSeen, 0);
+
+    answering.Disconnect();
+    silent.Disconnect();
+    server.Stop();
+}
+
+TEST(Heartbeat, UdpSessionsWithoutAnswerAreClosed) {
+    test::IoThread io;
+    auto server = std::make_shared<SessionPeer>(io.context, 47811);
+    ASSERT_TRUE(server->EnableSessions(std::chrono::seconds(10)));
+    ASSERT_TRUE(server->EnableHeartbeat(std::chrono::milliseconds(50), 4));
+    auto answering = std::make_shared<SessionPeer>(io.context, 47812);
+    answering->AnswerHeartbeats();
+    auto mute = std::make_shared<SessionPeer>(io.context, 47813);
+    ASSERT_TRUE(server->StartAndWait());
+    ASSERT_TRUE(answering->StartAndWait());
+    ASSERT_TRUE(mute->StartAndWait());
+
+    ASSERT_TRUE(answering->SendAsync(test::Loopback(47811), "hi", 2));
+    ASSERT_TRUE(mute->SendAsync(test::Loopback(47811), "hi", 2));
+    ASSERT_TRUE(test::WaitFor([&]() { return server->closed == 1; })) << "the mute session was never closed";
+
+    struct Session {
+        uint16_t port;
+        bool hasRtt;
+    };
+    auto sessions = test::RunOn(io.context, [&]() {
+        std::vector<Session> out;
+        server->ForEachSession([&](UdpSession& session) { out.push_back({session.endpoint.port(), session.rtt.HasSample()}); });
+        return out;
+    });
+    ASSERT_EQ(sessions.size(), 1u);
+    EXPECT_EQ(sessions.front().port, 47812);
+    EXPECT_TRUE(sessions.front().hasRtt);
+
+    // Pings and pongs are handled below onReceived, the mute peer sees the pings as datagrams
+    EXPECT_EQ(server->received, 2u);
+    EXPECT_EQ(answering->received, 0u);
+    EXPECT_GE(mute->received, 4u);
+
+    server->Stop();
+    answering->Stop();
+    mute->Stop();
+}
@@ -0,0 +1,86 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** LatencyHistogram, bucket edges, the clamp and percentiles within 1/16 of the recorded values
+*/
+
+#include "NetStats.hpp"
+#include "gtest/gtest.h"
+
+using RType::net::LatencyHistogram;
+
+namespace {
+    uint64_t Bound(uint64_t value) { return LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketIndex(value)); }
+}  // namespace
+
+TEST(LatencyHistogram, SmallValuesHaveTheirOwnBucket) {
+    EXPECT_EQ(LatencyHistogram::BucketIndex(0), 0u);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(15), 15u);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(16), 16u);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(31), 31u);
+    for (uint64_t value = 0; value < 32; value++)
+        EXPECT_EQ(Bound(value), value);
+
+    // From 32 on, a bucket holds 2^(msb - 4) values
+    EXPECT_EQ(LatencyHistogram::BucketIndex(32), 32u);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(33), 32u);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(34), 33u);
+    EXPECT_EQ(LatencyHistogram::BucketUpperBound(32), 33u);
+}
+
+TEST(LatencyHistogram, PowersOfTwoStartABucket) {
+    for (size_t k = 5; k < LatencyHistogram::MaxBits; k++) {
+        SCOPED_TRACE(testing::Message() << "2^" << k);
+        uint64_t power = uint64_t(1) << k;
+        size_t last = LatencyHistogram::BucketIndex(power - 1);
+        size_t first = LatencyHistogram::BucketIndex(power);
+        EXPECT_EQ(first, last + 1);
+        EXPECT_EQ(first, (k - LatencyHistogram::SubBucketBits + 1) * LatencyHistogram::SubBuckets);
+        EXPECT_EQ(LatencyHistogram::BucketUpperBound(last), power - 1);
+        EXPECT_EQ(LatencyHistogram::BucketUpperBound(first), power + (power >> LatencyHistogram::SubBucketBits) - 1);
+    }
+}
+
+TEST(LatencyHistogram, ValuesPastMaxBitsAreClamped) {
+    const uint64_t limit = uint64_t(1) << LatencyHistogram::MaxBits;
+    const size_t lastBucket = LatencyHistogram::BucketCount - 1;
+    EXPECT_EQ(LatencyHistogram::BucketIndex(limit - 1), lastBucket);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(limit), lastBucket);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(~uint64_t(0)), lastBucket);
+    EXPECT_EQ(LatencyHistogram::BucketUpperBound(lastBucket), limit - 1);
+}
+
+TEST(LatencyHistogram, BoundsAreWithinASixteenth) {
+    for (uint64_t value = 1; value < (uint64_t(1) << LatencyHistogram::MaxBits); value = value * 5 / 4 + 1) {
+        uint64_t bound = Bound(value);
+        ASSERT_GE(bound, value);
+        ASSERT_LE(bound - value, value / LatencyHistogram::SubBuckets) << "value " << value;
+        ASSERT_EQ(LatencyHistogram::BucketIndex(bound), LatencyHistogram::BucketIndex(value)) << "value " << value;
+    }
+}
+
+TEST(LatencyHistogram, PercentilesOfAKnownDistribution) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.TakeSnapshot().Percentile(50).count(), 0);
+
+    // 1 to 10000 ns, once each
+    for (int64_t ns = 1; ns <= 10000; ns++)
+        histogram.Record(std::chrono::nanoseconds(ns));
+    auto snapshot = histogram.TakeSnapshot();
+    EXPECT_EQ(snapshot.count, 10000u);
+    EXPECT_EQ(snapshot.Max().count(), 10000);
+    EXPECT_EQ(snapshot.Mean().count(), 5000);
+
+    const std::pair<double, int64_t> expected[] = {{0, 1}, {10, 1000}, {50, 5000}, {90, 9000}, {99, 9900}, {99.9, 9990}};
+    for (const auto& [p, value] : expected) {
+        int64_t reported = snapshot.Percentile(p).count();
+        EXPECT_GE(reported, value) << "p" << p;
+        EXPECT_LE(reported - value, value / 16) << "p" << p;
+    }
+    EXPECT_EQ(snapshot.Percentile(100).count(), 10000) << "the top percentile is the max";
+
+    // Negative durations count as 0
+    histogram.Record(std::chrono::nanoseconds(-5));
+    EXPECT_EQ(histogram.TakeSnapshot().buckets[0], 1u);
+}
@@ -0,0 +1,131 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** MessageWriter and MessageReader, exact reservations, forward reads and packed payloads
+*/
+
+#include "NetMessage.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    enum class Msg : uint32_t { Data };
+
+    /// Big enough that a reservation leaves the inline storage
+    struct Blob {
+        uint8_t bytes[280];
+    };
+
+    /// Its padding is never sent, see Wire<Sample>
+    struct Sample {
+        uint16_t id;
+        float speed;
+        uint8_t flags;
+        uint64_t tick;
+    };
+}  // namespace
+
+namespace RType {
+    namespace net {
+        template <>
+        struct Wire<Sample> : WireLayout<Sample, &Sample::id, &Sample::speed, &Sample::flags, &Sample::tick> {};
+    }  // namespace net
+}  // namespace RType
+
+TEST(MessageWriter, ReserveIsExactAndWritesDoNotReallocate) {
+    message<Msg> msg;
+    MessageWriter<Msg> writer(msg);
+    writer.reserve<Blob, uint64_t, uint32_t>();
+    constexpr size_t expected = sizeof(Blob) + sizeof(uint64_t) + sizeof(uint32_t);
+    static_assert(payload_size_v<Blob, uint64_t, uint32_t> == expected, "the sum of the sizes, without padding");
+    EXPECT_EQ(msg.body.capacity(), expected) << "past twice the inline size, the reservation is exact";
+    const uint8_t* data = msg.body.data();
+
+    Blob blob{};
+    blob.bytes[0] = 1;
+    blob.bytes[279] = 2;
+    writer.write(blob, uint64_t(3));
+    writer << uint32_t(4);
+
+    EXPECT_EQ(msg.body.size(), expected);
+    EXPECT_EQ(msg.header.size, expected);
+    EXPECT_EQ(msg.body.capacity(), expected) << "the writes fit in the reservation";
+    EXPECT_EQ(msg.body.data(), data);
+}
+
+TEST(MessageReader, ReadsInWriteOrderWithoutTouchingTheBody) {
+    message<Msg> msg;
+    MessageWriter<Msg>(msg).write(uint8_t(1), uint32_t(2), uint16_t(3)).write(uint64_t(4));
+    ASSERT_EQ(msg.body.size(), 15u) << "written packed, without padding";
+    auto body = std::vector<uint8_t>(msg.body.begin(), msg.body.end());
+
+    MessageReader<Msg> reader(msg);
+    uint8_t a = 0;
+    uint32_t b = 0;
+    uint16_t c = 0;
+    ASSERT_TRUE(reader.read(a, b, c));
+    EXPECT_EQ(a, 1);
+    EXPECT_EQ(b, 2u);
+    EXPECT_EQ(c, 3);
+    EXPECT_EQ(reader.offset(), 7u);
+    uint64_t d = 0;
+    reader >> d;
+    EXPECT_EQ(d, 4u);
+    EXPECT_EQ(reader.remaining(), 0u);
+
+    EXPECT_EQ(std::vector<uint8_t>(msg.body.begin(), msg.body.end()), body);
+    EXPECT_EQ(msg.header.size, 15u);
+    // Read again from the start, the first reader consumed nothing
+    MessageReader<Msg> again(msg);
+    ASSERT_TRUE(again.read(a));
+    EXPECT_EQ(a, 1);
+}
+
+TEST(MessageReader, ReadingPastTheEndFailsAndReadsNothing) {
+    message<Msg> msg;
+    MessageWriter<Msg>(msg).write(uint32_t(7), uint16_t(8));
+
+    MessageReader<Msg> reader(msg);
+    uint32_t a = 0;
+    uint32_t b = 99;
+    EXPECT_FALSE(reader.read(a, b)) << "6 bytes cannot hold 8";
+    EXPECT_EQ(a, 0u) << "a failed read copies nothing, not even the fields that fit";
+    EXPECT_EQ(b, 99u);
+    EXPECT_EQ(reader.offset(), 0u);
+
+    ASSERT_TRUE(reader.read(a));
+    EXPECT_EQ(a, 7u);
+    EXPECT_FALSE(reader.read(b));
+    EXPECT_EQ(reader.remaining(), 2u);
+    Sample sample{};
+    EXPECT_FALSE(reader.unpack(sample));
+    EXPECT_EQ(reader.remaining(), 2u);
+}
+
+TEST(MessageWriter, PackAndUnpackUseTheWireLayout) {
+    Sample sample{0x0102, 1.5f, 0xAB, 0x1122334455667788};
+    static_assert(Wire<Sample>::size == 15, "2 + 4 + 1 + 8 bytes, no padding");
+
+    message<Msg> msg;
+    MessageWriter<Msg>(msg).write(uint8_t(9)).pack(sample);
+    ASSERT_EQ(msg.body.size(), 1 + Wire<Sample>::size);
+    EXPECT_EQ(msg.header.size, msg.body.size());
+
+    uint8_t encoded[Wire<Sample>::size];
+    Wire<Sample>::encode(encoded, sample);
+    EXPECT_EQ(std::vector<uint8_t>(msg.body.begin() + 1, msg.body.end()), std::vector<uint8_t>(encoded, encoded + sizeof(encoded)));
+
+    MessageReader<Msg> reader(msg);
+    uint8_t first = 0;
+    Sample decoded{};
+    ASSERT_TRUE(reader.read(first));
+    ASSERT_TRUE(reader.unpack(decoded));
+    EXPECT_EQ(first, 9);
+    EXPECT_EQ(decoded.id, sample.id);
+    EXPECT_EQ(decoded.speed, sample.speed);
+    EXPECT_EQ(decoded.flags, sample.flags);
+    EXPECT_EQ(decoded.tick, sample.tick);
+    EXPECT_EQ(reader.remaining(), 0u);
+}
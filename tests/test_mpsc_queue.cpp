@@ -0,0 +1,93 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** MpscQueue, per producer order under contention, the TsQueue operations and the drain callback
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "NetMpscQueue.hpp"
+#include "gtest/gtest.h"
+
+using RType::net::MpscQueue;
+
+TEST(MpscQueue, KeepsTheOrderOfEachProducer) {
+    constexpr uint32_t producers = 4;
+    constexpr uint32_t perProducer = 100000;
+    MpscQueue<uint64_t, 256> queue;
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p]() {
+            for (uint32_t i = 0; i < perProducer; i++)
+                queue.push_back((uint64_t(p) << 32) | i);
+        });
+    }
+
+    std::vector<uint32_t> next(producers, 0);
+    std::vector<uint64_t> batch;
+    uint64_t total = 0;
+    while (total < uint64_t(producers) * perProducer) {
+        queue.wait();
+        queue.drain_into(batch, 64);
+        for (uint64_t item : batch) {
+            uint32_t producer = static_cast<uint32_t>(item >> 32);
+            ASSERT_LT(producer, producers);
+            ASSERT_EQ(static_cast<uint32_t>(item), next[producer]) << "producer " << producer << " out of order";
+            next[producer]++;
+        }
+        total += batch.size();
+        batch.clear();
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.count(), 0u);
+}
+
+TEST(MpscQueue, ConsumerSideOperations) {
+    MpscQueue<int, 8> queue;
+    for (int i = 1; i <= 4; i++)
+        queue.push_back(i);
+
+    EXPECT_EQ(queue.front(), 1);
+    EXPECT_EQ(queue.back(), 4);
+    EXPECT_EQ(queue.pop_back(), 4);
+    queue.push_front(0);
+    queue.push_back(5);
+    EXPECT_EQ(queue.count(), 5u);
+
+    std::vector<int> popped;
+    int item = 0;
+    while (queue.try_pop(item))
+        popped.push_back(item);
+    EXPECT_EQ(popped, (std::vector<int>{0, 1, 2, 3, 5}));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, FullQueueCallsBackOnceDrained) {
+    MpscQueue<int, 8> queue;
+    int pushed = 0;
+    while (queue.try_push(pushed))
+        pushed++;
+    ASSERT_EQ(pushed, 8);
+
+    int calls = 0;
+    queue.notify_when_drained([&calls]() { calls++; });
+    queue.pop_front();
+    queue.pop_front();
+    queue.pop_front();
+    EXPECT_EQ(calls, 0) << "still more than half full";
+    queue.pop_front();
+    EXPECT_EQ(calls, 1);
+    queue.pop_front();
+    EXPECT_EQ(calls, 1) << "the callback runs once";
+
+    // Already drained, it runs right away
+    queue.notify_when_drained([&calls]() { calls++; });
+    EXPECT_EQ(calls, 2);
+}
@@ -0,0 +1,131 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Send lanes, control messages jump ahead of bulk data without starving it
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <map>
+#include <thread>
+
+#include "NetClient.hpp"
+#include "RTypeServerMessages.hpp"
+#include "TcpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+using RType::ServerMessages;
+
+namespace {
+    using SilentServer = test::TcpServerStub<ServerMessages>;
+
+    /**
+     * @brief Keeps the ids of the received messages, in order, and their bytes per id
+     */
+    class RecordingClient : public ClientInterface<ServerMessages> {
+       public:
+        std::vector<ServerMessages> received;
+        std::map<ServerMessages, uint64_t> bytes;
+
+       protected:
+        void OnMessage(message<ServerMessages>& msg) override {
+            received.push_back(msg.header.id);
+            bytes[msg.header.id] += msg.body.size();
+        }
+    };
+
+    /**
+     * @brief One server without backpressure limits and one client connected to it
+     */
+    class SendLanesTest : public testing::Test {
+       protected:
+        void Connect(uint16_t port) {
+            server_ = std::make_unique<SilentServer>(port);
+            BackpressureConfig<ServerMessages> config;
+            config.maxQueuedBytes = 0;
+            config.maxQueuedMessages = 0;
+            server_->SetBackpressure(config);
+            ASSERT_TRUE(server_->Start());
+
+            client_.ConnectToServer("127.0.0.1", port);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while ((!client_.IsConnected() || server_->GetClientCount() == 0) && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ASSERT_EQ(server_->GetClientCount(), 1u);
+            ASSERT_TRUE(server_->WaitValidated());
+            connection_ = server_->GetClients().front();
+        }
+
+        void TearDown() override {
+            client_.Disconnect();
+            if (server_)
+                server_->Stop();
+        }
+
+        RecordingClient client_;
+        std::unique_ptr<SilentServer> server_;
+        std::shared_ptr<TcpConnection<ServerMessages>> connection_;
+    };
+}  // namespace
+
+TEST_F(SendLanesTest, ControlOvertakesQueuedBulk) {
+    Connect(47101);
+    const size_t bulkCount = 512;
+    auto bulk = test::MakeMessage(ServerMessages::ServerLobbyUpdated, 8192);
+    auto deny = test::MakeMessage(ServerMessages::ServerDeny, 8);
+    // Queued from the connection strand, no write completes before the control message is in its lane
+    std::promise<void> queued;
+    asio::post(connection_->GetExecutor(), [&]() {
+        for (size_t i = 0; i < bulkCount; i++)
+            server_->MessageClient(connection_, bulk);
+        server_->MessageClient(connection_, deny);
+        queued.set_value();
+    });
+    queued.get_future().wait();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (client_.received.size() < bulkCount + 1 && std::chrono::steady_clock::now() < deadline)
+        client_.PollBatch();
+    ASSERT_EQ(client_.received.size(), bulkCount + 1);
+
+    auto control = std::find(client_.received.begin(), client_.received.end(), ServerMessages::ServerDeny);
+    ASSERT_NE(control, client_.received.end());
+    // In a single FIFO it would be last, only the first bulk message, already being written, may pass it
+    EXPECT_LE(static_cast<size_t>(control - client_.received.begin()), 1u);
+}
+
+TEST_F(SendLanesTest, BulkIsNotStarvedByAControlFlood) {
+    Connect(47102);
+    // Fits in one Bulk quantum with its header
+    auto bulk = test::MakeMessage(ServerMessages::ServerLobbyUpdated, 8000);
+    auto control = test::MakeMessage(ServerMessages::ServerAccept, 1024);
+
+    std::atomic<bool> done = false;
+    std::thread poller([this, &done]() {
+        while (!done)
+            client_.PollBatch();
+    });
+
+    // Both lanes stay non-empty, the control lane gets far more messages than it can write
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    while (std::chrono::steady_clock::now() < end) {
+        while (connection_->GetOutgoingQueueSize() < 512) {
+            server_->MessageClient(connection_, bulk);
+            for (int i = 0; i < 16; i++)
+                server_->MessageClient(connection_, control);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    done = true;
+    poller.join();
+
+    uint64_t bulkBytes = client_.bytes[ServerMessages::ServerLobbyUpdated];
+    uint64_t controlBytes = client_.bytes[ServerMessages::ServerAccept];
+    ASSERT_GT(controlBytes, 0u);
+    // The default quanta give Bulk 8KiB for every 32KiB of Control, a fifth of the bytes
+    EXPECT_GT(static_cast<double>(bulkBytes) / static_cast<double>(bulkBytes + controlBytes), 0.1)
+        << bulkBytes << " bulk bytes for " << controlBytes << " control bytes";
+}
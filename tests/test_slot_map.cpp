@@ -0,0 +1,242 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** SlotMap handles and the client registry of the server built on it
+*/
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <thread>
+
+#include "NetClient.hpp"
+#include "NetServer.hpp"
+#include "NetSlotMap.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+TEST(SlotMap, MatchesMapAndRejectsStaleHandles) {
+    SlotMap<int> map;
+    std::map<uint32_t, int> reference;
+    std::vector<uint32_t> erased;
+    std::mt19937 random(1);
+
+    for (int i = 0; i < 100000; i++) {
+        uint32_t op = random() % 3;
+        if (op == 0 || reference.empty()) {
+            int value = static_cast<int>(random());
+            auto handle = map.insert(value);
+            ASSERT_NE(handle, SlotMap<int>::InvalidHandle);
+            ASSERT_EQ(reference.count(handle), 0u) << "handle handed out twice";
+            reference[handle] = value;
+        } else {
+            auto it = reference.begin();
+            std::advance(it, random() % reference.size());
+            if (op == 1) {
+                ASSERT_TRUE(map.erase(it->first));
+                erased.push_back(it->first);
+                reference.erase(it);
+            } else {
+                auto* value = map.find(it->first);
+                ASSERT_NE(value, nullptr);
+                ASSERT_EQ(*value, it->second);
+            }
+        }
+        if (!erased.empty()) {
+            uint32_t stale = erased[random() % erased.size()];
+            ASSERT_EQ(map.find(stale), nullptr) << "stale handle reached a value";
+            ASSERT_FALSE(map.erase(stale));
+        }
+    }
+
+    ASSERT_EQ(map.size(), reference.size());
+    long long sum = 0;
+    long long expected = 0;
+    for (int value : map)
+        sum += value;
+    for (auto& [handle, value] : reference)
+        expected += value;
+    EXPECT_EQ(sum, expected);
+
+    map.erase_if([](uint32_t, int value) { return value % 2 == 0; });
+    for (int value : map)
+        EXPECT_NE(value % 2, 0);
+}
+
+TEST(SlotMap, FreeSlotIsNotFound) {
+    SlotMap<int> map;
+    auto handle = map.insert(1);
+    ASSERT_TRUE(map.erase(handle));
+    // The handle the slot will have once reused, while it is still free
+    uint32_t next = (2u << SlotMap<int>::IndexBits) | (handle & SlotMap<int>::IndexMask);
+    EXPECT_EQ(map.find(next), nullptr);
+    EXPECT_FALSE(map.erase(next));
+    EXPECT_FALSE(map.contains(handle));
+}
+
+TEST(SlotMap, ExhaustedSlotIsRetired) {
+    SlotMap<int> map;
+    std::vector<uint32_t> handles;
+    uint32_t firstIndex = 0;
+    bool moved = false;
+    for (uint32_t i = 0; i <= SlotMap<int>::GenerationMask + 1; i++) {
+        auto handle = map.insert(static_cast<int>(i));
+        if (i == 0)
+            firstIndex = handle & SlotMap<int>::IndexMask;
+        handles.push_back(handle);
+        map.erase(handle);
+        if ((handle & SlotMap<int>::IndexMask) != firstIndex) {
+            moved = true;
+            break;
+        }
+    }
+
+    EXPECT_TRUE(moved) << "a slot was reused past its last generation";
+    EXPECT_EQ(handles.size(), SlotMap<int>::GenerationMask + 1);
+    std::sort(handles.begin(), handles.end());
+    EXPECT_EQ(std::adjacent_find(handles.begin(), handles.end()), handles.end()) << "a handle came back";
+}
+
+TEST(SlotMap, FullMapRefusesInserts) {
+    SlotMap<uint8_t> map;
+    map.reserve(SlotMap<uint8_t>::IndexMask + 1);
+    uint32_t last = SlotMap<uint8_t>::InvalidHandle;
+    for (uint32_t i = 0; i <= SlotMap<uint8_t>::IndexMask; i++)
+        last = map.insert(0);
+    EXPECT_TRUE(map.full());
+    EXPECT_EQ(map.insert(0), SlotMap<uint8_t>::InvalidHandle);
+
+    ASSERT_TRUE(map.erase(last));
+    EXPECT_FALSE(map.full());
+    EXPECT_NE(map.insert(0), SlotMap<uint8_t>::InvalidHandle);
+}
+
+namespace {
+    enum class Msg : uint32_t { Data };
+
+    class CountingServer : public ServerInterface<Msg> {
+       public:
+        using ServerInterface::ServerInterface;
+
+        std::atomic<int> connected = 0;
+        std::atomic<int> disconnected = 0;
+
+       protected:
+        bool OnClientConnect(std::shared_ptr<TcpConnection<Msg>> /* client */) override {
+            connected++;
+            return true;
+        }
+        void OnClientDisconnect(std::shared_ptr<TcpConnection<Msg>> /* client */) override { disconnected++; }
+        void OnClientValidated(std::shared_ptr<TcpConnection<Msg>> /* client */) override {}
+        void OnMessage(std::shared_ptr<TcpConnection<Msg>> /* client */, message<Msg>& /* msg */) override {}
+    };
+
+    class SilentClient : public ClientInterface<Msg> {
+       protected:
+        void OnMessage(message<Msg>& /* msg */) override {}
+    };
+
+    template <typename Predicate>
+    bool WaitFor(Predicate done) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}  // namespace
+
+TEST(ClientRegistry, IdsOfDisconnectedClientsStayDead) {
+    CountingServer server(47701, 2);
+    ASSERT_TRUE(server.Start());
+    std::vector<std::unique_ptr<SilentClient>> clients;
+    for (int i = 0; i < 8; i++) {
+        clients.push_back(std::make_unique<SilentClient>());
+        clients.back()->ConnectToServer("127.0.0.1", 47701);
+    }
+    ASSERT_TRUE(WaitFor([&]() { return server.GetClientCount() == 8; }));
+
+    std::vector<uint32_t> ids;
+    {
+        auto view = server.ViewClients();
+        for (auto& client : view)
+            ids.push_back(client->GetID());
+    }
+    ASSERT_EQ(ids.size(), 8u);
+    for (auto id : ids)
+        EXPECT_NE(server.GetClientById(id), nullptr);
+
+    for (int i = 0; i < 3; i++)
+        clients[i]->Disconnect();
+    // A broadcast finds the closed connections and removes them
+    ASSERT_TRUE(WaitFor([&]() {
+        message<Msg> msg;
+        msg.header.id = Msg::Data;
+        server.MessageAllClients(msg);
+        return server.GetClientCount() == 5;
+    }));
+    EXPECT_EQ(server.disconnected, 3);
+
+    for (int i = 0; i < 3; i++) {
+        clients.push_back(std::make_unique<SilentClient>());
+        clients.back()->ConnectToServer("127.0.0.1", 47701);
+    }
+    ASSERT_TRUE(WaitFor([&]() { return server.GetClientCount() == 8; }));
+
+    // The new clients reuse the slots, never the ids
+    int live = 0;
+    for (auto id : ids)
+        live += server.GetClientById(id) != nullptr;
+    EXPECT_EQ(live, 5);
+    EXPECT_EQ(server.connected, 11);
+
+    for (auto& client : clients)
+        client->Disconnect();
+    server.Stop();
+}
+
+TEST(ClientRegistry, DisconnectIsReportedOnce) {
+    CountingServer server(47702, 2);
+    ASSERT_TRUE(server.Start());
+    std::vector<std::unique_ptr<SilentClient>> clients;
+    for (int i = 0; i < 6; i++) {
+        clients.push_back(std::make_unique<SilentClient>());
+        clients.back()->ConnectToServer("127.0.0.1", 47702);
+    }
+    ASSERT_TRUE(WaitFor([&]() { return server.GetClientCount() == 6; }));
+    auto connections = server.GetClients();
+
+    message<Msg> msg;
+    msg.header.id = Msg::Data;
+    server.MessageClient(nullptr, msg);
+    EXPECT_EQ(server.disconnected, 0) << "no client, nothing to report";
+
+    for (auto& client : clients)
+        client->Disconnect();
+    ASSERT_TRUE(WaitFor([&]() {
+        return std::none_of(connections.begin(), connections.end(), [](const auto& connection) { return connection->IsConnected(); });
+    }));
+
+    // Every thread finds the same dead clients, each one is reported by the thread that removed it
+    std::vector<std::thread> senders;
+    for (int t = 0; t < 4; t++) {
+        senders.emplace_back([&, t]() {
+            for (int i = 0; i < 50; i++) {
+                if (t % 2 == 0)
+                    server.MessageAllClients(msg);
+                else
+                    server.MessageClient(connections[i % connections.size()], msg);
+            }
+        });
+    }
+    for (auto& sender : senders)
+        sender.join();
+
+    EXPECT_EQ(server.GetClientCount(), 0u);
+    EXPECT_EQ(server.disconnected, 6);
+    server.Stop();
+}
@@ -0,0 +1,156 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** SmallVector, growth past the inline storage, moves and swaps, zero-filled resizes and message bodies across the spill
+*/
+
+#include "NetMessage.hpp"
+#include "NetSmallVector.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    constexpr size_t Inline = 8;
+    using Vector = SmallVector<uint32_t, Inline>;
+
+    /**
+     * @brief A vector of count elements whose values tell their seed and index
+     */
+    Vector Make(size_t count, uint32_t seed) {
+        Vector vector;
+        for (size_t i = 0; i < count; i++)
+            vector.push_back(seed * 1000 + static_cast<uint32_t>(i));
+        return vector;
+    }
+
+    void ExpectContent(const Vector& vector, size_t count, uint32_t seed) {
+        ASSERT_EQ(vector.size(), count);
+        EXPECT_EQ(vector.is_inline(), count <= Inline);
+        for (size_t i = 0; i < count; i++)
+            ASSERT_EQ(vector[i], seed * 1000 + i) << "element " << i;
+    }
+
+    enum class Msg : uint32_t { Data };
+}  // namespace
+
+TEST(SmallVector, GrowsPastTheInlineStorage) {
+    Vector vector;
+    EXPECT_TRUE(vector.is_inline());
+    EXPECT_EQ(vector.capacity(), Inline);
+
+    for (uint32_t i = 0; i < Inline * 5; i++) {
+        vector.push_back(i);
+        ASSERT_EQ(vector.is_inline(), vector.size() <= Inline) << "at size " << vector.size();
+        ASSERT_GE(vector.capacity(), vector.size());
+    }
+    for (uint32_t i = 0; i < Inline * 5; i++)
+        ASSERT_EQ(vector[i], i);
+
+    // Shrinking keeps the heap block
+    size_t capacity = vector.capacity();
+    vector.clear();
+    EXPECT_TRUE(vector.empty());
+    EXPECT_FALSE(vector.is_inline());
+    EXPECT_EQ(vector.capacity(), capacity);
+}
+
+TEST(SmallVector, MovesAndSwapsInlineAndHeapVectors) {
+    const size_t sizes[] = {Inline / 2, Inline * 3};
+    for (size_t left : sizes) {
+        for (size_t right : sizes) {
+            SCOPED_TRACE(testing::Message() << left << " and " << right << " elements");
+
+            // Move construction takes the heap block as is, and copies inline elements
+            Vector source = Make(left, 1);
+            const uint32_t* block = source.data();
+            Vector moved(std::move(source));
+            ExpectContent(moved, left, 1);
+            EXPECT_EQ(moved.data() == block, left > Inline);
+            EXPECT_TRUE(source.empty());
+            EXPECT_TRUE(source.is_inline());
+
+            // Move assignment over a vector of the other size
+            Vector target = Make(right, 2);
+            target = std::move(moved);
+            ExpectContent(target, left, 1);
+            EXPECT_TRUE(moved.empty());
+            moved.push_back(42);
+            EXPECT_EQ(moved[0], 42u) << "a moved-from vector is usable";
+
+            Vector a = Make(left, 3);
+            Vector b = Make(right, 4);
+            a.swap(b);
+            ExpectContent(a, right, 4);
+            ExpectContent(b, left, 3);
+
+            Vector copy = a;
+            EXPECT_EQ(copy, a);
+            EXPECT_NE(copy.data(), a.data());
+        }
+    }
+}
+
+TEST(SmallVector, ResizeZeroFills) {
+    Vector vector;
+    for (uint32_t i = 0; i < Inline; i++)
+        vector.push_back(0xFFFFFFFF);
+
+    // Shrinking leaves the old values in the inline storage, growing again zeroes them
+    vector.resize(2);
+    vector.resize(Inline);
+    for (size_t i = 2; i < Inline; i++)
+        ASSERT_EQ(vector[i], 0u) << "element " << i;
+
+    // Across the spill
+    for (size_t i = 0; i < Inline; i++)
+        vector[i] = 0xFFFFFFFF;
+    vector.resize(Inline * 4);
+    EXPECT_FALSE(vector.is_inline());
+    for (size_t i = 0; i < vector.size(); i++)
+        ASSERT_EQ(vector[i], i < Inline ? 0xFFFFFFFF : 0u) << "element " << i;
+
+    // On the heap
+    vector[Inline * 4 - 1] = 0xFFFFFFFF;
+    vector.resize(Inline);
+    vector.resize(Inline * 4);
+    EXPECT_EQ(vector[Inline * 4 - 1], 0u);
+}
+
+TEST(SmallVector, MessageBodiesRoundTripAcrossTheSpill) {
+    message<Msg> msg;
+    const uint32_t count = MessageInlineSize / sizeof(uint32_t) * 3;
+    for (uint32_t i = 0; i < count; i++) {
+        msg << i;
+        ASSERT_EQ(msg.body.is_inline(), msg.body.size() <= MessageInlineSize) << "after " << i + 1 << " pushes";
+        ASSERT_EQ(msg.header.size, msg.body.size());
+    }
+
+    for (uint32_t i = count; i-- > 0;) {
+        uint32_t value = 0;
+        msg >> value;
+        ASSERT_EQ(value, i);
+        ASSERT_EQ(msg.header.size, msg.body.size());
+    }
+    EXPECT_TRUE(msg.body.empty());
+
+    // A single push that spills a body already holding data
+    struct Big {
+        uint8_t bytes[MessageInlineSize];
+    };
+    message<Msg> mixed;
+    uint64_t head = 0x0123456789ABCDEF;
+    Big big{};
+    for (size_t i = 0; i < sizeof(big.bytes); i++)
+        big.bytes[i] = static_cast<uint8_t>(i * 3);
+    mixed << head << big;
+    EXPECT_FALSE(mixed.body.is_inline());
+
+    Big bigOut{};
+    uint64_t headOut = 0;
+    mixed >> bigOut >> headOut;
+    EXPECT_EQ(std::memcmp(bigOut.bytes, big.bytes, sizeof(big.bytes)), 0);
+    EXPECT_EQ(headOut, head);
+    EXPECT_EQ(mixed.size(), 0u);
+}
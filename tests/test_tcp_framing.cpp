@@ -0,0 +1,166 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** TCP framing, frames written in odd pieces or past a full incoming queue reach OnMessage intact and in order
+*/
+
+#include "TcpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    enum class Msg : uint32_t { Data };
+
+    /**
+     * @brief Keeps the bodies it is given, in order
+     */
+    class FramingServer : public test::TcpServerStub<Msg> {
+       public:
+        using TcpServerStub::TcpServerStub;
+
+        std::vector<std::vector<uint8_t>> bodies;
+
+       protected:
+        void OnMessage(std::shared_ptr<TcpConnection<Msg>> /* client */, message<Msg>& msg) override { bodies.emplace_back(msg.body.begin(), msg.body.end()); }
+    };
+
+    constexpr size_t HeaderSize = sizeof(message_header<Msg>);
+
+    /**
+     * @brief Body of the frame number index, its bytes tell the frame and the offset
+     */
+    std::vector<uint8_t> Body(size_t index, size_t size) {
+        std::vector<uint8_t> body(size);
+        for (size_t i = 0; i < size; i++)
+            body[i] = static_cast<uint8_t>(index * 31 + i);
+        return body;
+    }
+
+    /**
+     * @brief Append the frame of body to stream and return its offset
+     */
+    size_t AppendFrame(std::vector<uint8_t>& stream, const std::vector<uint8_t>& body) {
+        size_t offset = stream.size();
+        message_header<Msg> header{Msg::Data, static_cast<uint32_t>(body.size())};
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&header);
+        stream.insert(stream.end(), bytes, bytes + HeaderSize);
+        stream.insert(stream.end(), body.begin(), body.end());
+        return offset;
+    }
+
+    class TcpFramingTest : public testing::Test {
+       protected:
+        void Start(uint16_t port) {
+            server_ = std::make_unique<FramingServer>(port);
+            ASSERT_TRUE(server_->Start());
+            client_ = std::make_unique<test::RawTcpClient>(port);
+            ASSERT_TRUE(server_->WaitValidated());
+        }
+
+        void TearDown() override {
+            if (server_)
+                server_->Stop();
+        }
+
+        /**
+         * @brief Poll the server until as many bodies as expected arrived, then compare them
+         */
+        void ExpectBodies(const std::vector<std::vector<uint8_t>>& expected) {
+            ASSERT_TRUE(test::WaitFor([&]() {
+                server_->Update();
+                return server_->bodies.size() >= expected.size();
+            })) << "only " << server_->bodies.size() << " of " << expected.size() << " messages arrived";
+            ASSERT_EQ(server_->bodies.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); i++)
+                ASSERT_EQ(server_->bodies[i], expected[i]) << "message " << i;
+        }
+
+        std::unique_ptr<FramingServer> server_;
+        std::unique_ptr<test::RawTcpClient> client_;
+    };
+}  // namespace
+
+TEST_F(TcpFramingTest, FramesCutAnywhereArriveIntact) {
+    Start(48101);
+    // Larger than the receive buffer, so it has to grow for it
+    const size_t bigSize = TcpConnection<Msg>::ReadBufferSize * 2 + 123;
+    const size_t sizes[] = {10, 0, 300, bigSize, 5};
+    std::vector<std::vector<uint8_t>> expected;
+    std::vector<uint8_t> stream;
+    std::vector<size_t> offsets;
+    for (size_t size : sizes) {
+        expected.push_back(Body(expected.size(), size));
+        offsets.push_back(AppendFrame(stream, expected.back()));
+    }
+
+    const size_t cuts[] = {
+        1,                                                                 // A single byte
+        offsets[0] + HeaderSize / 2,                                       // A header cut in the middle
+        offsets[0] + HeaderSize + 4,                                       // A body cut in the middle
+        offsets[2] + 3,                                                    // The rest, an empty frame and a header start
+        offsets[3] + HeaderSize + 1000,                                    // The big frame, with only its start
+        offsets[3] + HeaderSize + TcpConnection<Msg>::ReadBufferSize + 7,  // Past the initial buffer size
+        stream.size(),
+    };
+    size_t written = 0;
+    for (size_t cut : cuts) {
+        client_->Write(stream, written, cut);
+        written = cut;
+    }
+    ExpectBodies(expected);
+
+    // Then a long run written in pieces of 1 to 13 bytes
+    stream.clear();
+    for (size_t i = 0; i < 100; i++) {
+        expected.push_back(Body(expected.size(), i % 37));
+        AppendFrame(stream, expected.back());
+    }
+    written = 0;
+    for (size_t piece = 1; written < stream.size(); piece = piece % 13 + 1) {
+        size_t cut = std::min(stream.size(), written + piece);
+        client_->Write(stream, written, cut);
+        written = cut;
+    }
+    ExpectBodies(expected);
+}
+
+TEST_F(TcpFramingTest, FullIncomingQueueResumesMidBuffer) {
+    Start(48102);
+    // Frames of 18 bytes never line up with the end of a read, the queue fills with frames left in the buffer
+    const size_t count = 6000;
+    std::vector<std::vector<uint8_t>> expected;
+    std::vector<uint8_t> stream;
+    for (size_t i = 0; i < count; i++) {
+        expected.push_back(Body(i, 10));
+        AppendFrame(stream, expected.back());
+    }
+    client_->Write(stream, 0, stream.size());
+
+#ifndef RTYPE_NET_LOCKED_INCOMING_QUEUE
+    // Nobody polls yet, reading pauses once the queue is full
+    const size_t capacity = IncomingQueue<owned_message<Msg, TcpConnection<Msg>>>::capacity();
+    ASSERT_TRUE(test::WaitFor([&]() { return server_->GetStats().messagesIn >= capacity; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(server_->GetStats().messagesIn, capacity) << "frames were parsed past a full queue";
+#endif
+
+    ExpectBodies(expected);
+    EXPECT_EQ(server_->GetStats().messagesIn, count);
+}
+
+TEST_F(TcpFramingTest, ServerDestroyedWhileReadingIsPaused) {
+    Start(48103);
+    std::vector<uint8_t> stream;
+    for (size_t i = 0; i < 6000; i++)
+        AppendFrame(stream, Body(i, 10));
+    client_->Write(stream, 0, stream.size());
+
+#ifndef RTYPE_NET_LOCKED_INCOMING_QUEUE
+    const size_t capacity = IncomingQueue<owned_message<Msg, TcpConnection<Msg>>>::capacity();
+    ASSERT_TRUE(test::WaitFor([&]() { return server_->GetStats().messagesIn >= capacity; }));
+#endif
+    // The paused connection and the queued messages are released before the context
+    server_.reset();
+}
@@ -0,0 +1,207 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** TickScheduler, a steady rate, bounded catch-up after overruns, and the order of a tick
+*/
+
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "NetTickScheduler.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    /**
+     * @brief Run the ticks of scheduler on this thread for duration
+     */
+    void RunFor(asio::io_context& context, TickScheduler& scheduler, std::chrono::milliseconds duration) {
+        ASSERT_TRUE(scheduler.Start());
+        std::thread stopper([&]() {
+            std::this_thread::sleep_for(duration);
+            scheduler.Stop();
+        });
+        context.run();
+        stopper.join();
+        context.restart();
+    }
+
+    /**
+     * @brief Records the ticks of a scheduler and stops it after count of them
+     *
+     * Nothing here depends on how fast the machine runs, so the tests only assert
+     * what the schedule guarantees whatever the load.
+     */
+    struct Recorder {
+        Recorder(TickScheduler& scheduler, size_t count, std::function<void(const TickInfo&)> work = nullptr) {
+            scheduler.SetStep([this, &scheduler, count, work](const TickInfo& info) {
+                ticks.push_back(info);
+                started.push_back(std::chrono::steady_clock::now());
+                if (work)
+                    work(info);
+                ended.push_back(std::chrono::steady_clock::now());
+                if (ticks.size() == count)
+                    scheduler.Stop();
+            });
+        }
+
+        std::vector<TickInfo> ticks;
+        std::vector<std::chrono::steady_clock::time_point> started;  ///< When each step started
+        std::vector<std::chrono::steady_clock::time_point> ended;    ///< When each step returned
+    };
+
+    /**
+     * @brief The invariants of every run: slots in order, deadlines on the fixed schedule, never early
+     */
+    void ExpectOnSchedule(const Recorder& recorder, const TickStats& stats) {
+        const auto& ticks = recorder.ticks;
+        ASSERT_FALSE(ticks.empty());
+        EXPECT_EQ(ticks.front().index, 0u);
+        EXPECT_EQ(stats.ticks, ticks.size());
+        EXPECT_EQ(stats.ticks + stats.skippedTicks, ticks.back().index + 1);
+        for (size_t i = 0; i < ticks.size(); i++) {
+            if (i > 0)
+                ASSERT_GT(ticks[i].index, ticks[i - 1].index) << "tick " << i;
+            ASSERT_EQ(ticks[i].deadline, ticks.front().deadline + stats.period * ticks[i].index) << "tick " << i;
+            ASSERT_GE(recorder.started[i], ticks[i].deadline) << "tick " << i << " ran early";
+            ASSERT_GE(ticks[i].lateness.count(), 0) << "tick " << i;
+        }
+    }
+}  // namespace
+
+TEST(TickScheduler, KeepsItsRate) {
+    asio::io_context context;
+    TickScheduler scheduler(context, 100);
+    // Work shorter than the period must not push the next deadlines back
+    Recorder recorder(scheduler, 30, [](const TickInfo&) {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(3);
+        while (std::chrono::steady_clock::now() < end) {
+        }
+    });
+    ASSERT_TRUE(scheduler.Start());
+    context.run();
+
+    auto stats = scheduler.GetStats();
+    EXPECT_EQ(stats.period, std::chrono::milliseconds(10));
+    ExpectOnSchedule(recorder, stats);
+}
+
+TEST(TickScheduler, LateTicksCatchUp) {
+    asio::io_context context;
+    TickScheduler scheduler(context, 100);
+    // However loaded the machine, no late tick is skipped
+    scheduler.SetMaxCatchUp(1000);
+    Recorder recorder(scheduler, 10, [](const TickInfo& info) {
+        if (info.index == 5)
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    });
+    ASSERT_TRUE(scheduler.Start());
+    context.run();
+
+    auto stats = scheduler.GetStats();
+    ExpectOnSchedule(recorder, stats);
+    EXPECT_GE(stats.overruns, 1u);
+    EXPECT_EQ(stats.skippedTicks, 0u);
+    const auto& ticks = recorder.ticks;
+    for (size_t i = 0; i < ticks.size(); i++)
+        ASSERT_EQ(ticks[i].index, i);
+    // The ticks due during the spike run late, back to back, on the unchanged schedule
+    EXPECT_GE(ticks[6].lateness, std::chrono::milliseconds(15));
+    EXPECT_GE(ticks[7].lateness, std::chrono::milliseconds(5));
+}
+
+TEST(TickScheduler, CatchUpIsBounded) {
+    asio::io_context context;
+    TickScheduler scheduler(context, 100);
+    scheduler.SetMaxCatchUp(3);
+    Recorder recorder(scheduler, 10, [](const TickInfo& info) {
+        if (info.index == 5)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    });
+    ASSERT_TRUE(scheduler.Start());
+    context.run();
+
+    auto stats = scheduler.GetStats();
+    ExpectOnSchedule(recorder, stats);
+    const auto& ticks = recorder.ticks;
+    size_t spike = 0;
+    while (ticks[spike].index != 5)
+        spike++;
+    // 10 ticks were due during the spike, all but 3 of them are skipped
+    ASSERT_LT(spike + 1, ticks.size());
+    EXPECT_GE(ticks[spike + 1].index - ticks[spike].index - 1, 7u);
+    // The next tick is the first of the 3 late ones
+    EXPECT_GE(ticks[spike + 1].lateness, stats.period * 2);
+}
+
+TEST(TickScheduler, OverrunsSkipTicksPastTheCatchUp) {
+    asio::io_context context;
+    TickScheduler scheduler(context, 100);
+    scheduler.SetMaxCatchUp(0);
+    Recorder recorder(scheduler, 8, [&](const TickInfo&) {
+        if (recorder.ticks.size() == 5)
+            std::this_thread::sleep_for(std::chrono::milliseconds(35));
+    });
+    ASSERT_TRUE(scheduler.Start());
+    context.run();
+
+    auto stats = scheduler.GetStats();
+    ExpectOnSchedule(recorder, stats);
+    EXPECT_GE(stats.overruns, 1u);
+    EXPECT_GE(stats.skippedTicks, 3u);
+    const auto& ticks = recorder.ticks;
+    EXPECT_GE(ticks[5].index - ticks[4].index, 4u) << "the ticks covered by the overrun are skipped, not run late";
+    // Without catch-up, a tick after a gap is never due before the previous one ended
+    for (size_t i = 1; i < ticks.size(); i++) {
+        if (ticks[i].index > ticks[i - 1].index + 1)
+            EXPECT_GT(ticks[i].deadline, recorder.ended[i - 1]) << "tick " << i;
+    }
+}
+
+
+TEST(TickScheduler, PollsStepAndFlushesRunInOrder) {
+    asio::io_context context;
+    TickScheduler scheduler(context, 200);
+    std::string order;
+    scheduler.AddPoll([&]() { order += 'p'; });
+    scheduler.AddPoll([&]() { order += 'q'; });
+    scheduler.AddFlush([&]() { order += 'f'; });
+    scheduler.SetStep([&](const TickInfo& info) {
+        order += 's';
+        if (info.index == 2)
+            scheduler.Stop();
+    });
+    ASSERT_TRUE(scheduler.Start());
+    context.run();
+
+    EXPECT_EQ(order, "pqsfpqsfpqsf") << "a stopped scheduler completes the running tick and no other";
+    EXPECT_FALSE(scheduler.IsRunning());
+}
+
+TEST(TickScheduler, RestartsAfterStop) {
+    asio::io_context context;
+    TickScheduler scheduler(context, 200);
+    std::vector<uint64_t> indices;
+    scheduler.SetStep([&](const TickInfo& info) { indices.push_back(info.index); });
+    ASSERT_TRUE(scheduler.Start());
+    EXPECT_FALSE(scheduler.Start()) << "already running";
+    scheduler.Stop();
+    context.run();
+    context.restart();
+    RunFor(context, scheduler, std::chrono::milliseconds(50));
+    EXPECT_FALSE(scheduler.IsRunning());
+    size_t first = indices.size();
+    ASSERT_GT(first, 0u);
+    EXPECT_EQ(indices.front(), 0u);
+
+    // The rate only changes while stopped, the restart counts its ticks from 0 again
+    scheduler.SetRate(100);
+    EXPECT_EQ(scheduler.GetPeriod(), std::chrono::milliseconds(10));
+    RunFor(context, scheduler, std::chrono::milliseconds(50));
+    ASSERT_GT(indices.size(), first);
+    EXPECT_EQ(indices[first], 0u);
+    EXPECT_EQ(scheduler.GetStats().ticks, indices.size());
+}
@@ -0,0 +1,209 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** TimerWheel, cascading across levels and cancel against fire
+*/
+
+#include <atomic>
+#include <thread>
+
+#include "NetTimerWheel.hpp"
+#include "gtest/gtest.h"
+
+using RType::net::TimerWheel;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    /**
+     * @brief A wheel whose context runs on its own thread for the duration of a test
+     */
+    class TimerWheelTest : public testing::Test {
+       protected:
+        void SetUp() override {
+            thread_ = std::thread([this]() { context_.run(); });
+        }
+
+        void TearDown() override {
+            work_.reset();
+            context_.stop();
+            thread_.join();
+        }
+
+        /**
+         * @brief Wait until done returns true, at most timeout
+         */
+        template <typename Predicate>
+        static bool WaitFor(Predicate done, std::chrono::milliseconds timeout) {
+            auto deadline = Clock::now() + timeout;
+            while (!done()) {
+                if (Clock::now() > deadline)
+                    return false;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return true;
+        }
+
+        asio::io_context context_;
+        asio::executor_work_guard<asio::io_context::executor_type> work_ = asio::make_work_guard(context_);
+        TimerWheel wheel_{context_};
+        std::thread thread_;
+    };
+}  // namespace
+
+TEST_F(TimerWheelTest, FiresEachTimerOnceAndNeverEarly) {
+    const int count = 200;
+    std::vector<Clock::time_point> due(count);
+    std::vector<Clock::time_point> fired(count);
+    std::atomic<int> calls = 0;
+
+    for (int i = 0; i < count; i++) {
+        auto delay = std::chrono::milliseconds(i % 50);
+        due[i] = Clock::now() + delay;
+        wheel_.AddTimer(delay, [&, i]() {
+            fired[i] = Clock::now();
+            calls++;
+        });
+    }
+
+    ASSERT_TRUE(WaitFor([&]() { return calls == count; }, std::chrono::seconds(5)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(calls, count);
+    EXPECT_EQ(wheel_.GetTimerCount(), 0u);
+    for (int i = 0; i < count; i++)
+        EXPECT_GE(fired[i], due[i]) << "timer " << i << " fired early";
+}
+
+TEST_F(TimerWheelTest, CascadesAcrossLevels) {
+    // Level 0 holds 64 ticks, level 1 up to 64^2, level 2 up to 64^3, the boundaries on both sides
+    const std::vector<int> delays = {1, 63, 64, 65, 130, 4095, 4096, 4200};
+    std::vector<Clock::time_point> due(delays.size());
+    std::vector<Clock::time_point> fired(delays.size());
+    std::vector<int> order;
+    std::mutex mutex;
+
+    for (size_t i = 0; i < delays.size(); i++) {
+        due[i] = Clock::now() + std::chrono::milliseconds(delays[i]);
+        wheel_.AddTimer(std::chrono::milliseconds(delays[i]), [&, i]() {
+            std::scoped_lock lock(mutex);
+            fired[i] = Clock::now();
+            order.push_back(static_cast<int>(i));
+        });
+    }
+
+    ASSERT_TRUE(WaitFor(
+        [&]() {
+            std::scoped_lock lock(mutex);
+            return order.size() == delays.size();
+        },
+        std::chrono::seconds(10)));
+
+    std::scoped_lock lock(mutex);
+    for (size_t i = 0; i < delays.size(); i++) {
+        EXPECT_EQ(order[i], static_cast<int>(i)) << "timers fired out of order";
+        EXPECT_GE(fired[i], due[i]) << delays[i] << "ms timer fired early";
+        EXPECT_LT(fired[i] - due[i], std::chrono::milliseconds(250)) << delays[i] << "ms timer fired late";
+    }
+    EXPECT_EQ(wheel_.GetTimerCount(), 0u);
+}
+
+TEST_F(TimerWheelTest, CancelledTimersNeverFire) {
+    const int count = 1000;
+    std::vector<TimerWheel::Handle> handles(count);
+    std::vector<std::atomic<int>> calls(count);
+
+    for (int i = 0; i < count; i++)
+        handles[i] = wheel_.AddTimer(std::chrono::milliseconds(20 + i % 40), [&calls, i]() { calls[i]++; });
+    for (int i = 0; i < count; i += 2)
+        EXPECT_TRUE(wheel_.CancelTimer(handles[i]));
+    EXPECT_EQ(wheel_.GetTimerCount(), static_cast<size_t>(count / 2));
+
+    ASSERT_TRUE(WaitFor([&]() { return wheel_.GetTimerCount() == 0; }, std::chrono::seconds(5)));
+    for (int i = 0; i < count; i++)
+        EXPECT_EQ(calls[i], i % 2 == 0 ? 0 : 1) << "timer " << i;
+    EXPECT_FALSE(wheel_.CancelTimer(handles[1])) << "a fired timer can't be cancelled";
+    EXPECT_FALSE(wheel_.CancelTimer(handles[0])) << "a timer can't be cancelled twice";
+}
+
+TEST_F(TimerWheelTest, CancelRacingFireCallsExactlyOneSide) {
+    // Cancel from this thread while the context fires the same timers, each timer must
+    // either fire or be cancelled, never both and never neither
+    const int rounds = 20;
+    const int count = 500;
+    for (int round = 0; round < rounds; round++) {
+        std::vector<TimerWheel::Handle> handles(count);
+        std::vector<std::atomic<int>> calls(count);
+        for (int i = 0; i < count; i++)
+            handles[i] = wheel_.AddTimer(std::chrono::milliseconds(i % 4), [&calls, i]() { calls[i]++; });
+        // Start cancelling while some of the timers are being fired
+        std::this_thread::sleep_for(std::chrono::microseconds(500 * (round % 6)));
+
+        std::vector<bool> cancelled(count);
+        int cancelledCount = 0;
+        for (int i = count - 1; i >= 0; i--) {
+            cancelled[i] = wheel_.CancelTimer(handles[i]);
+            cancelledCount += cancelled[i];
+        }
+
+        auto settled = [&]() {
+            int total = cancelledCount;
+            for (auto& call : calls)
+                total += call;
+            return total >= count;
+        };
+        ASSERT_TRUE(WaitFor(settled, std::chrono::seconds(5))) << "round " << round;
+        EXPECT_EQ(wheel_.GetTimerCount(), 0u);
+        for (int i = 0; i < count; i++)
+            ASSERT_EQ(calls[i] + (cancelled[i] ? 1 : 0), 1) << "round " << round << " timer " << i;
+    }
+}
+
+TEST_F(TimerWheelTest, CancelFromACallbackOfTheSameTick) {
+    // Both timers are due on the same tick, once the first runs the second is already out of the wheel
+    std::atomic<int> secondCalls = 0;
+    std::atomic<bool> cancelled = false;
+    std::atomic<bool> done = false;
+    TimerWheel::Handle second = TimerWheel::InvalidHandle;
+    std::mutex mutex;
+
+    {
+        std::scoped_lock lock(mutex);
+        wheel_.AddTimer(std::chrono::milliseconds(10), [&]() {
+            std::scoped_lock inner(mutex);
+            cancelled = wheel_.CancelTimer(second);
+            done = true;
+        });
+        second = wheel_.AddTimer(std::chrono::milliseconds(10), [&]() { secondCalls++; });
+    }
+
+    ASSERT_TRUE(WaitFor([&]() { return done && (cancelled || secondCalls > 0); }, std::chrono::seconds(5)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(secondCalls + (cancelled ? 1 : 0), 1);
+}
+
+TEST_F(TimerWheelTest, StaleHandleDoesNotCancelTheReusedNode) {
+    std::atomic<int> firstCalls = 0;
+    std::atomic<int> secondCalls = 0;
+
+    TimerWheel::Handle first = wheel_.AddTimer(std::chrono::milliseconds(1), [&]() { firstCalls++; });
+    ASSERT_TRUE(WaitFor([&]() { return firstCalls == 1; }, std::chrono::seconds(5)));
+
+    TimerWheel::Handle second = wheel_.AddTimer(std::chrono::milliseconds(20), [&]() { secondCalls++; });
+    EXPECT_NE(first, second);
+    EXPECT_FALSE(wheel_.CancelTimer(first));
+    EXPECT_EQ(wheel_.GetTimerCount(), 1u);
+
+    ASSERT_TRUE(WaitFor([&]() { return secondCalls == 1; }, std::chrono::seconds(5)));
+}
+
+TEST_F(TimerWheelTest, CallbacksCanAddTimers) {
+    std::atomic<int> chain = 0;
+    std::function<void()> next = [&]() {
+        if (++chain < 10)
+            wheel_.AddTimer(std::chrono::milliseconds(2), next);
+    };
+    wheel_.AddTimer(std::chrono::milliseconds(2), next);
+
+    ASSERT_TRUE(WaitFor([&]() { return chain == 10; }, std::chrono::seconds(5)));
+    EXPECT_EQ(wheel_.GetTimerCount(), 0u);
+}
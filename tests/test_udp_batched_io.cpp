@@ -0,0 +1,134 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Batched UDP I/O, recvmmsg and sendmmsg against the plain datagram path
+*/
+
+#include <set>
+
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using test::UdpPeer;
+
+namespace {
+    /**
+     * @brief Datagram of size bytes starting with the sequence number, then filled with it
+     */
+    std::vector<uint8_t> MakeDatagram(uint32_t sequence, size_t size) {
+        std::vector<uint8_t> data(std::max(size, sizeof(sequence)), static_cast<uint8_t>(sequence));
+        std::memcpy(data.data(), &sequence, sizeof(sequence));
+        return data;
+    }
+
+    size_t SizeOf(uint32_t sequence) { return 4 + (sequence * 37) % 1400; }
+
+    /**
+     * @brief Every sequence in [0, count) was received once with its content intact
+     */
+    void ExpectEveryDatagram(const std::vector<UdpPeer::Datagram>& received, uint32_t count) {
+        std::set<uint32_t> seen;
+        for (const auto& datagram : received) {
+            ASSERT_GE(datagram.data.size(), sizeof(uint32_t));
+            uint32_t sequence = 0;
+            std::memcpy(&sequence, datagram.data.data(), sizeof(sequence));
+            ASSERT_LT(sequence, count);
+            EXPECT_TRUE(seen.insert(sequence).second) << "datagram " << sequence << " received twice";
+            EXPECT_EQ(datagram.data, MakeDatagram(sequence, SizeOf(sequence))) << "datagram " << sequence << " corrupted";
+        }
+        EXPECT_EQ(seen.size(), count);
+    }
+}  // namespace
+
+TEST(UdpBatchedIo, BatchedPeersExchangeEveryDatagram) {
+    test::IoThread io;
+    auto sender = std::make_shared<UdpPeer>(io.context, 47201);
+    auto receiver = std::make_shared<UdpPeer>(io.context, 47202);
+    if (!sender->EnableBatchedIo(64) || !receiver->EnableBatchedIo(64))
+        GTEST_SKIP() << "batched I/O is not available on this platform";
+    ASSERT_TRUE(sender->StartAndWait());
+    ASSERT_TRUE(receiver->StartAndWait());
+    receiver->GetSocket().set_option(asio::socket_base::receive_buffer_size(4 << 20));
+
+    const uint32_t count = 2000;
+    for (uint32_t i = 0; i < count; i++) {
+        auto data = MakeDatagram(i, SizeOf(i));
+        ASSERT_TRUE(sender->SendAsync(test::Loopback(47202), data.data(), data.size()));
+        // One flush per tick of 100 datagrams, each leaves in a couple of sendmmsg calls
+        if (i % 100 == 99) {
+            sender->Flush();
+            ASSERT_TRUE(test::WaitFor([&]() { return sender->GetSendQueueSize() == 0; }));
+        }
+    }
+    sender->Flush();
+
+    ASSERT_TRUE(test::WaitFor([&]() { return receiver->received == count; })) << receiver->received << " of " << count;
+    EXPECT_EQ(sender->sent, count);
+    auto received = receiver->Received();
+    ExpectEveryDatagram(received, count);
+    for (const auto& datagram : received)
+        EXPECT_EQ(datagram.sender.port(), 47201);
+
+    sender->Stop();
+    receiver->Stop();
+}
+
+TEST(UdpBatchedIo, RecvmmsgDrainsABurst) {
+    test::IoThread io;
+    auto receiver = std::make_shared<UdpPeer>(io.context, 47203);
+    if (!receiver->EnableBatchedIo(16))
+        GTEST_SKIP() << "batched I/O is not available on this platform";
+    ASSERT_TRUE(receiver->StartAndWait());
+    receiver->GetSocket().set_option(asio::socket_base::receive_buffer_size(4 << 20));
+
+    // Sent back to back from a plain socket, the receiver finds full batches waiting
+    asio::io_context context;
+    asio::ip::udp::socket socket(context, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+    const uint32_t count = 1000;
+    for (uint32_t i = 0; i < count; i++)
+        socket.send_to(asio::buffer(MakeDatagram(i, SizeOf(i))), test::Loopback(47203));
+
+    ASSERT_TRUE(test::WaitFor([&]() { return receiver->received == count; })) << receiver->received << " of " << count;
+    auto received = receiver->Received();
+    ExpectEveryDatagram(received, count);
+    for (const auto& datagram : received)
+        EXPECT_EQ(datagram.sender.port(), socket.local_endpoint().port());
+    EXPECT_EQ(receiver->GetDatagramsDropped(), 0u);
+
+    receiver->Stop();
+}
+
+TEST(UdpBatchedIo, SendsWaitForFlush) {
+    test::IoThread io;
+    auto sender = std::make_shared<UdpPeer>(io.context, 47204);
+    auto receiver = std::make_shared<UdpPeer>(io.context, 47205);
+    if (!sender->EnableBatchedIo(8))
+        GTEST_SKIP() << "batched I/O is not available on this platform";
+    ASSERT_TRUE(sender->StartAndWait());
+    ASSERT_TRUE(receiver->StartAndWait());
+
+    for (uint32_t i = 0; i < 20; i++) {
+        auto data = MakeDatagram(i, SizeOf(i));
+        ASSERT_TRUE(sender->SendAsync(test::Loopback(47205), data.data(), data.size()));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(receiver->received, 0u);
+    EXPECT_EQ(sender->GetSendQueueSize(), 20u);
+
+    // 20 datagrams in batches of 8
+    sender->Flush();
+    ASSERT_TRUE(test::WaitFor([&]() { return receiver->received == 20; }));
+    ExpectEveryDatagram(receiver->Received(), 20);
+
+    sender->Stop();
+    receiver->Stop();
+}
+
+TEST(UdpBatchedIo, EnableAfterStartIsRefused) {
+    test::IoThread io;
+    auto peer = std::make_shared<UdpPeer>(io.context, 47206);
+    ASSERT_TRUE(peer->StartAndWait());
+    EXPECT_FALSE(peer->EnableBatchedIo(32));
+    peer->Stop();
+}
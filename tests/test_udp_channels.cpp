@@ -0,0 +1,170 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** UdpChannels, delivery over a lossy link and the limits on tracked endpoints
+*/
+
+#include <random>
+
+#include "NetUdpChannels.hpp"
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using RType::net::UdpChannel;
+using RType::net::UdpChannels;
+using RType::net::UdpPeerLoss;
+
+namespace {
+    /**
+     * @brief Drops a fixed share of the datagrams it receives, forwards the others to its channels
+     */
+    class LossyPeer : public test::UdpPeer {
+       public:
+        using UdpPeer::UdpPeer;
+
+        std::shared_ptr<UdpChannels> channels;
+        int dropPercent = 30;
+
+       protected:
+        void onReceived(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) override {
+            if (static_cast<int>(random_() % 100) >= dropPercent)
+                channels->Receive(endpoint, buffer, size);
+            ReceiveAsync();
+        }
+
+       private:
+        std::mt19937 random_{1};
+    };
+
+    /**
+     * @brief Channels over a connection that is never started, driven by hand through Receive and Update
+     */
+    class UdpChannelsLimitsTest : public testing::Test {
+       protected:
+        void SetUp() override {
+            channels_->SetPeerLostHandler([this](const asio::ip::udp::endpoint& endpoint, UdpPeerLoss loss) { lost_.emplace_back(endpoint, loss); });
+        }
+
+        static asio::ip::udp::endpoint Remote(uint16_t port) { return asio::ip::udp::endpoint(asio::ip::make_address("10.0.0.1"), port); }
+
+        void ReceiveFrom(const asio::ip::udp::endpoint& endpoint, uint8_t kind) {
+            uint8_t datagram[UdpChannels::HeaderSize] = {UdpChannels::PacketMarker, kind};
+            channels_->Receive(endpoint, datagram, sizeof(datagram));
+        }
+
+        asio::io_context context_;
+        std::shared_ptr<test::UdpPeer> connection_ = std::make_shared<test::UdpPeer>(context_, 0);
+        std::shared_ptr<UdpChannels> channels_ = std::make_shared<UdpChannels>(*connection_, [](const asio::ip::udp::endpoint&, UdpChannel, const uint8_t*, size_t) {});
+        std::vector<std::pair<asio::ip::udp::endpoint, UdpPeerLoss>> lost_;
+    };
+}  // namespace
+
+TEST(UdpChannels, ReliableOrderedSurvivesLoss) {
+    test::IoThread io;
+    auto sender = std::make_shared<LossyPeer>(io.context, 47301);
+    auto receiver = std::make_shared<LossyPeer>(io.context, 47302);
+
+    std::mutex mutex;
+    std::vector<uint32_t> reliable;
+    std::vector<uint32_t> sequenced;
+    sender->channels = std::make_shared<UdpChannels>(*sender, [](const asio::ip::udp::endpoint&, UdpChannel, const uint8_t*, size_t) {});
+    receiver->channels = std::make_shared<UdpChannels>(*receiver, [&](const asio::ip::udp::endpoint&, UdpChannel channel, const uint8_t* data, size_t size) {
+        ASSERT_EQ(size, sizeof(uint32_t));
+        uint32_t value = 0;
+        std::memcpy(&value, data, sizeof(value));
+        std::scoped_lock lock(mutex);
+        (channel == UdpChannel::ReliableOrdered ? reliable : sequenced).push_back(value);
+    });
+    // At 30% loss each way a message can miss 10 resends, the link must not be given up on that
+    std::atomic<int> lost = 0;
+    sender->channels->SetMaxRetransmits(100);
+    sender->channels->SetPeerLostHandler([&](const asio::ip::udp::endpoint&, UdpPeerLoss) { lost++; });
+    ASSERT_TRUE(sender->StartAndWait());
+    ASSERT_TRUE(receiver->StartAndWait());
+    asio::post(io.context, [&]() {
+        sender->channels->Start();
+        receiver->channels->Start();
+    });
+
+    const uint32_t count = 300;
+    for (uint32_t i = 0; i < count; i++) {
+        ASSERT_TRUE(sender->channels->Send(test::Loopback(47302), UdpChannel::ReliableOrdered, &i, sizeof(i)));
+        ASSERT_TRUE(sender->channels->Send(test::Loopback(47302), UdpChannel::UnreliableSequenced, &i, sizeof(i)));
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    ASSERT_TRUE(test::WaitFor(
+        [&]() {
+            std::scoped_lock lock(mutex);
+            return reliable.size() >= count;
+        },
+        std::chrono::seconds(10)));
+    ASSERT_TRUE(test::WaitFor([&]() { return sender->channels->GetPendingReliable(test::Loopback(47302)) == 0; }));
+    EXPECT_EQ(lost, 0) << "the receiver was given up";
+
+    std::scoped_lock lock(mutex);
+    ASSERT_EQ(reliable.size(), count) << "delivered more than once";
+    for (uint32_t i = 0; i < count; i++)
+        ASSERT_EQ(reliable[i], i) << "delivered out of order";
+    // A third of them are lost, the others never go backwards
+    EXPECT_GT(sequenced.size(), 0u);
+    EXPECT_LT(sequenced.size(), count);
+    for (size_t i = 1; i < sequenced.size(); i++)
+        EXPECT_GT(sequenced[i], sequenced[i - 1]);
+    EXPECT_GT(sender->channels->GetRtt(test::Loopback(47302)).count(), 0);
+
+    asio::post(io.context, [&]() {
+        sender->channels->Stop();
+        receiver->channels->Stop();
+    });
+}
+
+TEST_F(UdpChannelsLimitsTest, BareAcksFromUnknownEndpointsAreIgnored) {
+    for (uint16_t port = 1000; port < 1010; port++)
+        ReceiveFrom(Remote(port), 0x7F);
+    EXPECT_EQ(channels_->GetPeerCount(), 0u);
+}
+
+TEST_F(UdpChannelsLimitsTest, NewEndpointsAreRefusedAtTheCap) {
+    channels_->SetMaxPeers(4);
+    for (uint16_t port = 1000; port < 1010; port++)
+        ReceiveFrom(Remote(port), static_cast<uint8_t>(UdpChannel::Unreliable));
+    EXPECT_EQ(channels_->GetPeerCount(), 4u);
+
+    EXPECT_FALSE(channels_->Send(Remote(2000), UdpChannel::Unreliable, "x", 1));
+    EXPECT_TRUE(channels_->Send(Remote(1000), UdpChannel::Unreliable, "x", 1));
+    EXPECT_EQ(channels_->GetPeerCount(), 4u);
+}
+
+TEST_F(UdpChannelsLimitsTest, IdleEndpointsAreForgotten) {
+    for (uint16_t port = 1000; port < 1003; port++)
+        ReceiveFrom(Remote(port), static_cast<uint8_t>(UdpChannel::Unreliable));
+    channels_->SetIdleTimeout(std::chrono::milliseconds(50));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    ReceiveFrom(Remote(1000), static_cast<uint8_t>(UdpChannel::Unreliable));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    channels_->Update();
+
+    EXPECT_EQ(channels_->GetPeerCount(), 1u);
+    ASSERT_EQ(lost_.size(), 2u);
+    for (const auto& [endpoint, loss] : lost_) {
+        EXPECT_NE(endpoint, Remote(1000));
+        EXPECT_EQ(loss, UdpPeerLoss::IdleTimeout);
+    }
+}
+
+TEST_F(UdpChannelsLimitsTest, UnacknowledgedEndpointsAreGivenUp) {
+    channels_->SetIdleTimeout(std::chrono::milliseconds(0));
+    channels_->SetMaxRetransmits(2);
+    ASSERT_TRUE(channels_->Send(Remote(3000), UdpChannel::ReliableOrdered, "x", 1));
+
+    ASSERT_TRUE(test::WaitFor([this]() {
+        channels_->Update();
+        return !lost_.empty();
+    }));
+    ASSERT_EQ(lost_.size(), 1u);
+    EXPECT_EQ(lost_[0].first, Remote(3000));
+    EXPECT_EQ(lost_[0].second, UdpPeerLoss::RetransmitLimit);
+    EXPECT_EQ(channels_->GetPeerCount(), 0u);
+}
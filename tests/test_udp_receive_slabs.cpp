@@ -0,0 +1,110 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** UDP receive slabs, datagrams up to the slab size intact, bigger ones dropped and counted, with GRO or without
+*/
+
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+    /**
+     * @brief UDP peer that turns segmentation offload on before its first receive
+     */
+    class OffloadPeer : public test::UdpPeer {
+       public:
+        using UdpPeer::UdpPeer;
+
+       protected:
+        void onStarted() override {
+            EnableSegmentationOffload();
+            ReceiveAsync();
+        }
+    };
+
+    /**
+     * @brief Send datagrams of 1 to 1500 bytes and a few bigger ones to a server with 1500 byte slabs
+     */
+    template <typename Peer = test::UdpPeer>
+    void ExpectSlabsHold(uint16_t port, bool batched) {
+        test::IoThread io;
+        auto server = std::make_shared<Peer>(io.context, port);
+        if (batched && !server->EnableBatchedIo(16))
+            GTEST_SKIP() << "batched I/O is not available on this platform";
+        server->SetReceiveSlabs(8, 1500);
+        ASSERT_TRUE(server->StartAndWait());
+        if (std::is_same_v<Peer, OffloadPeer> && !server->IsGroEnabled()) {
+            server->Stop();
+            GTEST_SKIP() << "the kernel refused UDP_GRO";
+        }
+        server->GetSocket().set_option(asio::socket_base::receive_buffer_size(4 << 20));
+
+        test::RawSocket client;
+        std::vector<uint8_t> buffer(9000);
+        size_t fitting = 0;
+        size_t oversized = 0;
+        for (size_t i = 0; i < 3000; i++) {
+            size_t size = i % 100 == 0 ? 1501 + i % 5000 : 1 + i % 1500;
+            // Each datagram ends with its size, a slab overwritten by the next receive would show
+            buffer[size - 1] = static_cast<uint8_t>(size);
+            client.SendTo(port, buffer.data(), size);
+            (size > 1500 ? oversized : fitting)++;
+            if (i % 50 == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // The drop counter belongs to the io thread
+        auto dropped = [&]() { return test::RunOn(io.context, [&]() { return server->GetDatagramsDropped(); }); };
+        ASSERT_TRUE(test::WaitFor([&]() { return server->received == fitting && dropped() == oversized; }))
+            << server->received << " of " << fitting << " received, " << dropped() << " of " << oversized << " dropped";
+        for (const auto& datagram : server->Received()) {
+            ASSERT_LE(datagram.data.size(), 1500u);
+            EXPECT_EQ(datagram.data.back(), static_cast<uint8_t>(datagram.data.size()));
+        }
+        EXPECT_TRUE(server->IsStarted()) << "an oversized datagram must not stop the server";
+        server->Stop();
+    }
+}  // namespace
+
+TEST(UdpReceiveSlabs, OversizedDatagramsAreDropped) {
+    ExpectSlabsHold(47601, false);
+}
+
+TEST(UdpReceiveSlabs, OversizedDatagramsAreDroppedWhenBatched) {
+    ExpectSlabsHold(47602, true);
+}
+
+TEST(UdpReceiveSlabs, OversizedDatagramsAreDroppedWithGro) {
+    ExpectSlabsHold<OffloadPeer>(47603, false);
+}
+
+TEST(UdpReceiveSlabs, OversizedSegmentsAreDroppedWithGro) {
+    test::IoThread io;
+    auto server = std::make_shared<OffloadPeer>(io.context, 47604);
+    auto sender = std::make_shared<OffloadPeer>(io.context, 47605);
+    server->SetReceiveSlabs(8, 1500);
+    ASSERT_TRUE(server->StartAndWait());
+    ASSERT_TRUE(sender->StartAndWait());
+    if (!server->IsGroEnabled() || !sender->IsGsoEnabled()) {
+        server->Stop();
+        sender->Stop();
+        GTEST_SKIP() << "the kernel refused UDP_GRO or UDP_SEGMENT";
+    }
+
+    // With GSO on both go down as one buffer each, and may come back coalesced
+    std::vector<uint8_t> oversized(10 * 1600, 0xAB);
+    std::vector<uint8_t> fitting(10 * 1000, 0xCD);
+    ASSERT_TRUE(sender->SendSegmentsAsync(test::Loopback(47604), oversized.data(), oversized.size(), 1600));
+    ASSERT_TRUE(sender->SendSegmentsAsync(test::Loopback(47604), fitting.data(), fitting.size(), 1000));
+
+    auto dropped = [&]() { return test::RunOn(io.context, [&]() { return server->GetDatagramsDropped(); }); };
+    ASSERT_TRUE(test::WaitFor([&]() { return server->received == 10 && dropped() == 10; }))
+        << server->received << " of 10 received, " << dropped() << " of 10 dropped";
+    for (const auto& datagram : server->Received()) {
+        ASSERT_EQ(datagram.data.size(), 1000u);
+        EXPECT_EQ(datagram.data.front(), 0xCD);
+    }
+    server->Stop();
+    sender->Stop();
+}
@@ -0,0 +1,101 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** UDP segmentation offload, a segmented send arrives as its datagrams in order, with GSO and GRO or without
+*/
+
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    constexpr size_t SegmentSize = 500;
+    /// More than MaxGsoSegments, so the send is split over two GSO entries
+    constexpr size_t Segments = 80;
+    constexpr size_t TailSize = 123;
+    /// 52 segments of 1260 bytes would make a 65520 byte entry, more than an IPv4 UDP payload holds
+    constexpr size_t LargeSegmentSize = 1260;
+    constexpr size_t LargeSegments = 60;
+
+    /**
+     * @brief UDP peer that turns segmentation offload on before its first receive when asked to
+     */
+    class OffloadPeer : public test::UdpPeer {
+       public:
+        OffloadPeer(asio::io_context& context, uint16_t port, bool offload) : UdpPeer(context, port), offload_(offload) {}
+
+       protected:
+        void onStarted() override {
+            if (offload_)
+                EnableSegmentationOffload();
+            ReceiveAsync();
+        }
+
+       private:
+        bool offload_;
+    };
+
+    /**
+     * @brief Byte i of segment, so a datagram out of place or cut at the wrong offset shows
+     */
+    uint8_t Pattern(size_t segment, size_t i) { return static_cast<uint8_t>(segment * 7 + i); }
+
+    /**
+     * @brief Send segments full segments of segmentSize bytes and a short tail in one call and check that each arrives on its own
+     */
+    void SendAndCheck(test::IoThread& io, uint16_t senderPort, uint16_t receiverPort, bool offload, size_t segmentSize = SegmentSize,
+                      size_t segments = Segments) {
+        auto receiver = std::make_shared<OffloadPeer>(io.context, receiverPort, offload);
+        auto sender = std::make_shared<OffloadPeer>(io.context, senderPort, offload);
+        ASSERT_TRUE(receiver->StartAndWait());
+        ASSERT_TRUE(sender->StartAndWait());
+        receiver->GetSocket().set_option(asio::socket_base::receive_buffer_size(4 << 20));
+        if (offload && !sender->IsGsoEnabled()) {
+            receiver->Stop();
+            sender->Stop();
+            GTEST_SKIP() << "the kernel refused UDP_SEGMENT";
+        }
+        EXPECT_EQ(sender->IsGsoEnabled(), offload);
+        EXPECT_TRUE(offload || !receiver->IsGroEnabled());
+
+        std::vector<uint8_t> buffer(segments * segmentSize + TailSize);
+        for (size_t offset = 0; offset < buffer.size(); offset++)
+            buffer[offset] = Pattern(offset / segmentSize, offset % segmentSize);
+        ASSERT_TRUE(sender->SendSegmentsAsync(test::Loopback(receiverPort), buffer.data(), buffer.size(), segmentSize));
+
+        ASSERT_TRUE(test::WaitFor([&]() { return receiver->received >= segments + 1; }))
+            << "only " << receiver->received << " of " << segments + 1 << " datagrams arrived";
+        ASSERT_TRUE(test::WaitFor([&]() { return sender->sent == segments + 1; })) << "onSent is called once per segment";
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto datagrams = receiver->Received();
+        ASSERT_EQ(datagrams.size(), segments + 1) << "a segment arrived twice";
+
+        for (size_t segment = 0; segment < datagrams.size(); segment++) {
+            const auto& datagram = datagrams[segment];
+            EXPECT_EQ(datagram.sender.port(), senderPort);
+            ASSERT_EQ(datagram.data.size(), segment < segments ? segmentSize : TailSize) << "datagram " << segment;
+            for (size_t i = 0; i < datagram.data.size(); i++)
+                ASSERT_EQ(datagram.data[i], Pattern(segment, i)) << "datagram " << segment << " byte " << i;
+        }
+
+        receiver->Stop();
+        sender->Stop();
+    }
+}  // namespace
+
+TEST(UdpSegmentationOffload, SegmentsArriveSplitInOrder) {
+    test::IoThread io;
+    SendAndCheck(io, 48001, 48002, true);
+}
+
+TEST(UdpSegmentationOffload, SegmentsArriveSplitInOrderWithoutOffload) {
+    test::IoThread io;
+    SendAndCheck(io, 48003, 48004, false);
+}
+
+TEST(UdpSegmentationOffload, EntriesFitInOneIpv4Payload) {
+    test::IoThread io;
+    SendAndCheck(io, 48005, 48006, true, LargeSegmentSize, LargeSegments);
+}
@@ -0,0 +1,101 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** UDP send queue, owned copies of the datagrams and a bounded queue
+*/
+
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using test::UdpPeer;
+
+TEST(UdpSendQueue, CallerBufferIsReusableRightAway) {
+    test::IoThread io;
+    auto sender = std::make_shared<UdpPeer>(io.context, 47501);
+    auto receiver = std::make_shared<UdpPeer>(io.context, 47502);
+    ASSERT_TRUE(sender->StartAndWait());
+    ASSERT_TRUE(receiver->StartAndWait());
+    receiver->GetSocket().set_option(asio::socket_base::receive_buffer_size(4 << 20));
+
+    // Every datagram is built in the same buffer, overwritten as soon as SendAsync returns
+    const uint32_t count = 2000;
+    uint8_t buffer[64];
+    for (uint32_t i = 0; i < count; i++) {
+        std::memset(buffer, static_cast<int>(i), sizeof(buffer));
+        std::memcpy(buffer, &i, sizeof(i));
+        ASSERT_TRUE(sender->SendAsync(test::Loopback(47502), buffer, sizeof(buffer)));
+    }
+
+    ASSERT_TRUE(test::WaitFor([&]() { return receiver->received == count; })) << receiver->received << " of " << count;
+    EXPECT_EQ(sender->sent, count);
+    EXPECT_EQ(sender->GetSendQueueSize(), 0u);
+
+    std::vector<bool> seen(count);
+    for (const auto& datagram : receiver->Received()) {
+        ASSERT_EQ(datagram.data.size(), sizeof(buffer));
+        uint32_t sequence = 0;
+        std::memcpy(&sequence, datagram.data.data(), sizeof(sequence));
+        ASSERT_LT(sequence, count);
+        EXPECT_FALSE(seen[sequence]) << "datagram " << sequence << " received twice";
+        seen[sequence] = true;
+        EXPECT_EQ(datagram.data.back(), static_cast<uint8_t>(sequence)) << "datagram " << sequence << " was overwritten";
+    }
+
+    sender->Stop();
+    receiver->Stop();
+}
+
+TEST(UdpSendQueue, FullQueueRefusesDatagrams) {
+    test::IoThread io;
+    auto sender = std::make_shared<UdpPeer>(io.context, 47503);
+    auto receiver = std::make_shared<UdpPeer>(io.context, 47504);
+    // Batched sends stay queued until Flush, so the queue fills up
+    if (!sender->EnableBatchedIo(16))
+        GTEST_SKIP() << "batched I/O is not available on this platform";
+    sender->SetSendQueueLimit(100);
+    ASSERT_TRUE(sender->StartAndWait());
+    ASSERT_TRUE(receiver->StartAndWait());
+
+    int queued = 0;
+    for (int i = 0; i < 150; i++)
+        queued += sender->SendAsync(test::Loopback(47504), "datagram", 8);
+    EXPECT_EQ(queued, 100);
+    EXPECT_EQ(sender->GetSendQueueSize(), 100u);
+
+    sender->Flush();
+    ASSERT_TRUE(test::WaitFor([&]() { return receiver->received == 100; }));
+    EXPECT_EQ(sender->GetSendQueueSize(), 0u);
+    EXPECT_TRUE(sender->SendAsync(test::Loopback(47504), "datagram", 8));
+
+    sender->Stop();
+    receiver->Stop();
+}
+
+TEST(UdpSendQueue, DisconnectWhileSendingDropsTheQueue) {
+    test::IoThread io;
+    auto sender = std::make_shared<UdpPeer>(io.context, 47505);
+    auto receiver = std::make_shared<UdpPeer>(io.context, 47506);
+    ASSERT_TRUE(sender->StartAndWait());
+    ASSERT_TRUE(receiver->StartAndWait());
+
+    // Queue on the io thread and disconnect before the first completion runs, it must be ignored
+    uint8_t buffer[1024] = {};
+    size_t queued = test::RunOn(io.context, [&]() {
+        size_t count = 0;
+        for (int i = 0; i < 1000; i++)
+            count += sender->SendAsync(test::Loopback(47506), buffer, sizeof(buffer));
+        sender->Disconnect();
+        return count;
+    });
+    EXPECT_EQ(queued, 1000u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(sender->IsConnected());
+    EXPECT_EQ(sender->GetSendQueueSize(), 0u);
+    EXPECT_LE(sender->sent, 1u);
+    EXPECT_LE(receiver->received, 1u);
+    EXPECT_FALSE(sender->SendAsync(test::Loopback(47506), buffer, sizeof(buffer)));
+
+    receiver->Stop();
+}
@@ -0,0 +1,221 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** UDP sessions, one per endpoint, closed when idle, and the FlatMap holding them
+*/
+
+#include <random>
+#include <unordered_map>
+
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using RType::net::FlatMap;
+using RType::net::UdpSession;
+
+namespace {
+    /**
+     * @brief Server recording its session hooks
+     *
+     * The hooks run on the io thread, the plain members are only touched there, through RunOn.
+     */
+    class SessionServer : public test::UdpPeer {
+       public:
+        using UdpPeer::UdpPeer;
+
+        uint16_t refusedPort = 0;                                    ///< onSessionOpened refuses this port
+        std::function<void(SessionServer&, UdpSession&)> onClose;    ///< Extra work done in onSessionClosed
+        std::vector<uint32_t> closedIds;                             ///< Ids of the closed sessions, in order
+        std::vector<std::pair<uint32_t, uint64_t>> closedDatagrams;  ///< Datagrams counted by each closed session
+        std::atomic<int> opened = 0;                                 ///< Calls to onSessionOpened
+        std::atomic<int> withoutSession = 0;                         ///< Datagrams reaching onReceived without a session
+
+        size_t SessionCount() {
+            return test::RunOn(GetContext(), [this]() { return GetSessionCount(); });
+        }
+
+        std::vector<uint32_t> ClosedIds() {
+            return test::RunOn(GetContext(), [this]() { return closedIds; });
+        }
+
+       protected:
+        bool onSessionOpened(UdpSession& session) override {
+            opened++;
+            session.userData = session.id * 10;
+            return session.endpoint.port() != refusedPort;
+        }
+
+        void onSessionClosed(UdpSession& session) override {
+            EXPECT_EQ(std::any_cast<uint32_t>(session.userData), session.id * 10);
+            closedIds.push_back(session.id);
+            closedDatagrams.emplace_back(session.id, session.datagramsReceived);
+            if (onClose)
+                onClose(*this, session);
+        }
+
+        void onReceived(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) override {
+            if (GetSession(endpoint) == nullptr)
+                withoutSession++;
+            UdpPeer::onReceived(endpoint, buffer, size);
+        }
+    };
+
+    class UdpSessionsTest : public testing::Test {
+       protected:
+        std::shared_ptr<SessionServer> Start(uint16_t port, std::chrono::milliseconds timeout) {
+            auto server = std::make_shared<SessionServer>(io_.context, port);
+            server->EnableSessions(timeout);
+            EXPECT_TRUE(server->StartAndWait());
+            return server;
+        }
+
+        test::IoThread io_;
+    };
+}  // namespace
+
+TEST_F(UdpSessionsTest, OneSessionPerEndpoint) {
+    auto server = Start(47401, std::chrono::seconds(10));
+    test::RawSocket clients[3];
+    test::RunOn(io_.context, [&]() { server->refusedPort = clients[2].Endpoint().port(); });
+
+    for (int i = 0; i < 10; i++) {
+        for (auto& client : clients)
+            client.SendTo(47401, "hi", 2);
+    }
+    ASSERT_TRUE(test::WaitFor([&]() { return server->received == 20; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // The refused endpoint is asked again on each datagram and never reaches onReceived
+    EXPECT_EQ(server->received, 20u);
+    EXPECT_EQ(server->opened, 12);
+    EXPECT_EQ(server->withoutSession, 0);
+    EXPECT_EQ(server->SessionCount(), 2u);
+
+    auto counts = test::RunOn(io_.context, [&]() {
+        std::vector<uint64_t> datagrams;
+        for (int i = 0; i < 2; i++)
+            datagrams.push_back(server->GetSession(clients[i].Endpoint())->datagramsReceived);
+        datagrams.push_back(server->GetSession(clients[2].Endpoint()) == nullptr ? 0 : 1);
+        return datagrams;
+    });
+    EXPECT_EQ(counts, (std::vector<uint64_t>{10, 10, 0}));
+
+    server->Stop();
+    ASSERT_TRUE(test::WaitFor([&]() { return server->ClosedIds().size() == 2; }));
+}
+
+TEST_F(UdpSessionsTest, IdleSessionsAreClosed) {
+    auto server = Start(47402, std::chrono::milliseconds(100));
+    test::RawSocket active;
+    test::RawSocket idle;
+    active.SendTo(47402, "hi", 2);
+    idle.SendTo(47402, "hi", 2);
+    ASSERT_TRUE(test::WaitFor([&]() { return server->SessionCount() == 2; }));
+
+    for (int i = 0; i < 6; i++) {
+        active.SendTo(47402, "hi", 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    }
+    EXPECT_EQ(server->SessionCount(), 1u);
+    EXPECT_EQ(server->ClosedIds().size(), 1u);
+
+    ASSERT_TRUE(test::WaitFor([&]() { return server->SessionCount() == 0; }));
+    auto closed = test::RunOn(io_.context, [&]() { return server->closedDatagrams; });
+    ASSERT_EQ(closed.size(), 2u);
+    EXPECT_EQ(closed[0].second, 1u) << "the idle session goes first";
+    EXPECT_EQ(closed[1].second, 7u);
+    server->Stop();
+}
+
+TEST_F(UdpSessionsTest, HooksMayCloseOtherSessions) {
+    auto server = Start(47403, std::chrono::milliseconds(100));
+    test::RawSocket first;
+    test::RawSocket second;
+    test::RawSocket third;
+    // Closing any session closes the third one, whether it is idle or not
+    test::RunOn(io_.context, [&]() { server->onClose = [&third](SessionServer& self, UdpSession&) { self.CloseSession(third.Endpoint()); }; });
+
+    first.SendTo(47403, "hi", 2);
+    second.SendTo(47403, "hi", 2);
+    ASSERT_TRUE(test::WaitFor([&]() { return server->SessionCount() == 2; }));
+    third.SendTo(47403, "hi", 2);
+    ASSERT_TRUE(test::WaitFor([&]() { return server->SessionCount() == 3; }));
+
+    // first and second go idle in the same sweep, third keeps talking until it is closed by a hook
+    ASSERT_TRUE(test::WaitFor([&]() {
+        third.SendTo(47403, "hi", 2);
+        return server->ClosedIds().size() >= 3;
+    }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    server->Stop();
+    ASSERT_TRUE(test::WaitFor([&]() { return server->SessionCount() == 0; }));
+
+    // Each session is closed once, the third may have come back after its close
+    auto closed = server->ClosedIds();
+    std::sort(closed.begin(), closed.end());
+    EXPECT_EQ(std::adjacent_find(closed.begin(), closed.end()), closed.end());
+    EXPECT_GE(closed.size(), 3u);
+}
+
+TEST_F(UdpSessionsTest, ExplicitCloseFromAHookIsNested) {
+    auto server = Start(47404, std::chrono::seconds(10));
+    test::RawSocket first;
+    test::RawSocket second;
+    test::RunOn(io_.context, [&]() { server->onClose = [&second](SessionServer& self, UdpSession&) { self.CloseSession(second.Endpoint()); }; });
+    first.SendTo(47404, "hi", 2);
+    second.SendTo(47404, "hi", 2);
+    ASSERT_TRUE(test::WaitFor([&]() { return server->SessionCount() == 2; }));
+
+    bool closed = test::RunOn(io_.context, [&]() { return server->CloseSession(first.Endpoint()); });
+    EXPECT_TRUE(closed);
+    EXPECT_EQ(server->SessionCount(), 0u);
+    EXPECT_EQ(server->ClosedIds().size(), 2u);
+    EXPECT_FALSE(test::RunOn(io_.context, [&]() { return server->CloseSession(first.Endpoint()); }));
+    server->Stop();
+}
+
+TEST(FlatMap, MatchesUnorderedMap) {
+    FlatMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> reference;
+    std::mt19937_64 random(1);
+
+    for (int i = 0; i < 200000; i++) {
+        uint64_t key = random() % 5000;
+        switch (random() % 3) {
+            case 0: {
+                auto [value, inserted] = map.try_emplace(key);
+                ASSERT_EQ(inserted, reference.try_emplace(key, 0).second);
+                *value = key * 3;
+                reference[key] = key * 3;
+                break;
+            }
+            case 1:
+                ASSERT_EQ(map.erase(key), reference.erase(key) == 1);
+                break;
+            default: {
+                auto* value = map.find(key);
+                auto it = reference.find(key);
+                ASSERT_EQ(value != nullptr, it != reference.end());
+                if (value != nullptr) {
+                    ASSERT_EQ(*value, it->second);
+                }
+            }
+        }
+
+        if (i % 20000 == 0) {
+            size_t erased = map.erase_if([](uint64_t key, uint64_t&) { return key % 7 == 0; });
+            size_t expected = 0;
+            for (auto it = reference.begin(); it != reference.end();) {
+                if (it->first % 7 == 0) {
+                    it = reference.erase(it);
+                    expected++;
+                } else {
+                    ++it;
+                }
+            }
+            ASSERT_EQ(erased, expected);
+        }
+        ASSERT_EQ(map.size(), reference.size());
+    }
+}
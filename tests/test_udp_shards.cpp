@@ -0,0 +1,217 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** UdpShardGroup, ShardOf against the steering program, datagrams on their shard and posts on its thread
+*/
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "NetUdpShards.hpp"
+#include "UdpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    constexpr size_t ShardCount = 4;
+
+    /**
+     * @brief Runs the steering program of UdpShardGroup::AttachSteering on the IPv4 and UDP headers of a datagram
+     *
+     * BPF_ABS loads read the packet in network byte order, the headers are built that way here.
+     */
+    uint32_t SteeringProgram(const asio::ip::udp::endpoint& sender, uint32_t shards) {
+        uint8_t packet[28] = {0x45};
+        auto address = sender.address().to_v4().to_bytes();
+        std::copy(address.begin(), address.end(), packet + 12);
+        packet[20] = static_cast<uint8_t>(sender.port() >> 8);
+        packet[21] = static_cast<uint8_t>(sender.port());
+
+        auto loadWord = [&](size_t offset) { return uint32_t(packet[offset]) << 24 | uint32_t(packet[offset + 1]) << 16 | uint32_t(packet[offset + 2]) << 8 | packet[offset + 3]; };
+        auto loadHalf = [&](size_t offset) { return uint32_t(packet[offset]) << 8 | packet[offset + 1]; };
+
+        uint32_t a = loadWord(12);  // A = source address
+        uint32_t x = a;             // X = A
+        a = loadHalf(20);           // A = source port
+        a ^= x;
+        a *= 0x9E3779B1;
+        a >>= 16;
+        a %= shards;
+        return a;
+    }
+
+    /**
+     * @brief UDP peer telling which thread it received on
+     */
+    class ShardPeer : public test::UdpPeer {
+       public:
+        using UdpPeer::UdpPeer;
+
+        std::set<std::thread::id> Threads() {
+            std::scoped_lock lock(threadsMutex_);
+            return threads_;
+        }
+
+       protected:
+        void onReceived(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) override {
+            {
+                std::scoped_lock lock(threadsMutex_);
+                threads_.insert(std::this_thread::get_id());
+            }
+            UdpPeer::onReceived(endpoint, buffer, size);
+        }
+
+       private:
+        std::mutex threadsMutex_;
+        std::set<std::thread::id> threads_;
+    };
+
+    /**
+     * @brief Index of shard in group, GetShardCount if it is not one of its shards
+     */
+    size_t IndexOf(const UdpShardGroup<ShardPeer>& group, const ShardPeer* shard) {
+        size_t index = 0;
+        while (index < group.GetShardCount() && group.GetShard(index).get() != shard)
+            index++;
+        return index;
+    }
+}  // namespace
+
+TEST(UdpShards, ShardOfMatchesTheSteeringProgram) {
+    UdpShardGroup<ShardPeer> group(ShardCount, 48201);
+    const char* addresses[] = {"127.0.0.1", "10.1.2.3", "192.168.0.42", "255.255.255.255", "0.0.0.0", "172.16.254.1"};
+    std::vector<size_t> hits(ShardCount, 0);
+    for (const char* address : addresses) {
+        for (uint32_t port = 0; port <= 65535; port += 97) {
+            asio::ip::udp::endpoint endpoint(asio::ip::make_address(address), static_cast<uint16_t>(port));
+            size_t shard = group.ShardOf(endpoint);
+            ASSERT_EQ(shard, SteeringProgram(endpoint, ShardCount)) << endpoint;
+            hits[shard]++;
+        }
+    }
+    for (size_t shard = 0; shard < ShardCount; shard++)
+        EXPECT_GT(hits[shard], 0u) << "no endpoint lands on shard " << shard;
+}
+
+TEST(UdpShards, DatagramsReachTheShardOfTheirSender) {
+    UdpShardGroup<ShardPeer> group(ShardCount, 48202);
+    ASSERT_TRUE(group.Start());
+
+    const size_t clients = 64;
+    std::vector<std::unique_ptr<test::RawSocket>> sockets;
+    for (size_t i = 0; i < clients; i++) {
+        sockets.push_back(std::make_unique<test::RawSocket>());
+        sockets.back()->SendTo(48202, "hi", 2);
+        sockets.back()->SendTo(48202, "hi", 2);
+    }
+    auto total = [&]() {
+        size_t received = 0;
+        for (size_t i = 0; i < ShardCount; i++)
+            received += group.GetShard(i)->received;
+        return received;
+    };
+    ASSERT_TRUE(test::WaitFor([&]() { return total() == 2 * clients; })) << "only " << total() << " datagrams arrived";
+
+    std::map<uint16_t, std::set<size_t>> shardsOfPort;
+    std::set<std::thread::id> threads;
+    size_t busyShards = 0;
+    for (size_t i = 0; i < ShardCount; i++) {
+        auto datagrams = group.GetShard(i)->Received();
+        busyShards += datagrams.empty() ? 0 : 1;
+        for (const auto& datagram : datagrams) {
+            shardsOfPort[datagram.sender.port()].insert(i);
+            if (group.IsSteered()) {
+                ASSERT_EQ(group.ShardOf(datagram.sender), i) << datagram.sender;
+            }
+        }
+        for (const auto& thread : group.GetShard(i)->Threads())
+            EXPECT_TRUE(threads.insert(thread).second) << "two shards received on the same thread";
+    }
+    ASSERT_EQ(shardsOfPort.size(), clients);
+    for (const auto& [port, shards] : shardsOfPort)
+        EXPECT_EQ(shards.size(), 1u) << "the datagrams of port " << port << " were split over shards";
+    if (group.IsSteered()) {
+        EXPECT_EQ(busyShards, ShardCount) << "64 senders leave a shard idle";
+    }
+
+    group.Stop();
+}
+
+TEST(UdpShards, PostsRunOnTheThreadOfTheirShard) {
+    UdpShardGroup<ShardPeer> group(ShardCount, 48203);
+    ASSERT_TRUE(group.Start());
+
+    struct Call {
+        ShardPeer* shard;
+        std::thread::id thread;
+        bool onShardContext;
+    };
+    std::mutex mutex;
+    std::vector<Call> calls;
+    auto record = [&](ShardPeer& shard) {
+        std::scoped_lock lock(mutex);
+        calls.push_back({&shard, std::this_thread::get_id(), shard.GetContext().get_executor().running_in_this_thread()});
+    };
+    auto count = [&]() {
+        std::scoped_lock lock(mutex);
+        return calls.size();
+    };
+
+    // Post, one call per shard, learns the thread of each one
+    std::vector<std::thread::id> shardThreads(ShardCount);
+    for (size_t i = 0; i < ShardCount; i++)
+        group.Post(i, record);
+    ASSERT_TRUE(test::WaitFor([&]() { return count() == ShardCount; }));
+    std::set<std::thread::id> distinct;
+    for (const auto& call : calls) {
+        size_t shard = IndexOf(group, call.shard);
+        ASSERT_LT(shard, ShardCount);
+        EXPECT_TRUE(call.onShardContext);
+        EXPECT_NE(call.thread, std::this_thread::get_id());
+        shardThreads[shard] = call.thread;
+        distinct.insert(call.thread);
+    }
+    EXPECT_EQ(distinct.size(), ShardCount) << "each shard has its own thread";
+
+    // PostTo reaches the owner of the endpoint
+    calls.clear();
+    std::vector<asio::ip::udp::endpoint> endpoints;
+    for (uint16_t port = 50000; port < 50032; port++) {
+        endpoints.push_back(test::Loopback(port));
+        group.PostTo(endpoints.back(), record);
+    }
+    ASSERT_TRUE(test::WaitFor([&]() { return count() == endpoints.size(); }));
+    std::vector<size_t> perShard(ShardCount, 0);
+    for (const auto& call : calls) {
+        size_t shard = IndexOf(group, call.shard);
+        ASSERT_LT(shard, ShardCount);
+        EXPECT_TRUE(call.onShardContext);
+        EXPECT_EQ(call.thread, shardThreads[shard]);
+        perShard[shard]++;
+    }
+    for (size_t shard = 0; shard < ShardCount; shard++) {
+        auto owned = std::count_if(endpoints.begin(), endpoints.end(), [&](const auto& endpoint) { return group.ShardOf(endpoint) == shard; });
+        EXPECT_EQ(perShard[shard], static_cast<size_t>(owned)) << "shard " << shard;
+    }
+
+    // PostToAll runs once on every shard
+    calls.clear();
+    group.PostToAll(record);
+    ASSERT_TRUE(test::WaitFor([&]() { return count() == ShardCount; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(count(), ShardCount);
+    std::set<size_t> reached;
+    for (const auto& call : calls) {
+        size_t shard = IndexOf(group, call.shard);
+        ASSERT_LT(shard, ShardCount);
+        EXPECT_TRUE(call.onShardContext);
+        EXPECT_EQ(call.thread, shardThreads[shard]);
+        reached.insert(shard);
+    }
+    EXPECT_EQ(reached.size(), ShardCount);
+
+    group.Stop();
+}
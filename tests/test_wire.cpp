@@ -0,0 +1,176 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Wire layouts, golden bytes of each payload codec and round trips through them
+*/
+
+#include <array>
+
+#include "RTypeNet.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType;
+using namespace RType::net;
+
+namespace {
+    /// Bytes 0x00 to 0x0F, a uuid whose bytes tell their offset
+    const uint8_t UuidBytes[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F};
+    /// Bytes 0xF0 to 0xFF
+    const uint8_t OtherUuidBytes[16] = {0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF};
+
+    uuids::uuid MakeUuid(const uint8_t (&bytes)[16]) { return uuids::uuid(std::begin(bytes), std::end(bytes)); }
+
+    /**
+     * @brief Encode payload and return its bytes
+     */
+    template <typename Payload>
+    std::vector<uint8_t> Encode(const Payload& payload) {
+        std::vector<uint8_t> out(Wire<Payload>::size);
+        Wire<Payload>::encode(out.data(), payload);
+        return out;
+    }
+
+    /**
+     * @brief Concatenate byte lists into the expected wire form
+     */
+    std::vector<uint8_t> Bytes(std::initializer_list<std::vector<uint8_t>> parts) {
+        std::vector<uint8_t> out;
+        for (const auto& part : parts)
+            out.insert(out.end(), part.begin(), part.end());
+        return out;
+    }
+
+    std::vector<uint8_t> Bytes(const uint8_t (&bytes)[16]) { return {std::begin(bytes), std::end(bytes)}; }
+
+    /// Exact comparison, the floats must come back bit for bit
+    testing::AssertionResult SameVec2(const glm::vec2& actual, const glm::vec2& expected) {
+        if (actual.x == expected.x && actual.y == expected.y)
+            return testing::AssertionSuccess();
+        return testing::AssertionFailure() << "(" << actual.x << ", " << actual.y << ") != (" << expected.x << ", " << expected.y << ")";
+    }
+}  // namespace
+
+TEST(Wire, ScalarsAreLittleEndian) {
+    uint8_t out[8] = {};
+    WireCodec<uint32_t>::encode(out, 0x11223344u);
+    EXPECT_EQ(std::vector<uint8_t>(out, out + 4), (std::vector<uint8_t>{0x44, 0x33, 0x22, 0x11}));
+    WireCodec<int16_t>::encode(out, int16_t(-2));
+    EXPECT_EQ(std::vector<uint8_t>(out, out + 2), (std::vector<uint8_t>{0xFE, 0xFF}));
+    WireCodec<ShipColor>::encode(out, ShipColor::RED);
+    EXPECT_EQ(out[0], 0x03);
+    WireCodec<bool>::encode(out, true);
+    EXPECT_EQ(out[0], 0x01);
+
+    // 1.5f is 0x3FC00000, 1.5 is 0x3FF8000000000000
+    WireCodec<float>::encode(out, 1.5f);
+    EXPECT_EQ(std::vector<uint8_t>(out, out + 4), (std::vector<uint8_t>{0x00, 0x00, 0xC0, 0x3F}));
+    WireCodec<double>::encode(out, 1.5);
+    EXPECT_EQ(std::vector<uint8_t>(out, out + 8), (std::vector<uint8_t>{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x3F}));
+
+    int16_t small = 0;
+    WireCodec<int16_t>::decode(std::array<uint8_t, 2>{0xFE, 0xFF}.data(), small);
+    EXPECT_EQ(small, -2);
+}
+
+TEST(Wire, UuidAndVec2RoundTrip) {
+    uint8_t out[16];
+    auto uuid = MakeUuid(UuidBytes);
+    WireCodec<uuids::uuid>::encode(out, uuid);
+    EXPECT_EQ(std::vector<uint8_t>(out, out + 16), Bytes(UuidBytes)) << "a uuid is sent in its byte order";
+    uuids::uuid decodedUuid;
+    WireCodec<uuids::uuid>::decode(out, decodedUuid);
+    EXPECT_EQ(decodedUuid, uuid);
+
+    glm::vec2 vec{-2.0f, 0.25f};
+    WireCodec<glm::vec2>::encode(out, vec);
+    // -2.0f is 0xC0000000, 0.25f is 0x3E800000
+    EXPECT_EQ(std::vector<uint8_t>(out, out + 8), (std::vector<uint8_t>{0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x80, 0x3E}));
+    glm::vec2 decodedVec;
+    WireCodec<glm::vec2>::decode(out, decodedVec);
+    EXPECT_TRUE(SameVec2(decodedVec, vec));
+}
+
+TEST(Wire, MoveGoldenBytes) {
+    udp::Move_t move;
+    move.clientUuid = MakeUuid(UuidBytes);
+    move.position = {1.5f, -2.0f};
+    move.velocity = {0.25f, 0.0f};
+
+    auto bytes = Encode(move);
+    EXPECT_EQ(bytes, Bytes({Bytes(UuidBytes),
+                            {0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0x00, 0xC0},
+                            {0x00, 0x00, 0x80, 0x3E, 0x00, 0x00, 0x00, 0x00}}))
+        << "the message type is in the header and never sent";
+
+    udp::Move_t decoded;
+    Wire<udp::Move_t>::decode(bytes.data(), decoded);
+    EXPECT_EQ(decoded.messayeType, ServerMessages::ClientMove);
+    EXPECT_EQ(decoded.clientUuid, move.clientUuid);
+    EXPECT_TRUE(SameVec2(decoded.position, move.position));
+    EXPECT_TRUE(SameVec2(decoded.velocity, move.velocity));
+}
+
+TEST(Wire, ShootGoldenBytes) {
+    udp::Shoot_t shoot;
+    shoot.clientUuid = MakeUuid(OtherUuidBytes);
+    shoot.position = {-2.0f, 1.5f};
+    shoot.target_velocity = {0.0f, 0.25f};
+    shoot.id = 0xAB;
+
+    auto bytes = Encode(shoot);
+    EXPECT_EQ(bytes, Bytes({Bytes(OtherUuidBytes),
+                            {0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0xC0, 0x3F},
+                            {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3E},
+                            {0xAB}}));
+
+    udp::Shoot_t decoded;
+    Wire<udp::Shoot_t>::decode(bytes.data(), decoded);
+    EXPECT_EQ(decoded.messayeType, ServerMessages::ClientShoot);
+    EXPECT_EQ(decoded.clientUuid, shoot.clientUuid);
+    EXPECT_TRUE(SameVec2(decoded.position, shoot.position));
+    EXPECT_TRUE(SameVec2(decoded.target_velocity, shoot.target_velocity));
+    EXPECT_EQ(decoded.id, shoot.id);
+}
+
+TEST(Wire, AddEnemyGoldenBytes) {
+    udp::AddEnemy enemy;
+    enemy.id = 7;
+    enemy.position = {1.5f, 0.25f};
+    enemy.velocity = {-2.0f, 1.5f};
+    enemy.time = 1.5;
+
+    auto bytes = Encode(enemy);
+    EXPECT_EQ(bytes, Bytes({{0x07},
+                            {0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0x80, 0x3E},
+                            {0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0xC0, 0x3F},
+                            {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x3F}}));
+
+    udp::AddEnemy decoded;
+    Wire<udp::AddEnemy>::decode(bytes.data(), decoded);
+    EXPECT_EQ(decoded.messayeType, ServerMessages::ClientShoot) << "a field that is not sent keeps its value";
+    EXPECT_EQ(decoded.id, enemy.id);
+    EXPECT_TRUE(SameVec2(decoded.position, enemy.position));
+    EXPECT_TRUE(SameVec2(decoded.velocity, enemy.velocity));
+    EXPECT_EQ(decoded.time, enemy.time);
+}
+
+TEST(Wire, JoinLobbyGoldenBytes) {
+    tcp::JoinLobby_t join{};
+    join.lobbyUuid = MakeUuid(UuidBytes);
+    join.clientUuid = MakeUuid(OtherUuidBytes);
+    std::strcpy(join.username, "kleo");
+    join.color = ShipColor::GREEN;
+
+    auto bytes = Encode(join);
+    std::vector<uint8_t> username(sizeof(Username_t), 0);
+    std::memcpy(username.data(), "kleo", 4);
+    EXPECT_EQ(bytes, Bytes({Bytes(UuidBytes), Bytes(OtherUuidBytes), username, {0x02}}));
+
+    tcp::JoinLobby_t decoded{};
+    Wire<tcp::JoinLobby_t>::decode(bytes.data(), decoded);
+    EXPECT_EQ(decoded.lobbyUuid, join.lobbyUuid);
+    EXPECT_EQ(decoded.clientUuid, join.clientUuid);
+    EXPECT_STREQ(decoded.username, "kleo");
+    EXPECT_EQ(decoded.color, ShipColor::GREEN);
+}
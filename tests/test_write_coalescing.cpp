@@ -0,0 +1,114 @@
+/*
+** EPITECH PROJECT, 2023
+** RTypeServer
+** File description:
+** Write coalescing, the byte and buffer caps of a vectored write, and the message bigger than the byte cap
+*/
+
+#include <future>
+
+#include "TcpTestPeer.hpp"
+#include "gtest/gtest.h"
+
+using namespace RType::net;
+
+namespace {
+    enum class Msg : uint32_t { Data, Empty };
+
+    constexpr size_t HeaderSize = sizeof(message_header<Msg>);
+    constexpr size_t BodySize = 24;
+    constexpr size_t FrameSize = HeaderSize + BodySize;
+
+    class WriteCoalescingTest : public testing::Test {
+       protected:
+        void Start(uint16_t port) {
+            server_ = std::make_unique<test::TcpServerStub<Msg>>(port);
+            ASSERT_TRUE(server_->Start());
+            client_ = std::make_unique<test::RawTcpClient>(port);
+            ASSERT_TRUE(server_->WaitValidated());
+            connection_ = server_->GetClients().front();
+        }
+
+        void TearDown() override {
+            if (server_)
+                server_->Stop();
+        }
+
+        /**
+         * @brief Queue messages from the connection strand with the given caps, and return the number of writes they took
+         *
+         * The first message starts a write on its own, the others are all queued before
+         * it completes, so they are split by the caps alone.
+         */
+        size_t Send(const std::vector<shared_message<Msg>>& messages, size_t maxBytes, size_t maxBuffers) {
+            uint64_t writesBefore = server_->GetStats().writeLatency.count;
+            uint64_t sentBefore = connection_->GetMessagesSent();
+
+            std::promise<void> queued;
+            asio::post(connection_->GetExecutor(), [&]() {
+                connection_->SetWriteCoalescing(maxBytes, maxBuffers);
+                for (const auto& msg : messages)
+                    server_->MessageClient(connection_, msg);
+                queued.set_value();
+            });
+            queued.get_future().wait();
+
+            // Every frame arrives whole and in order, whatever write carried it
+            for (size_t i = 0; i < messages.size(); i++) {
+                message<Msg> msg;
+                EXPECT_TRUE(client_->Read(msg)) << "message " << i;
+                EXPECT_EQ(msg.header.id, messages[i]->header.id) << "message " << i;
+                EXPECT_EQ(msg.header.size, messages[i]->body.size()) << "message " << i;
+                EXPECT_TRUE(std::equal(msg.body.begin(), msg.body.end(), messages[i]->body.begin())) << "message " << i;
+            }
+
+            // Counted once each write completed
+            EXPECT_TRUE(test::WaitFor([&]() { return connection_->GetMessagesSent() == sentBefore + messages.size(); }));
+            return static_cast<size_t>(server_->GetStats().writeLatency.count - writesBefore);
+        }
+
+        static std::vector<shared_message<Msg>> Frames(size_t count, uint32_t first = 0) {
+            std::vector<shared_message<Msg>> messages;
+            for (uint32_t i = 0; i < count; i++)
+                messages.push_back(test::MakeMessage(Msg::Data, BodySize, first + i));
+            return messages;
+        }
+
+        std::unique_ptr<test::TcpServerStub<Msg>> server_;
+        std::unique_ptr<test::RawTcpClient> client_;
+        std::shared_ptr<TcpConnection<Msg>> connection_;
+    };
+}  // namespace
+
+TEST_F(WriteCoalescingTest, ByteCapSplitsTheWrites) {
+    Start(48301);
+    // The first frame alone, then 3 per write
+    EXPECT_EQ(Send(Frames(10), 3 * FrameSize, 64), 4u);
+    // A cap between two frame boundaries rounds down
+    EXPECT_EQ(Send(Frames(7, 100), 3 * FrameSize - 1, 64), 1u + 3u);
+}
+
+TEST_F(WriteCoalescingTest, BufferCapSplitsTheWrites) {
+    Start(48302);
+    // A frame with a body takes 2 buffers, the first frame alone, then 2 per write
+    EXPECT_EQ(Send(Frames(9), 64 * 1024, 4), 5u);
+
+    // A frame without a body only takes its header buffer
+    std::vector<shared_message<Msg>> empty;
+    for (int i = 0; i < 9; i++) {
+        message<Msg> msg;
+        msg.header.id = Msg::Empty;
+        empty.push_back(make_shared_message(msg));
+    }
+    EXPECT_EQ(Send(empty, 64 * 1024, 4), 1u + 2u);
+}
+
+TEST_F(WriteCoalescingTest, OversizedMessageIsWrittenAlone) {
+    Start(48303);
+    auto messages = Frames(1);
+    messages.push_back(test::MakeMessage(Msg::Data, 10 * FrameSize, 1));
+    auto tail = Frames(2, 2);
+    messages.insert(messages.end(), tail.begin(), tail.end());
+    // The first frame, the big one alone although it is over the cap, then the two others together
+    EXPECT_EQ(Send(messages, 3 * FrameSize, 64), 3u);
+}